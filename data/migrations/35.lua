@@ -1,3 +1,5 @@
 function onUpdateDatabase()
-	return false
+	print("> Updating database to version 35 (unique player item slots)")
+	db.query("ALTER TABLE `player_items` ADD UNIQUE KEY `player_id_2` (`player_id`, `sid`)")
+	return true
 end
@@ -0,0 +1,34 @@
+function onSay(player, words, param)
+	if not player:getGroup():getAccess() then
+		return true
+	end
+
+	if player:getAccountType() < ACCOUNT_TYPE_GOD then
+		return false
+	end
+
+	logCommand(player, words, param)
+
+	local split = param:splitTrimmed(" ")
+	local action = split[1] and split[1]:lower() or ""
+	if action == "start" then
+		Game.startLuaProfiler(tonumber(split[2]))
+		player:sendTextMessage(MESSAGE_INFO_DESCR, "Lua profiler started.")
+	elseif action == "stop" then
+		if Game.stopLuaProfiler() then
+			player:sendTextMessage(MESSAGE_INFO_DESCR, "Lua profiler stopped.")
+		else
+			player:sendTextMessage(MESSAGE_INFO_DESCR, "Lua profiler is not running.")
+		end
+	elseif action == "dump" then
+		local fileName = split[2] or "luaprofile.folded"
+		if Game.dumpLuaProfile(fileName) then
+			player:sendTextMessage(MESSAGE_INFO_DESCR, string.format("Lua profile written to data/logs/%s.", fileName))
+		else
+			player:sendTextMessage(MESSAGE_INFO_DESCR, string.format("Could not write %s.", fileName))
+		end
+	else
+		player:sendTextMessage(MESSAGE_INFO_DESCR, "Usage: /luaprofiler start [interval], stop, dump [file]")
+	end
+	return false
+end
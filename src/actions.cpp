@@ -38,6 +38,7 @@ void Actions::clear(bool fromLua)
 	clearMap(useItemMap, fromLua);
 	clearMap(uniqueItemMap, fromLua);
 	clearMap(actionItemMap, fromLua);
+	useItemIndexValid = false;
 
 	reInitState(fromLua);
 }
@@ -57,6 +58,7 @@ Event_ptr Actions::getEvent(const std::string& nodeName)
 bool Actions::registerEvent(Event_ptr event, const pugi::xml_node& node)
 {
 	Action_ptr action{static_cast<Action*>(event.release())}; // event is guaranteed to be an Action
+	useItemIndexValid = false;
 
 	pugi::xml_attribute attr;
 	if ((attr = node.attribute("itemid"))) {
@@ -194,6 +196,7 @@ bool Actions::registerEvent(Event_ptr event, const pugi::xml_node& node)
 bool Actions::registerLuaEvent(Action* event)
 {
 	Action_ptr action{event};
+	useItemIndexValid = false;
 	if (!action->getItemIdRange().empty()) {
 		const auto& range = action->getItemIdRange();
 		for (auto id : range) {
@@ -292,9 +295,21 @@ Action* Actions::getAction(const Item* item)
 		}
 	}
 
-	auto it = useItemMap.find(item->getID());
-	if (it != useItemMap.end()) {
-		return &it->second;
+	if (!useItemIndexValid) {
+		useItemIndex.clear();
+		for (auto& it : useItemMap) {
+			if (it.first >= useItemIndex.size()) {
+				useItemIndex.resize(it.first + 1);
+			}
+			useItemIndex[it.first] = &it.second;
+		}
+		useItemIndexValid = true;
+	}
+
+	if (item->getID() < useItemIndex.size()) {
+		if (Action* action = useItemIndex[item->getID()]) {
+			return action;
+		}
 	}
 
 	// rune items
@@ -349,6 +364,23 @@ ReturnValue Actions::internalUseItem(Player* player, const Position& pos, uint8_
 
 		// depot container
 		if (DepotLocker* depot = container->getDepotLocker()) {
+			if (!player->hasLoadedDepots()) {
+				// opened once it is loaded, unless the player walked away meanwhile
+				player->loadDepots([tile = depot->getTile(), index](Player* player) {
+					if (!Position::areInRange<1, 1, 0>(player->getPosition(), tile->getPosition())) {
+						return;
+					}
+
+					DepotLocker& myDepotLocker = player->getDepotLocker();
+					myDepotLocker.setParent(tile);
+					if (player->getContainerID(&myDepotLocker) == -1) {
+						player->addContainer(index, &myDepotLocker);
+						player->onSendContainer(&myDepotLocker);
+					}
+				});
+				return RETURNVALUE_NOERROR;
+			}
+
 			DepotLocker& myDepotLocker = player->getDepotLocker();
 			myDepotLocker.setParent(depot->getParent()->getTile());
 			openContainer = &myDepotLocker;
@@ -574,8 +606,7 @@ bool Action::executeUse(Player* player, Item* item, const Position& fromPosition
 
 	scriptInterface->pushFunction(scriptId);
 
-	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::pushCreature(L, player);
 
 	LuaScriptInterface::pushThing(L, item);
 	LuaScriptInterface::pushPosition(L, fromPosition);
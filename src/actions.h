@@ -93,11 +93,15 @@ private:
 	Event_ptr getEvent(const std::string& nodeName) override;
 	bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
-	using ActionUseMap = std::map<uint16_t, Action>;
+	using ActionUseMap = std::unordered_map<uint16_t, Action>;
 	ActionUseMap useItemMap;
 	ActionUseMap uniqueItemMap;
 	ActionUseMap actionItemMap;
 
+	// actions of useItemMap by item id, rebuilt on the first use after the actions changed
+	std::vector<Action*> useItemIndex;
+	bool useItemIndexValid = false;
+
 	Action* getAction(const Item* item);
 	void clearMap(ActionUseMap& map, bool fromLua);
 
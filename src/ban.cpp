@@ -44,10 +44,8 @@ bool Ban::acceptConnection(const Connection::Address& clientIP)
 	return true;
 }
 
-bool IOBan::isAccountBanned(uint32_t accountId, BanInfo& banInfo)
+bool IOBan::isAccountBanned(uint32_t accountId, BanInfo& banInfo, Database& db /* = Database::getInstance()*/)
 {
-	Database& db = Database::getInstance();
-
 	DBResult_ptr result = db.storeQuery(fmt::format(
 	    "SELECT `reason`, `expires_at`, `banned_at`, `banned_by`, (SELECT `name` FROM `players` WHERE `id` = `banned_by`) AS `name` FROM `account_bans` WHERE `account_id` = {:d}",
 	    accountId));
@@ -61,8 +59,10 @@ bool IOBan::isAccountBanned(uint32_t accountId, BanInfo& banInfo)
 		g_databaseTasks.addTask(fmt::format(
 		    "INSERT INTO `account_ban_history` (`account_id`, `reason`, `banned_at`, `expired_at`, `banned_by`) VALUES ({:d}, {:s}, {:d}, {:d}, {:d})",
 		    accountId, db.escapeString(result->getString("reason")), result->getNumber<time_t>("banned_at"), expiresAt,
-		    result->getNumber<uint32_t>("banned_by")));
-		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId));
+		    result->getNumber<uint32_t>("banned_by")),
+		    nullptr, false, accountId);
+		g_databaseTasks.addTask(fmt::format("DELETE FROM `account_bans` WHERE `account_id` = {:d}", accountId),
+		                        nullptr, false, accountId);
 		return false;
 	}
 
@@ -100,9 +100,7 @@ bool IOBan::isIpBanned(const Connection::Address& clientIP, BanInfo& banInfo)
 	return true;
 }
 
-bool IOBan::isPlayerNamelocked(uint32_t playerId)
+bool IOBan::isPlayerNamelocked(uint32_t playerId, Database& db /* = Database::getInstance()*/)
 {
-	return Database::getInstance()
-	    .storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId))
-	    .get();
+	return db.storeQuery(fmt::format("SELECT 1 FROM `player_namelocks` WHERE `player_id` = {:d}", playerId)).get();
 }
@@ -5,6 +5,7 @@
 #define FS_BAN_H
 
 #include "connection.h"
+#include "database.h"
 
 struct BanInfo
 {
@@ -39,9 +40,9 @@ private:
 class IOBan
 {
 public:
-	static bool isAccountBanned(uint32_t accountId, BanInfo& banInfo);
+	static bool isAccountBanned(uint32_t accountId, BanInfo& banInfo, Database& db = Database::getInstance());
 	static bool isIpBanned(const Connection::Address& clientIP, BanInfo& banInfo);
-	static bool isPlayerNamelocked(uint32_t playerId);
+	static bool isPlayerNamelocked(uint32_t playerId, Database& db = Database::getInstance());
 };
 
 #endif // FS_BAN_H
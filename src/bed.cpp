@@ -8,6 +8,7 @@
 #include "condition.h"
 #include "game.h"
 #include "iologindata.h"
+#include "logintasks.h"
 #include "scheduler.h"
 
 extern Game g_game;
@@ -167,13 +168,9 @@ void BedItem::wakeUp(Player* player)
 
 	if (sleeperGUID != 0) {
 		if (!player) {
-			Player regenPlayer(nullptr);
-			if (IOLoginData::loadPlayerById(&regenPlayer, sleeperGUID)) {
-				regeneratePlayer(&regenPlayer);
-				IOLoginData::savePlayer(&regenPlayer);
-			}
+			wakeUpOffline(sleeperGUID, sleepStart);
 		} else {
-			regeneratePlayer(player);
+			regeneratePlayer(player, sleepStart);
 			g_game.addCreatureHealth(player);
 		}
 	}
@@ -198,7 +195,29 @@ void BedItem::wakeUp(Player* player)
 	}
 }
 
-void BedItem::regeneratePlayer(Player* player) const
+void BedItem::wakeUpOffline(uint32_t guid, uint64_t sleepStart)
+{
+	if (Player* player = g_game.getPlayerByGUID(guid)) {
+		regeneratePlayer(player, sleepStart);
+		g_game.addCreatureHealth(player);
+		return;
+	}
+
+	// a load of the sleeper would not see the regeneration and overwrite it with its next save
+	if (!g_loginTasks.beginOfflineWrite(guid)) {
+		g_loginTasks.afterLoad(guid, [=]() { wakeUpOffline(guid, sleepStart); });
+		return;
+	}
+
+	Player regenPlayer(nullptr);
+	if (IOLoginData::loadPlayerById(&regenPlayer, guid)) {
+		regeneratePlayer(&regenPlayer, sleepStart);
+		IOLoginData::savePlayer(&regenPlayer);
+	}
+	g_loginTasks.endOfflineWrite(guid);
+}
+
+void BedItem::regeneratePlayer(Player* player, uint64_t sleepStart)
 {
 	const uint32_t sleptTime = time(nullptr) - sleepStart;
 
@@ -37,7 +37,8 @@ public:
 
 private:
 	void updateAppearance(const Player* player);
-	void regeneratePlayer(Player* player) const;
+	static void regeneratePlayer(Player* player, uint64_t sleepStart);
+	static void wakeUpOffline(uint32_t guid, uint64_t sleepStart);
 	void internalSetSleeper(const Player* player);
 	void internalRemoveSleeper();
 
@@ -190,8 +190,12 @@ bool ConfigManager::load()
 		}
 
 		integer[STATUS_PORT] = getGlobalNumber(L, "statusProtocolPort", 7171);
+		integer[METRICS_PORT] = getGlobalNumber(L, "metricsPort", 0);
+		string[METRICS_IP] = getGlobalString(L, "metricsIp", "127.0.0.1");
 
 		integer[MARKET_OFFER_DURATION] = getGlobalNumber(L, "marketOfferDuration", 30 * 24 * 60 * 60);
+		integer[LOGIN_WORKER_THREADS] = getGlobalNumber(L, "loginWorkerThreads", 2);
+		integer[DATABASE_TASK_WORKERS] = getGlobalNumber(L, "databaseTaskWorkers", 2);
 	}
 
 	boolean[ALLOW_CHANGEOUTFIT] = getGlobalBoolean(L, "allowChangeOutfit", true);
@@ -232,6 +236,12 @@ bool ConfigManager::load()
 	boolean[TWO_FACTOR_AUTH] = getGlobalBoolean(L, "enableTwoFactorAuth", true);
 	boolean[CHECK_DUPLICATE_STORAGE_KEYS] = getGlobalBoolean(L, "checkDuplicateStorageKeys", false);
 	boolean[MONSTER_OVERSPAWN] = getGlobalBoolean(L, "monsterOverspawn", false);
+	boolean[INCREMENTAL_PLAYER_SAVE] = getGlobalBoolean(L, "incrementalPlayerSave", true);
+	boolean[CHECK_PLAYER_SAVE_CONSISTENCY] = getGlobalBoolean(L, "checkPlayerSaveConsistency", false);
+	boolean[LAZY_DEPOT_LOADING] = getGlobalBoolean(L, "lazyDepotLoading", true);
+	boolean[CHECK_ITEM_COUNT_INDEX] = getGlobalBoolean(L, "checkItemCountIndex", false);
+	boolean[LUA_PROFILER] = getGlobalBoolean(L, "luaProfiler", false);
+	boolean[PRELOAD_MONSTER_TYPES] = getGlobalBoolean(L, "preloadMonsterTypes", false);
 
 	string[DEFAULT_PRIORITY] = getGlobalString(L, "defaultPriority", "high");
 	string[SERVER_NAME] = getGlobalString(L, "serverName", "");
@@ -240,6 +250,7 @@ bool ConfigManager::load()
 	string[URL] = getGlobalString(L, "url", "");
 	string[LOCATION] = getGlobalString(L, "location", "");
 	string[WORLD_TYPE] = getGlobalString(L, "worldType", "pvp");
+	string[LUA_BYTECODE_CACHE] = getGlobalString(L, "luaBytecodeCache", "cache/lua");
 
 	integer[MAX_PLAYERS] = getGlobalNumber(L, "maxPlayers");
 	integer[PZ_LOCKED] = getGlobalNumber(L, "pzLocked", 60000);
@@ -279,6 +290,11 @@ bool ConfigManager::load()
 	integer[QUEST_TRACKER_PREMIUM_LIMIT] = getGlobalNumber(L, "questTrackerPremiumLimit", 15);
 	integer[STAMINA_REGEN_MINUTE] = getGlobalNumber(L, "timeToRegenMinuteStamina", 3 * 60);
 	integer[STAMINA_REGEN_PREMIUM] = getGlobalNumber(L, "timeToRegenMinutePremiumStamina", 10 * 60);
+	integer[LOGIN_QUEUE_SIZE] = getGlobalNumber(L, "maxLoginQueueSize", 100);
+	integer[LUA_PROFILER_INTERVAL] = getGlobalNumber(L, "luaProfilerInterval", 1000);
+	integer[LUA_GC_PAUSE] = getGlobalNumber(L, "luaGcPause", 200);
+	integer[LUA_GC_STEPMUL] = getGlobalNumber(L, "luaGcStepMul", 200);
+	integer[LUA_GC_STEP_BUDGET] = getGlobalNumber(L, "luaGcStepBudget", 1000);
 
 	expStages = loadXMLStages();
 	if (expStages.empty()) {
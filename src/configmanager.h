@@ -53,6 +53,12 @@ public:
 		TWO_FACTOR_AUTH,
 		CHECK_DUPLICATE_STORAGE_KEYS,
 		MONSTER_OVERSPAWN,
+		INCREMENTAL_PLAYER_SAVE,
+		CHECK_PLAYER_SAVE_CONSISTENCY,
+		LAZY_DEPOT_LOADING,
+		CHECK_ITEM_COUNT_INDEX,
+		LUA_PROFILER,
+		PRELOAD_MONSTER_TYPES,
 
 		LAST_BOOLEAN_CONFIG /* this must be the last one */
 	};
@@ -76,6 +82,8 @@ public:
 		DEFAULT_PRIORITY,
 		MAP_AUTHOR,
 		CONFIG_FILE,
+		LUA_BYTECODE_CACHE,
+		METRICS_IP,
 
 		LAST_STRING_CONFIG /* this must be the last one */
 	};
@@ -125,6 +133,14 @@ public:
 		QUEST_TRACKER_PREMIUM_LIMIT,
 		STAMINA_REGEN_MINUTE,
 		STAMINA_REGEN_PREMIUM,
+		LOGIN_WORKER_THREADS,
+		LOGIN_QUEUE_SIZE,
+		DATABASE_TASK_WORKERS,
+		LUA_PROFILER_INTERVAL,
+		LUA_GC_PAUSE,
+		LUA_GC_STEPMUL,
+		LUA_GC_STEP_BUDGET,
+		METRICS_PORT,
 
 		LAST_INTEGER_CONFIG /* this must be the last one */
 	};
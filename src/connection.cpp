@@ -6,6 +6,7 @@
 #include "connection.h"
 
 #include "configmanager.h"
+#include "metrics.h"
 #include "outputmessage.h"
 #include "protocol.h"
 #include "server.h"
@@ -117,7 +118,8 @@ void Connection::accept()
 		                        : NetworkMessage::HEADER_LENGTH;
 		boost::asio::async_read(
 		    socket, boost::asio::buffer(msg.getBuffer(), bufferLength),
-		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
+		    [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t bytes_transferred) {
+			    g_metrics.addBytesReceived(bytes_transferred);
 			    thisPtr->parseHeader(error);
 		    });
 	} catch (boost::system::system_error& e) {
@@ -194,7 +196,8 @@ void Connection::parseHeader(const boost::system::error_code& error)
 		msg.setLength(size + NetworkMessage::HEADER_LENGTH);
 		boost::asio::async_read(
 		    socket, boost::asio::buffer(msg.getBodyBuffer(), size),
-		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
+		    [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t bytes_transferred) {
+			    g_metrics.addBytesReceived(bytes_transferred);
 			    thisPtr->parsePacket(error);
 		    });
 	} catch (boost::system::system_error& e) {
@@ -253,7 +256,8 @@ void Connection::parsePacket(const boost::system::error_code& error)
 		// Wait to the next packet
 		boost::asio::async_read(
 		    socket, boost::asio::buffer(msg.getBuffer(), NetworkMessage::HEADER_LENGTH),
-		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
+		    [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t bytes_transferred) {
+			    g_metrics.addBytesReceived(bytes_transferred);
 			    thisPtr->parseHeader(error);
 		    });
 	} catch (boost::system::system_error& e) {
@@ -288,7 +292,8 @@ void Connection::internalSend(const OutputMessage_ptr& msg)
 
 		boost::asio::async_write(
 		    socket, boost::asio::buffer(msg->getOutputBuffer(), msg->getLength()),
-		    [thisPtr = shared_from_this()](const boost::system::error_code& error, auto /*bytes_transferred*/) {
+		    [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t bytes_transferred) {
+			    g_metrics.addBytesSent(bytes_transferred);
 			    thisPtr->onWriteOperation(error);
 		    });
 	} catch (boost::system::system_error& e) {
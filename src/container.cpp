@@ -28,7 +28,7 @@ Container::Container(Tile* tile) : Container(ITEM_BROWSEFIELD, 30, false, true)
 		for (Item* item : *itemVector) {
 			if ((item->getContainer() || item->hasProperty(CONST_PROP_MOVEABLE)) &&
 			    !item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID)) {
-				itemlist.push_front(item);
+				itemlist.push_back(item);
 				item->setParent(this);
 			}
 		}
@@ -56,8 +56,11 @@ Container::~Container()
 Item* Container::clone() const
 {
 	Container* clone = static_cast<Container*>(Item::clone());
+	clone->itemlist.reserve(itemlist.size());
 	for (Item* item : itemlist) {
-		clone->addItem(item->clone());
+		Item* itemClone = item->clone();
+		clone->itemlist.push_back(itemClone);
+		itemClone->setParent(clone);
 	}
 	clone->totalWeight = totalWeight;
 	return clone;
@@ -82,7 +85,7 @@ bool Container::hasParent() const { return getID() != ITEM_BROWSEFIELD && !dynam
 
 void Container::addItem(Item* item)
 {
-	itemlist.push_back(item);
+	itemlist.insert(itemlist.begin(), item);
 	item->setParent(this);
 }
 
@@ -125,9 +128,13 @@ bool Container::unserializeItemNode(OTB::Loader& loader, const OTB::Node& node,
 			return false;
 		}
 
-		addItem(item);
+		itemlist.push_back(item);
+		item->setParent(this);
 		updateItemWeight(item->getWeight());
 	}
+
+	// the children are stored from the front to the back and the container is empty before it is loaded
+	std::reverse(itemlist.begin(), itemlist.end());
 	return true;
 }
 
@@ -146,7 +153,7 @@ Item* Container::getItemByIndex(size_t index) const
 	if (index >= size()) {
 		return nullptr;
 	}
-	return itemlist[index];
+	return itemlist[size() - 1 - index];
 }
 
 uint32_t Container::getItemHoldingCount() const
@@ -170,6 +177,8 @@ bool Container::isHoldingItem(const Item* item) const
 
 void Container::onAddContainerItem(Item* item)
 {
+	setHouseItemsChanged();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -188,6 +197,8 @@ void Container::onAddContainerItem(Item* item)
 
 void Container::onUpdateContainerItem(uint32_t index, Item* oldItem, Item* newItem)
 {
+	setHouseItemsChanged();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -206,6 +217,8 @@ void Container::onUpdateContainerItem(uint32_t index, Item* oldItem, Item* newIt
 
 void Container::onRemoveContainerItem(uint32_t index, Item* item)
 {
+	setHouseItemsChanged();
+
 	SpectatorVec spectators;
 	g_game.map.getSpectators(spectators, getPosition(), false, true, 1, 1, 1, 1);
 
@@ -333,7 +346,7 @@ ReturnValue Container::queryMaxCount(int32_t index, const Thing& thing, uint32_t
 		if (index == INDEX_WHEREEVER) {
 			// Iterate through every item and check how much free stackable slots there is.
 			uint32_t slotIndex = 0;
-			for (Item* containerItem : itemlist) {
+			for (Item* containerItem : getItemList()) {
 				if (containerItem != item && containerItem->equals(item) && containerItem->getItemCount() < 100) {
 					if (queryAdd(slotIndex++, *item, count, flags) == RETURNVALUE_NOERROR) {
 						n += 100 - containerItem->getItemCount();
@@ -455,7 +468,7 @@ Cylinder* Container::queryDestination(int32_t& index, const Thing& thing, Item**
 
 		// try find a suitable item to stack with
 		uint32_t n = 0;
-		for (Item* listItem : itemlist) {
+		for (Item* listItem : getItemList()) {
 			if (listItem != item && listItem->equals(item) && listItem->getItemCount() < 100) {
 				*destItem = listItem;
 				index = n;
@@ -481,7 +494,7 @@ void Container::addThing(int32_t index, Thing* thing)
 	}
 
 	item->setParent(this);
-	itemlist.push_front(item);
+	itemlist.push_back(item);
 	updateItemWeight(item->getWeight());
 	ammoCount += item->getItemCount();
 
@@ -543,7 +556,7 @@ void Container::replaceThing(uint32_t index, Thing* thing)
 
 	ammoCount -= replacedItem->getItemCount();
 
-	itemlist[index] = item;
+	itemlist[size() - 1 - index] = item;
 	item->setParent(this);
 	updateItemWeight(-static_cast<int32_t>(replacedItem->getWeight()) + item->getWeight());
 
@@ -593,20 +606,17 @@ void Container::removeThing(Thing* thing, uint32_t count)
 		}
 
 		item->setParent(nullptr);
-		itemlist.erase(itemlist.begin() + index);
+		itemlist.erase(itemlist.begin() + (size() - 1 - index));
 	}
 }
 
 int32_t Container::getThingIndex(const Thing* thing) const
 {
-	int32_t index = 0;
-	for (Item* item : itemlist) {
-		if (item == thing) {
-			return index;
-		}
-		++index;
+	auto it = std::find(itemlist.begin(), itemlist.end(), thing);
+	if (it == itemlist.end()) {
+		return -1;
 	}
-	return -1;
+	return std::distance(it, itemlist.end()) - 1;
 }
 
 size_t Container::getFirstIndex() const { return 0; }
@@ -640,7 +650,7 @@ ItemVector Container::getItems(bool recursive /*= false*/)
 			containerItems.push_back(*it);
 		}
 	} else {
-		for (Item* item : itemlist) {
+		for (Item* item : getItemList()) {
 			containerItems.push_back(item);
 		}
 	}
@@ -689,7 +699,7 @@ void Container::internalAddThing(uint32_t, Thing* thing)
 	}
 
 	item->setParent(this);
-	itemlist.push_front(item);
+	itemlist.push_back(item);
 	updateItemWeight(item->getWeight());
 	ammoCount += item->getItemCount();
 }
@@ -707,30 +717,22 @@ ContainerIterator Container::iterator() const
 {
 	ContainerIterator cit;
 	if (!itemlist.empty()) {
-		cit.over.push_back(this);
-		cit.cur = itemlist.begin();
+		cit.over.push_back({this, itemlist.rbegin()});
 	}
 	return cit;
 }
 
-Item* ContainerIterator::operator*() { return *cur; }
-
 void ContainerIterator::advance()
 {
-	if (Item* i = *cur) {
-		if (Container* c = i->getContainer()) {
-			if (!c->empty()) {
-				over.push_back(c);
-			}
-		}
-	}
+	const Container* container = (*over.back().cur)->getContainer();
+	++over.back().cur;
 
-	++cur;
+	if (container && !container->empty()) {
+		over.push_back({container, container->itemlist.rbegin()});
+		return;
+	}
 
-	if (cur == over.front()->itemlist.end()) {
-		over.pop_front();
-		if (!over.empty()) {
-			cur = over.front()->itemlist.begin();
-		}
+	while (!over.empty() && over.back().cur == over.back().container->itemlist.rend()) {
+		over.pop_back();
 	}
 }
@@ -8,21 +8,31 @@
 #include "item.h"
 #include "tile.h"
 
+#include <boost/range/iterator_range.hpp>
+
 class Container;
 class DepotLocker;
 class StoreInbox;
 
+using ContainerItemRange = boost::iterator_range<ContainerItemVector::const_reverse_iterator>;
+
 class ContainerIterator
 {
 public:
 	bool hasNext() const { return !over.empty(); }
 
 	void advance();
-	Item* operator*();
+	Item* operator*() { return *over.back().cur; }
 
 private:
-	std::list<const Container*> over;
-	ItemDeque::const_iterator cur;
+	struct Frame
+	{
+		const Container* container;
+		ContainerItemVector::const_reverse_iterator cur;
+	};
+
+	// depth-first, one frame per nesting level, so only containers nested deeper than 8 levels allocate
+	boost::container::small_vector<Frame, 8> over;
 
 	friend class Container;
 };
@@ -60,10 +70,11 @@ public:
 
 	ContainerIterator iterator() const;
 
-	const ItemDeque& getItemList() const { return itemlist; }
+	// the items from the front (index 0) to the back of the container
+	ContainerItemRange getItemList() const { return {itemlist.rbegin(), itemlist.rend()}; }
 
-	ItemDeque::const_reverse_iterator getReversedItems() const { return itemlist.rbegin(); }
-	ItemDeque::const_reverse_iterator getReversedEnd() const { return itemlist.rend(); }
+	ContainerItemVector::const_iterator getReversedItems() const { return itemlist.begin(); }
+	ContainerItemVector::const_iterator getReversedEnd() const { return itemlist.end(); }
 
 	std::string getName(bool addArticle = false) const;
 
@@ -115,7 +126,8 @@ public:
 	void startDecaying() override final;
 
 protected:
-	ItemDeque itemlist;
+	// stored from the back to the front, so that adding to the front of the container is a push_back
+	ContainerItemVector itemlist;
 
 private:
 	uint32_t maxSize;
@@ -11,8 +11,26 @@
 
 extern ConfigManager g_config;
 
+namespace {
+
+// my_bool in older client libraries, bool since MySQL 8.0
+using mysql_bool_t = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+constexpr size_t MAX_INSERT_BATCH_ROWS = 64;
+
+bool isConnectionError(unsigned int error)
+{
+	return error == CR_SERVER_LOST || error == CR_SERVER_GONE_ERROR || error == CR_CONN_HOST_ERROR ||
+	       error == 1053 /*ER_SERVER_SHUTDOWN*/ || error == CR_CONNECTION_ERROR;
+}
+
+} // namespace
+
 Database::~Database()
 {
+	// statements have to be closed while the connection is still open
+	statements.clear();
+
 	if (handle) {
 		mysql_close(handle);
 	}
@@ -173,6 +191,294 @@ std::string Database::escapeBlob(const char* s, uint32_t length) const
 	return escaped;
 }
 
+DBStatement& Database::prepare(const std::string& query)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(databaseLock);
+
+	auto it = statements.find(query);
+	if (it != statements.end()) {
+		return *it->second;
+	}
+
+	auto statement = std::make_unique<DBStatement>(*this, query);
+	statement->prepare();
+	return *statements.emplace(query, std::move(statement)).first->second;
+}
+
+DBStatement::~DBStatement()
+{
+	if (handle) {
+		mysql_stmt_close(handle);
+	}
+}
+
+unsigned int DBStatement::prepare()
+{
+	handle = mysql_stmt_init(db.handle);
+	if (!handle) {
+		std::cout << "[Error - mysql_stmt_init] Message: " << mysql_error(db.handle) << std::endl;
+		return mysql_errno(db.handle);
+	}
+
+	if (mysql_stmt_prepare(handle, queryString.c_str(), queryString.length()) != 0) {
+		std::cout << "[Error - mysql_stmt_prepare] Query: " << queryString.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(handle) << std::endl;
+		unsigned int error = mysql_stmt_errno(handle);
+		mysql_stmt_close(handle);
+		handle = nullptr;
+		return error;
+	}
+
+	// lets DBStatement::query size the column buffers once per result
+	mysql_bool_t updateMaxLength = 1;
+	mysql_stmt_attr_set(handle, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+	return 0;
+}
+
+bool DBStatement::run(const DBParams& params)
+{
+	std::vector<MYSQL_BIND> binds(params.size());
+	std::vector<unsigned long> lengths(params.size());
+	for (size_t i = 0; i < params.size(); ++i) {
+		const DBParam& param = params[i];
+		MYSQL_BIND& bind = binds[i];
+		std::visit(
+		    [&](const auto& value) {
+			    using T = std::decay_t<decltype(value)>;
+			    bind.buffer = const_cast<T*>(&value);
+			    if constexpr (std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>) {
+				    bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				    bind.is_unsigned = std::is_same_v<T, uint64_t>;
+			    } else if constexpr (std::is_same_v<T, double>) {
+				    bind.buffer_type = MYSQL_TYPE_DOUBLE;
+			    } else {
+				    lengths[i] = value.length();
+				    bind.buffer_type = param.binary ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+				    bind.buffer = const_cast<char*>(value.data());
+				    bind.buffer_length = value.length();
+				    bind.length = &lengths[i];
+			    }
+		    },
+		    param.value);
+	}
+
+	while (true) {
+		unsigned int error = handle ? 0 : prepare();
+		if (handle) {
+			if (mysql_stmt_param_count(handle) != params.size()) {
+				std::cout << "[Error - DBStatement::run] Query: " << queryString.substr(0, 256) << std::endl
+				          << "Message: expected " << mysql_stmt_param_count(handle) << " parameters, got "
+				          << params.size() << '.' << std::endl;
+				return false;
+			}
+
+			if (mysql_stmt_bind_param(handle, binds.data()) == 0 && mysql_stmt_execute(handle) == 0) {
+				return true;
+			}
+
+			std::cout << "[Error - mysql_stmt_execute] Query: " << queryString.substr(0, 256) << std::endl
+			          << "Message: " << mysql_stmt_error(handle) << std::endl;
+			error = mysql_stmt_errno(handle);
+		}
+
+		// statements do not survive a reconnect, so they are prepared again
+		if (!isConnectionError(error) && error != 1243 /*ER_UNKNOWN_STMT_HANDLER*/) {
+			return false;
+		}
+
+		if (handle) {
+			mysql_stmt_close(handle);
+			handle = nullptr;
+		}
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+	}
+}
+
+bool DBStatement::execute(const DBParams& params /* = {}*/)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(db.databaseLock);
+	if (!run(params)) {
+		return false;
+	}
+
+	affectedRows = mysql_stmt_affected_rows(handle);
+	mysql_stmt_free_result(handle);
+	return true;
+}
+
+DBStatementResult_ptr DBStatement::query(const DBParams& params /* = {}*/)
+{
+	std::lock_guard<std::recursive_mutex> lockGuard(db.databaseLock);
+	if (!run(params)) {
+		return nullptr;
+	}
+
+	MYSQL_RES* metadata = mysql_stmt_result_metadata(handle);
+	if (!metadata) {
+		std::cout << "[Error - DBStatement::query] Query: " << queryString.substr(0, 256) << std::endl
+		          << "Message: statement does not return a result set." << std::endl;
+		return nullptr;
+	}
+
+	if (mysql_stmt_store_result(handle) != 0) {
+		std::cout << "[Error - mysql_stmt_store_result] Query: " << queryString.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(handle) << std::endl;
+		mysql_free_result(metadata);
+		return nullptr;
+	}
+
+	struct Column
+	{
+		DBStatementResult::ColumnType type;
+		int64_t integer;
+		double real;
+		std::vector<char> bytes;
+		unsigned long length;
+		mysql_bool_t isNull;
+	};
+
+	auto result = std::make_shared<DBStatementResult>();
+
+	const unsigned int columnCount = mysql_num_fields(metadata);
+	const MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+	std::vector<Column> columns(columnCount);
+	std::vector<MYSQL_BIND> binds(columnCount);
+	for (unsigned int i = 0; i < columnCount; ++i) {
+		const MYSQL_FIELD& field = fields[i];
+		result->listNames[field.name] = i;
+
+		Column& column = columns[i];
+		MYSQL_BIND& bind = binds[i];
+		bind.length = &column.length;
+		bind.is_null = &column.isNull;
+
+		switch (field.type) {
+			case MYSQL_TYPE_TINY:
+			case MYSQL_TYPE_SHORT:
+			case MYSQL_TYPE_INT24:
+			case MYSQL_TYPE_LONG:
+			case MYSQL_TYPE_LONGLONG:
+			case MYSQL_TYPE_YEAR:
+				column.type = (field.flags & UNSIGNED_FLAG) != 0 ? DBStatementResult::COLUMN_UNSIGNED
+				                                                 : DBStatementResult::COLUMN_SIGNED;
+				bind.buffer_type = MYSQL_TYPE_LONGLONG;
+				bind.buffer = &column.integer;
+				bind.is_unsigned = column.type == DBStatementResult::COLUMN_UNSIGNED;
+				break;
+
+			case MYSQL_TYPE_FLOAT:
+			case MYSQL_TYPE_DOUBLE:
+				column.type = DBStatementResult::COLUMN_DOUBLE;
+				bind.buffer_type = MYSQL_TYPE_DOUBLE;
+				bind.buffer = &column.real;
+				break;
+
+			default:
+				column.type = DBStatementResult::COLUMN_BYTES;
+				column.bytes.resize(std::max<unsigned long>(field.max_length, 1));
+				bind.buffer_type = MYSQL_TYPE_BLOB;
+				bind.buffer = column.bytes.data();
+				bind.buffer_length = column.bytes.size();
+				break;
+		}
+	}
+
+	if (mysql_stmt_bind_result(handle, binds.data()) != 0) {
+		std::cout << "[Error - mysql_stmt_bind_result] Query: " << queryString.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(handle) << std::endl;
+		mysql_stmt_free_result(handle);
+		mysql_free_result(metadata);
+		return nullptr;
+	}
+
+	result->rows.reserve(mysql_stmt_num_rows(handle));
+
+	int status;
+	while ((status = mysql_stmt_fetch(handle)) == 0) {
+		auto& row = result->rows.emplace_back(columnCount);
+		for (unsigned int i = 0; i < columnCount; ++i) {
+			const Column& column = columns[i];
+			if (column.isNull) {
+				continue;
+			}
+
+			switch (column.type) {
+				case DBStatementResult::COLUMN_SIGNED:
+					row[i].data = column.integer;
+					break;
+				case DBStatementResult::COLUMN_UNSIGNED:
+					row[i].data = static_cast<uint64_t>(column.integer);
+					break;
+				case DBStatementResult::COLUMN_DOUBLE:
+					row[i].data = column.real;
+					break;
+				case DBStatementResult::COLUMN_BYTES:
+					row[i].data = std::string(column.bytes.data(), column.length);
+					break;
+			}
+		}
+	}
+
+	if (status != MYSQL_NO_DATA) {
+		std::cout << "[Error - mysql_stmt_fetch] Query: " << queryString.substr(0, 256) << std::endl
+		          << "Message: " << mysql_stmt_error(handle) << std::endl;
+	}
+
+	// the statement is reusable as soon as its rows are copied out
+	mysql_stmt_free_result(handle);
+	mysql_free_result(metadata);
+
+	if (status != MYSQL_NO_DATA || result->rows.empty()) {
+		return nullptr;
+	}
+	return result;
+}
+
+const DBStatementResult::Value* DBStatementResult::getValue(const std::string& s, const char* function) const
+{
+	auto it = listNames.find(s);
+	if (it == listNames.end()) {
+		std::cout << "[Error - DBStatementResult::" << function << "] Column '" << s
+		          << "' does not exist in result set." << std::endl;
+		return nullptr;
+	}
+	return &rows[current][it->second];
+}
+
+std::string DBStatementResult::getString(const std::string& s) const
+{
+	const Value* value = getValue(s, "getString");
+	if (!value) {
+		return std::string();
+	}
+
+	switch (value->data.index()) {
+		case 1:
+			return std::to_string(std::get<int64_t>(value->data));
+		case 2:
+			return std::to_string(std::get<uint64_t>(value->data));
+		case 3:
+			return std::to_string(std::get<double>(value->data));
+		case 4:
+			return std::get<std::string>(value->data);
+		default:
+			return std::string();
+	}
+}
+
+const char* DBStatementResult::getStream(const std::string& s, unsigned long& size) const
+{
+	const Value* value = getValue(s, "getStream");
+	if (!value || !std::holds_alternative<std::string>(value->data)) {
+		size = 0;
+		return nullptr;
+	}
+
+	const std::string& bytes = std::get<std::string>(value->data);
+	size = bytes.length();
+	return bytes.data();
+}
+
 DBResult::DBResult(MYSQL_RES* res)
 {
 	handle = res;
@@ -276,3 +582,69 @@ bool DBInsert::execute()
 	length = query.length();
 	return res;
 }
+
+bool DBStatementInsert::addRow(DBParams&& row)
+{
+	size_t rowLength = 0;
+	for (const DBParam& param : row) {
+		rowLength += param.getPacketLength();
+	}
+
+	// the pending rows are written before the packet would grow too large, as DBInsert does
+	if (!values.empty() && query.length() + suffix.length() + length + rowLength > db.getMaxPacketSize() &&
+	    !execute()) {
+		return false;
+	}
+
+	length += rowLength;
+	values.insert(values.end(), std::make_move_iterator(row.begin()), std::make_move_iterator(row.end()));
+	if (values.size() >= MAX_INSERT_BATCH_ROWS * columns) {
+		length = 0;
+		return executeBatch(MAX_INSERT_BATCH_ROWS);
+	}
+	return true;
+}
+
+bool DBStatementInsert::execute()
+{
+	// power of two batches keep the number of distinct statements per table small
+	size_t rows = values.size() / columns;
+	length = 0;
+	while (rows != 0) {
+		size_t batch = MAX_INSERT_BATCH_ROWS;
+		while (batch > rows) {
+			batch /= 2;
+		}
+
+		if (!executeBatch(batch)) {
+			values.clear();
+			return false;
+		}
+		rows -= batch;
+	}
+	return true;
+}
+
+bool DBStatementInsert::executeBatch(size_t rows)
+{
+	std::string row = "(?";
+	for (size_t i = 1; i < columns; ++i) {
+		row.append(",?");
+	}
+	row.push_back(')');
+
+	std::string statement = query;
+	statement.reserve(query.length() + rows * (row.length() + 1) + suffix.length());
+	for (size_t i = 0; i < rows; ++i) {
+		if (i != 0) {
+			statement.push_back(',');
+		}
+		statement.append(row);
+	}
+	statement.append(suffix);
+
+	const auto end = values.begin() + rows * columns;
+	DBParams params{std::make_move_iterator(values.begin()), std::make_move_iterator(end)};
+	values.erase(values.begin(), end);
+	return db.prepare(statement).execute(params);
+}
@@ -8,6 +8,9 @@
 
 class DBResult;
 using DBResult_ptr = std::shared_ptr<DBResult>;
+class DBStatement;
+class DBStatementResult;
+using DBStatementResult_ptr = std::shared_ptr<DBStatementResult>;
 
 class Database
 {
@@ -95,6 +98,18 @@ public:
 
 	uint64_t getMaxPacketSize() const { return maxPacketSize; }
 
+	/**
+	 * Prepares a statement on this connection.
+	 *
+	 * Statements are cached by their query text for the lifetime of the
+	 * connection, so preparing the same query again is a lookup. Errors are
+	 * reported when the statement is executed.
+	 *
+	 * @param query query with ? placeholders
+	 * @return statement owned by the connection
+	 */
+	DBStatement& prepare(const std::string& query);
+
 private:
 	/**
 	 * Transaction related methods.
@@ -111,10 +126,187 @@ private:
 	MYSQL* handle = nullptr;
 	std::recursive_mutex databaseLock;
 	uint64_t maxPacketSize = 1048576;
+	std::unordered_map<std::string, std::unique_ptr<DBStatement>> statements;
 
+	friend class DBStatement;
 	friend class DBTransaction;
 };
 
+/**
+ * Typed parameter of a prepared statement, strings and blobs are sent as
+ * they are, without escaping.
+ */
+class DBParam
+{
+public:
+	template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+	DBParam(T value)
+	{
+		if constexpr (std::is_signed_v<T>) {
+			this->value = static_cast<int64_t>(value);
+		} else {
+			this->value = static_cast<uint64_t>(value);
+		}
+	}
+	DBParam(double value) : value(value) {}
+	DBParam(std::string value) : value(std::move(value)) {}
+	DBParam(const char* value) : value(std::string(value)) {}
+
+	static DBParam blob(const char* data, size_t size)
+	{
+		DBParam param{std::string(data, size)};
+		param.binary = true;
+		return param;
+	}
+
+	// upper bound of the bytes the value and its type take in the packet executing a statement
+	size_t getPacketLength() const
+	{
+		if (const std::string* str = std::get_if<std::string>(&value)) {
+			return str->length() + 11;
+		}
+		return 10;
+	}
+
+private:
+	std::variant<int64_t, uint64_t, double, std::string> value;
+	bool binary = false;
+
+	friend class DBStatement;
+};
+
+using DBParams = std::vector<DBParam>;
+
+/**
+ * Prepared statement bound to the connection that prepared it.
+ */
+class DBStatement
+{
+public:
+	DBStatement(Database& db, std::string queryString) : db(db), queryString(std::move(queryString)) {}
+	~DBStatement();
+
+	// non-copyable
+	DBStatement(const DBStatement&) = delete;
+	DBStatement& operator=(const DBStatement&) = delete;
+
+	/**
+	 * Executes the statement for queries which don't generate results (eg.
+	 * INSERT, UPDATE, DELETE...).
+	 *
+	 * @return true on success, false on error
+	 */
+	bool execute(const DBParams& params = {});
+
+	/**
+	 * Executes the statement and fetches all of its rows.
+	 *
+	 * @return results object (nullptr on error or when there are no rows)
+	 */
+	DBStatementResult_ptr query(const DBParams& params = {});
+
+	uint64_t getAffectedRows() const { return affectedRows; }
+
+private:
+	unsigned int prepare();
+	bool run(const DBParams& params);
+
+	Database& db;
+	std::string queryString;
+	MYSQL_STMT* handle = nullptr;
+	uint64_t affectedRows = 0;
+
+	friend class Database;
+};
+
+/**
+ * Rows fetched through the binary protocol of a prepared statement. Numbers
+ * are kept in their native representation, strings and blobs as raw bytes.
+ */
+class DBStatementResult
+{
+public:
+	enum ColumnType : uint8_t
+	{
+		COLUMN_SIGNED,
+		COLUMN_UNSIGNED,
+		COLUMN_DOUBLE,
+		COLUMN_BYTES,
+	};
+
+	struct Value
+	{
+		std::variant<std::monostate, int64_t, uint64_t, double, std::string> data;
+	};
+
+	template <typename T>
+	T getNumber(const std::string& s) const
+	{
+		const Value* value = getValue(s, "getNumber");
+		if (!value) {
+			return {};
+		}
+
+		switch (value->data.index()) {
+			case 1:
+				return static_cast<T>(std::get<int64_t>(value->data));
+			case 2:
+				return static_cast<T>(std::get<uint64_t>(value->data));
+			case 3:
+				return static_cast<T>(std::get<double>(value->data));
+			case 4:
+				return pugi::cast<T>(std::get<std::string>(value->data).c_str());
+			default:
+				return {};
+		}
+	}
+
+	std::string getString(const std::string& s) const;
+	const char* getStream(const std::string& s, unsigned long& size) const;
+
+	bool hasNext() const { return current < rows.size(); }
+	bool next() { return ++current < rows.size(); }
+
+private:
+	const Value* getValue(const std::string& s, const char* function) const;
+
+	std::map<std::string, size_t> listNames;
+	std::vector<std::vector<Value>> rows;
+	size_t current = 0;
+
+	friend class DBStatement;
+};
+
+/**
+ * Multi-row INSERT through prepared statements, sent in batches so that
+ * rows with blobs never have to be escaped.
+ */
+class DBStatementInsert
+{
+public:
+	/**
+	 * @param query statement up to and including VALUES
+	 * @param columns number of values per row
+	 * @param suffix appended after the rows, e.g. ON DUPLICATE KEY UPDATE ...
+	 */
+	DBStatementInsert(Database& db, std::string query, size_t columns, std::string suffix = std::string()) :
+	    db(db), query(std::move(query)), suffix(std::move(suffix)), columns(columns)
+	{}
+
+	bool addRow(DBParams&& row);
+	bool execute();
+
+private:
+	bool executeBatch(size_t rows);
+
+	Database& db;
+	std::string query;
+	std::string suffix;
+	size_t columns;
+	DBParams values;
+	size_t length = 0;
+};
+
 class DBResult
 {
 public:
@@ -177,12 +369,12 @@ private:
 class DBTransaction
 {
 public:
-	constexpr DBTransaction() = default;
+	explicit DBTransaction(Database& db = Database::getInstance()) : db(db) {}
 
 	~DBTransaction()
 	{
 		if (state == STATE_START) {
-			Database::getInstance().rollback();
+			db.rollback();
 		}
 	}
 
@@ -193,7 +385,7 @@ public:
 	bool begin()
 	{
 		state = STATE_START;
-		return Database::getInstance().beginTransaction();
+		return db.beginTransaction();
 	}
 
 	bool commit()
@@ -203,7 +395,7 @@ public:
 		}
 
 		state = STATE_COMMIT;
-		return Database::getInstance().commit();
+		return db.commit();
 	}
 
 private:
@@ -214,6 +406,7 @@ private:
 		STATE_COMMIT,
 	};
 
+	Database& db;
 	TransactionStates_t state = STATE_NO_START;
 };
 
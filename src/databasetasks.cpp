@@ -5,54 +5,106 @@
 
 #include "databasetasks.h"
 
+#include "configmanager.h"
 #include "tasks.h"
 
+extern ConfigManager g_config;
 extern Dispatcher g_dispatcher;
 
-void DatabaseTasks::start()
+bool DatabaseTasks::start()
 {
-	db.connect();
-	ThreadHolder::start();
+	int32_t workerCount = std::max<int32_t>(1, g_config.getNumber(ConfigManager::DATABASE_TASK_WORKERS));
+	for (int32_t i = 0; i < workerCount; ++i) {
+		auto worker = std::make_unique<Worker>();
+		if (!worker->db.connect()) {
+			workers.clear();
+			return false;
+		}
+		workers.push_back(std::move(worker));
+	}
+
+	threadState.store(THREAD_STATE_RUNNING, std::memory_order_relaxed);
+	for (auto& worker : workers) {
+		worker->startedAt = std::chrono::steady_clock::now();
+		worker->thread = std::thread(&DatabaseTasks::threadMain, this, std::ref(*worker));
+	}
+	return true;
 }
 
-void DatabaseTasks::threadMain()
+void DatabaseTasks::threadMain(Worker& worker)
 {
-	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
-	while (getState() != THREAD_STATE_TERMINATED) {
-		taskLockUnique.lock();
-		if (tasks.empty()) {
+	std::unique_lock<std::mutex> taskLockUnique(taskLock);
+	while (threadState.load(std::memory_order_relaxed) != THREAD_STATE_TERMINATED) {
+		// tasks bound to this worker keep their order, so they go first
+		std::deque<DatabaseTask>* queue = nullptr;
+		if (!worker.tasks.empty()) {
+			queue = &worker.tasks;
+		} else if (!tasks.empty()) {
+			queue = &tasks;
+		} else {
 			taskSignal.wait(taskLockUnique);
+			continue;
 		}
 
-		if (!tasks.empty()) {
-			DatabaseTask task = std::move(tasks.front());
-			tasks.pop_front();
-			taskLockUnique.unlock();
-			runTask(task);
-		} else {
-			taskLockUnique.unlock();
+		DatabaseTask task = std::move(queue->front());
+		queue->pop_front();
+		worker.busy = true;
+		taskLockUnique.unlock();
+
+		const auto startTime = std::chrono::steady_clock::now();
+		runTask(worker.db, task);
+		const auto duration = std::chrono::steady_clock::now() - startTime;
+
+		taskLockUnique.lock();
+		worker.busy = false;
+		++worker.executed;
+		worker.busyMicros += std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+		worker.waitMicros += std::chrono::duration_cast<std::chrono::microseconds>(startTime - task.queuedAt).count();
+
+		if (isIdle()) {
+			flushSignal.notify_all();
 		}
 	}
 }
 
 void DatabaseTasks::addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback /* = nullptr*/,
-                            bool store /* = false*/)
+                            bool store /* = false*/, size_t key /* = 0*/)
 {
-	bool signal = false;
-	taskLock.lock();
-	if (getState() == THREAD_STATE_RUNNING) {
-		signal = tasks.empty();
-		tasks.emplace_back(std::move(query), std::move(callback), store);
+	enqueue(DatabaseTask(std::move(query), std::move(callback), store), key);
+}
+
+bool DatabaseTasks::addTask(std::function<void(Database&)> function, size_t key /* = 0*/)
+{
+	return enqueue(DatabaseTask(std::move(function)), key);
+}
+
+bool DatabaseTasks::enqueue(DatabaseTask&& task, size_t key)
+{
+	std::unique_lock<std::mutex> guard{taskLock};
+	if (threadState.load(std::memory_order_relaxed) != THREAD_STATE_RUNNING) {
+		return false;
 	}
-	taskLock.unlock();
 
-	if (signal) {
+	if (key == 0) {
+		tasks.push_back(std::move(task));
+		guard.unlock();
 		taskSignal.notify_one();
+	} else {
+		workers[key % workers.size()]->tasks.push_back(std::move(task));
+		guard.unlock();
+		// the owning worker has to wake up, there is no way to signal only that one
+		taskSignal.notify_all();
 	}
+	return true;
 }
 
-void DatabaseTasks::runTask(const DatabaseTask& task)
+void DatabaseTasks::runTask(Database& db, const DatabaseTask& task)
 {
+	if (task.function) {
+		task.function(db);
+		return;
+	}
+
 	bool success;
 	DBResult_ptr result;
 	if (task.store) {
@@ -68,23 +120,76 @@ void DatabaseTasks::runTask(const DatabaseTask& task)
 	}
 }
 
+bool DatabaseTasks::isIdle() const
+{
+	if (!tasks.empty()) {
+		return false;
+	}
+
+	return std::all_of(workers.begin(), workers.end(),
+	                   [](const auto& worker) { return !worker->busy && worker->tasks.empty(); });
+}
+
 void DatabaseTasks::flush()
 {
 	std::unique_lock<std::mutex> guard{taskLock};
-	while (!tasks.empty()) {
-		auto task = std::move(tasks.front());
-		tasks.pop_front();
-		guard.unlock();
-		runTask(task);
-		guard.lock();
+	if (workers.empty()) {
+		return;
+	}
+
+	flushSignal.wait(guard, [this]() { return isIdle(); });
+}
+
+DatabaseTasksStats DatabaseTasks::getStats()
+{
+	DatabaseTasksStats stats;
+
+	const auto now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> guard{taskLock};
+	stats.queueSize = tasks.size();
+	stats.workers.reserve(workers.size());
+	for (const auto& worker : workers) {
+		DatabaseWorkerStats& workerStats = stats.workers.emplace_back();
+		workerStats.queueSize = worker->tasks.size();
+		workerStats.executed = worker->executed;
+		workerStats.busyMicros = worker->busyMicros;
+		workerStats.waitMicros = worker->waitMicros;
+
+		auto uptime = std::chrono::duration_cast<std::chrono::microseconds>(now - worker->startedAt).count();
+		if (uptime > 0) {
+			workerStats.utilization = static_cast<double>(worker->busyMicros) / uptime;
+		}
+	}
+	return stats;
+}
+
+void DatabaseTasks::stop()
+{
+	std::lock_guard<std::mutex> guard{taskLock};
+	if (threadState.load(std::memory_order_relaxed) == THREAD_STATE_RUNNING) {
+		threadState.store(THREAD_STATE_CLOSING, std::memory_order_relaxed);
 	}
 }
 
 void DatabaseTasks::shutdown()
 {
-	taskLock.lock();
-	setState(THREAD_STATE_TERMINATED);
-	taskLock.unlock();
+	// stop accepting tasks, then let the workers drain every lane before they exit
+	stop();
 	flush();
-	taskSignal.notify_one();
+
+	{
+		std::lock_guard<std::mutex> guard{taskLock};
+		threadState.store(THREAD_STATE_TERMINATED, std::memory_order_relaxed);
+	}
+	taskSignal.notify_all();
+}
+
+void DatabaseTasks::join()
+{
+	for (auto& worker : workers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
 }
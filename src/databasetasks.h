@@ -5,39 +5,106 @@
 #define FS_DATABASETASKS_H
 
 #include "database.h"
-#include "thread_holder_base.h"
+#include "enums.h"
 
 struct DatabaseTask
 {
 	DatabaseTask(std::string&& query, std::function<void(DBResult_ptr, bool)>&& callback, bool store) :
 	    query(std::move(query)), callback(std::move(callback)), store(store)
 	{}
+	explicit DatabaseTask(std::function<void(Database&)>&& function) : function(std::move(function)), store(false) {}
 
 	std::string query;
 	std::function<void(DBResult_ptr, bool)> callback;
+	std::function<void(Database&)> function; // runs instead of the query when set
+	std::chrono::steady_clock::time_point queuedAt = std::chrono::steady_clock::now();
 	bool store;
 };
 
-class DatabaseTasks : public ThreadHolder<DatabaseTasks>
+struct DatabaseWorkerStats
+{
+	size_t queueSize = 0;
+	uint64_t executed = 0;
+	uint64_t busyMicros = 0;
+	uint64_t waitMicros = 0; // time the executed tasks spent in the queues
+	double utilization = 0;  // busy time relative to the time since the worker started
+};
+
+struct DatabaseTasksStats
+{
+	size_t queueSize = 0; // tasks not bound to a key, runnable on any worker
+	std::vector<DatabaseWorkerStats> workers;
+};
+
+/**
+ * Runs queries asynchronously on a pool of workers, each owning its own
+ * database connection.
+ *
+ * Tasks added with the same non-zero key always run on the same worker, in
+ * the order they were added. Tasks without a key run on whichever worker is
+ * free first, so they must not depend on each other.
+ */
+class DatabaseTasks
 {
 public:
 	DatabaseTasks() = default;
-	void start();
+
+	// non-copyable
+	DatabaseTasks(const DatabaseTasks&) = delete;
+	DatabaseTasks& operator=(const DatabaseTasks&) = delete;
+
+	bool start();
+	void stop();
+	void join();
+
+	/**
+	 * Blocks until every queued task has been executed by the workers.
+	 */
 	void flush();
 	void shutdown();
 
-	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false);
+	void addTask(std::string query, std::function<void(DBResult_ptr, bool)> callback = nullptr, bool store = false,
+	             size_t key = 0);
 
-	void threadMain();
+	/**
+	 * Runs a function with the connection of a worker, e.g. to write several
+	 * statements in one transaction. The function runs on the worker thread.
+	 *
+	 * @return false if the workers are not accepting tasks
+	 */
+	bool addTask(std::function<void(Database&)> function, size_t key = 0);
+
+	/**
+	 * Ordering key for a named group of tasks, e.g. all writes to one table.
+	 */
+	static size_t getKey(std::string_view name) { return std::hash<std::string_view>{}(name) | 1; }
+
+	DatabaseTasksStats getStats();
 
 private:
-	void runTask(const DatabaseTask& task);
+	struct Worker
+	{
+		Database db;
+		std::thread thread;
+		std::deque<DatabaseTask> tasks;
+		std::chrono::steady_clock::time_point startedAt;
+		uint64_t executed = 0;
+		uint64_t busyMicros = 0;
+		uint64_t waitMicros = 0;
+		bool busy = false;
+	};
+
+	void threadMain(Worker& worker);
+	bool enqueue(DatabaseTask&& task, size_t key);
+	void runTask(Database& db, const DatabaseTask& task);
+	bool isIdle() const;
 
-	Database db;
-	std::thread thread;
-	std::list<DatabaseTask> tasks;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::deque<DatabaseTask> tasks;
 	std::mutex taskLock;
 	std::condition_variable taskSignal;
+	std::condition_variable flushSignal;
+	std::atomic<ThreadState> threadState{THREAD_STATE_TERMINATED};
 };
 
 extern DatabaseTasks g_databaseTasks;
@@ -587,6 +587,7 @@ struct MarketOfferEx
 	MarketOfferEx(MarketOfferEx&& other) :
 	    id(other.id),
 	    playerId(other.playerId),
+	    accountId(other.accountId),
 	    timestamp(other.timestamp),
 	    price(other.price),
 	    amount(other.amount),
@@ -598,6 +599,7 @@ struct MarketOfferEx
 
 	uint32_t id;
 	uint32_t playerId;
+	uint32_t accountId;
 	uint32_t timestamp;
 	uint64_t price;
 	uint16_t amount;
@@ -19,6 +19,7 @@
 #include "iologindata.h"
 #include "iomarket.h"
 #include "items.h"
+#include "logintasks.h"
 #include "monster.h"
 #include "movement.h"
 #include "npc.h"
@@ -28,6 +29,7 @@
 #include "scheduler.h"
 #include "script.h"
 #include "server.h"
+#include "serversave.h"
 #include "spectators.h"
 #include "spells.h"
 #include "storeinbox.h"
@@ -169,21 +171,18 @@ void Game::saveGameState()
 		std::cout << "[Error - Game::saveGameState] Failed to save account-level storage values." << std::endl;
 	}
 
-	for (const auto& it : players) {
-		it.second->loginPosition = it.second->getPosition();
-		IOLoginData::savePlayer(it.second);
-	}
-
-	Map::save();
-
-	g_databaseTasks.flush();
+	// players and houses are written in the background, the game goes on meanwhile; at the shutdown there is no game
+	// left to go on, so it waits for a previous save rather than trying again later
+	g_serverSave.start(gameState == GAME_STATE_SHUTDOWN);
 
 	if (gameState == GAME_STATE_MAINTAIN) {
 		setGameState(GAME_STATE_NORMAL);
 	}
 }
 
-bool Game::loadMainMap(const std::string& filename) { return map.loadMap("data/world/" + filename + ".otbm", true); }
+bool Game::loadMainMapTiles(const std::string& filename) { return map.loadTiles("data/world/" + filename + ".otbm"); }
+
+void Game::loadMainMapSpawnsAndHouses() { map.loadSpawnsAndHouses(true); }
 
 void Game::loadMap(const std::string& path) { map.loadMap(path, false); }
 
@@ -1463,6 +1462,70 @@ ReturnValue Game::internalPlayerAddItem(Player* player, Item* item, bool dropOnM
 	return ret;
 }
 
+void Game::sendToInbox(uint32_t guid, const ItemList& items)
+{
+	if (Player* player = getPlayerByGUID(guid)) {
+		player->loadDepots();
+		for (Item* item : items) {
+			internalMoveItem(item->getParent(), player->getInbox(), INDEX_WHEREEVER, item, item->getItemCount(), nullptr,
+			                 FLAG_NOLIMIT);
+		}
+		return;
+	}
+
+	if (g_loginTasks.beginOfflineWrite(guid)) {
+		OfflineDelivery delivery;
+		for (Item* item : items) {
+			if (internalRemoveItem(item, -1, true) == RETURNVALUE_NOERROR) {
+				delivery.addItem(item);
+				internalRemoveItem(item);
+			}
+		}
+		IOLoginData::queueOfflineDelivery(guid, std::move(delivery));
+		return;
+	}
+
+	// the player is logging in, the items are held until the login is done
+	ItemList pendingItems;
+	for (Item* item : items) {
+		item->incrementReferenceCounter();
+		if (internalRemoveItem(item) == RETURNVALUE_NOERROR) {
+			pendingItems.push_back(item);
+		} else {
+			item->decrementReferenceCounter();
+		}
+	}
+
+	if (!pendingItems.empty()) {
+		g_loginTasks.afterLoad(guid, [=]() { deliverToInbox(guid, pendingItems); });
+	}
+}
+
+void Game::deliverToInbox(uint32_t guid, const ItemList& items)
+{
+	// the items were removed from the map, each one still holds the reference taken by sendToInbox
+	if (Player* player = getPlayerByGUID(guid)) {
+		player->loadDepots();
+		for (Item* item : items) {
+			internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT);
+			item->decrementReferenceCounter();
+		}
+		return;
+	}
+
+	if (!g_loginTasks.beginOfflineWrite(guid)) {
+		g_loginTasks.afterLoad(guid, [=]() { deliverToInbox(guid, items); });
+		return;
+	}
+
+	OfflineDelivery delivery;
+	for (Item* item : items) {
+		delivery.addItem(item);
+		item->decrementReferenceCounter();
+	}
+	IOLoginData::queueOfflineDelivery(guid, std::move(delivery));
+}
+
 Item* Game::findItemOfType(Cylinder* cylinder, uint16_t itemId, bool depthSearch /*= true*/,
                            int32_t subType /*= -1*/) const
 {
@@ -2498,6 +2561,8 @@ void Game::playerWriteItem(uint32_t playerId, uint32_t windowTextId, const std::
 		writeItem->resetDate();
 	}
 
+	writeItem->setHouseItemsChanged();
+
 	uint16_t newId = Item::items[writeItem->getID()].writeOnceItemId;
 	if (newId != 0) {
 		transformItem(writeItem, newId);
@@ -4819,6 +4884,15 @@ void Game::internalDecayItem(Item* item)
 	}
 }
 
+size_t Game::getDecayingItems() const
+{
+	size_t count = std::distance(toDecayItems.begin(), toDecayItems.end());
+	for (const auto& bucket : decayItems) {
+		count += bucket.size();
+	}
+	return count;
+}
+
 void Game::checkDecay()
 {
 	g_scheduler.addEvent(createSchedulerTask(EVENT_DECAYINTERVAL, [this]() { checkDecay(); }));
@@ -4912,6 +4986,7 @@ void Game::shutdown()
 
 	g_scheduler.shutdown();
 	g_databaseTasks.shutdown();
+	g_loginTasks.shutdown();
 	g_dispatcher.shutdown();
 	map.spawns.clear();
 	raids.clear();
@@ -5285,9 +5360,13 @@ void Game::playerBrowseMarketOwnHistory(uint32_t playerId)
 		return;
 	}
 
-	const HistoryMarketOfferList& buyOffers = IOMarket::getOwnHistory(MARKETACTION_BUY, player->getGUID());
-	const HistoryMarketOfferList& sellOffers = IOMarket::getOwnHistory(MARKETACTION_SELL, player->getGUID());
-	player->sendMarketBrowseOwnHistory(buyOffers, sellOffers);
+	IOMarket::getOwnHistory(player->getGUID(),
+	                        [playerId](HistoryMarketOfferList&& buyOffers, HistoryMarketOfferList&& sellOffers) {
+		                        Player* player = g_game.getPlayerByID(playerId);
+		                        if (player && player->isInMarket()) {
+			                        player->sendMarketBrowseOwnHistory(buyOffers, sellOffers);
+		                        }
+	                        });
 }
 
 void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spriteId, uint16_t amount, uint64_t price,
@@ -5389,7 +5468,7 @@ void Game::playerCreateMarketOffer(uint32_t playerId, uint8_t type, uint16_t spr
 		player->bankBalance -= debitBank;
 	}
 
-	IOMarket::createOffer(player->getGUID(), static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
+	IOMarket::createOffer(*player, static_cast<MarketAction_t>(type), it.id, amount, price, anonymous);
 
 	player->sendMarketEnter();
 	const MarketOfferList& buyOffers = IOMarket::getActiveOffers(MARKETACTION_BUY, it.id);
@@ -5479,8 +5558,7 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 		return;
 	}
 
-	uint32_t offerAccountId = IOLoginData::getAccountIdByPlayerId(offer.playerId);
-	if (offerAccountId == player->getAccount()) {
+	if (offer.accountId == player->getAccount()) {
 		player->sendTextMessage(MESSAGE_MARKET, "You cannot accept your own offer.");
 		return;
 	}
@@ -5502,13 +5580,11 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			return;
 		}
 
+		// an offline buyer gets the items written straight into the inbox
 		Player* buyerPlayer = getPlayerByGUID(offer.playerId);
-		if (!buyerPlayer) {
-			buyerPlayer = new Player(nullptr);
-			if (!IOLoginData::loadPlayerById(buyerPlayer, offer.playerId)) {
-				delete buyerPlayer;
-				return;
-			}
+		if (!buyerPlayer && !g_loginTasks.beginOfflineWrite(offer.playerId)) {
+			player->sendTextMessage(MESSAGE_MARKET, "The offer cannot be accepted right now, please try again.");
+			return;
 		}
 
 		if (it.stackable) {
@@ -5530,48 +5606,38 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 
 		player->bankBalance += totalPrice;
 
-		if (it.stackable) {
-			uint16_t tmpAmount = amount;
-			while (tmpAmount > 0) {
-				uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
-				Item* item = Item::CreateItem(it.id, stackCount);
-				if (internalAddItem(buyerPlayer->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) !=
-				    RETURNVALUE_NOERROR) {
-					delete item;
-					break;
-				}
-
-				tmpAmount -= stackCount;
-			}
-		} else {
-			int32_t subType;
-			if (it.charges != 0) {
-				subType = it.charges;
-			} else {
-				subType = -1;
-			}
-
-			for (uint16_t i = 0; i < amount; ++i) {
-				Item* item = Item::CreateItem(it.id, subType);
+		if (buyerPlayer) {
+			buyerPlayer->loadDepots();
+			IOMarket::createOfferItems(it, amount, [this, buyerPlayer](Item* item) {
 				if (internalAddItem(buyerPlayer->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) !=
 				    RETURNVALUE_NOERROR) {
 					delete item;
-					break;
+					return false;
 				}
-			}
-		}
-
-		if (buyerPlayer->isOffline()) {
-			IOLoginData::savePlayer(buyerPlayer);
-			delete buyerPlayer;
-		} else {
+				return true;
+			});
 			buyerPlayer->onReceiveMail();
+		} else {
+			OfflineDelivery delivery;
+			IOMarket::createOfferItems(it, amount, [&delivery](Item* item) {
+				delivery.addItem(item);
+				delete item;
+				return true;
+			});
+			IOLoginData::queueOfflineDelivery(offer.playerId, std::move(delivery));
 		}
 	} else {
 		if (totalPrice > (player->getMoney() + player->bankBalance)) {
 			return;
 		}
 
+		// an offline seller gets the money written straight into the bank balance
+		Player* sellerPlayer = getPlayerByGUID(offer.playerId);
+		if (!sellerPlayer && !g_loginTasks.beginOfflineWrite(offer.playerId)) {
+			player->sendTextMessage(MESSAGE_MARKET, "The offer cannot be accepted right now, please try again.");
+			return;
+		}
+
 		const auto debitCash = std::min(player->getMoney(), totalPrice);
 		const auto debitBank = totalPrice - debitCash;
 		removeMoney(player, debitCash);
@@ -5606,11 +5672,12 @@ void Game::playerAcceptMarketOffer(uint32_t playerId, uint32_t timestamp, uint16
 			}
 		}
 
-		Player* sellerPlayer = getPlayerByGUID(offer.playerId);
 		if (sellerPlayer) {
 			sellerPlayer->bankBalance += totalPrice;
 		} else {
-			IOLoginData::increaseBankBalance(offer.playerId, totalPrice);
+			OfflineDelivery delivery;
+			delivery.balance = totalPrice;
+			IOLoginData::queueOfflineDelivery(offer.playerId, std::move(delivery));
 		}
 
 		player->onReceiveMail();
@@ -5921,8 +5988,10 @@ bool Game::reload(ReloadTypes_t reloadType)
 			return g_events->load();
 		case RELOAD_TYPE_GLOBALEVENTS:
 			return g_globalEvents->reload();
-		case RELOAD_TYPE_ITEMS:
+		case RELOAD_TYPE_ITEMS: {
+			auto loginGuard = g_loginTasks.pause();
 			return Item::items.reload();
+		}
 		case RELOAD_TYPE_MONSTERS:
 			return g_monsters.reload();
 		case RELOAD_TYPE_MOUNTS:
@@ -6001,7 +6070,10 @@ bool Game::reload(ReloadTypes_t reloadType)
 			Npcs::reload();
 			raids.reload() && raids.startup();
 			g_talkActions->reload();
-			Item::items.reload();
+			{
+				auto loginGuard = g_loginTasks.pause();
+				Item::items.reload();
+			}
 			g_weapons->reload();
 			g_weapons->clear(true);
 			g_weapons->loadDefaults();
@@ -82,7 +82,8 @@ public:
 	void forceAddCondition(uint32_t creatureId, Condition* condition);
 	void forceRemoveCondition(uint32_t creatureId, ConditionType_t type);
 
-	bool loadMainMap(const std::string& filename);
+	bool loadMainMapTiles(const std::string& filename);
+	void loadMainMapSpawnsAndHouses();
 	void loadMap(const std::string& path);
 
 	/**
@@ -209,6 +210,7 @@ public:
 	size_t getPlayersOnline() const { return players.size(); }
 	size_t getMonstersOnline() const { return monsters.size(); }
 	size_t getNpcsOnline() const { return npcs.size(); }
+	size_t getDecayingItems() const;
 	uint32_t getPlayersRecord() const { return playersRecord; }
 
 	LightInfo getWorldLightInfo() const { return {lightLevel, lightColor}; }
@@ -239,6 +241,13 @@ public:
 	ReturnValue internalPlayerAddItem(Player* player, Item* item, bool dropOnMap = true,
 	                                  slots_t slot = CONST_SLOT_WHEREEVER);
 
+	/**
+	 * Moves the items into the inbox of a player, online or not. The items of
+	 * an offline player are written straight into the database, those of a
+	 * player who is logging in are kept until the login is done.
+	 */
+	void sendToInbox(uint32_t guid, const ItemList& items);
+
 	/**
 	 * Find an item of a certain type
 	 * \param cylinder to search the item
@@ -527,6 +536,8 @@ private:
 	void checkDecay();
 	void internalDecayItem(Item* item);
 
+	void deliverToInbox(uint32_t guid, const ItemList& items);
+
 	std::unordered_map<uint32_t, Player*> players;
 	std::unordered_map<std::string, Player*> mappedPlayerNames;
 	std::unordered_map<uint32_t, Player*> mappedPlayerGuids;
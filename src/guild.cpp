@@ -56,9 +56,8 @@ void Guild::addRank(uint32_t rankId, const std::string& rankName, uint8_t level)
 	ranks.emplace_back(std::make_shared<GuildRank>(rankId, rankName, level));
 }
 
-Guild* IOGuild::loadGuild(uint32_t guildId)
+Guild* IOGuild::loadGuild(uint32_t guildId, Database& db /* = Database::getInstance()*/)
 {
-	Database& db = Database::getInstance();
 	if (DBResult_ptr result = db.storeQuery(fmt::format("SELECT `name` FROM `guilds` WHERE `id` = {:d}", guildId))) {
 		Guild* guild = new Guild(guildId, result->getString("name"));
 
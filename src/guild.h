@@ -4,6 +4,8 @@
 #ifndef FS_GUILD_H
 #define FS_GUILD_H
 
+#include "database.h"
+
 class Player;
 
 struct GuildRank
@@ -52,7 +54,7 @@ private:
 using GuildWarVector = std::vector<uint32_t>;
 
 namespace IOGuild {
-Guild* loadGuild(uint32_t guildId);
+Guild* loadGuild(uint32_t guildId, Database& db = Database::getInstance());
 uint32_t getGuildIdByName(const std::string& name);
 }; // namespace IOGuild
 
@@ -7,14 +7,20 @@
 
 #include "bed.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "housetile.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "logintasks.h"
 #include "pugicast.h"
+#include "scheduler.h"
 
 extern ConfigManager g_config;
+extern DatabaseTasks g_databaseTasks;
+extern Dispatcher g_dispatcher;
 extern Game g_game;
+extern LoginTasks g_loginTasks;
 
 House::House(uint32_t houseId) : id(houseId) {}
 
@@ -191,18 +197,7 @@ bool House::transferToDepot() const
 		return false;
 	}
 
-	Player* player = g_game.getPlayerByGUID(owner);
-	if (player) {
-		transferToDepot(player);
-	} else {
-		Player tmpPlayer(nullptr);
-		if (!IOLoginData::loadPlayerById(&tmpPlayer, owner)) {
-			return false;
-		}
-
-		transferToDepot(&tmpPlayer);
-		IOLoginData::savePlayer(&tmpPlayer);
-	}
+	g_game.sendToInbox(owner, getTransferableItems());
 	return true;
 }
 
@@ -212,6 +207,16 @@ bool House::transferToDepot(Player* player) const
 		return false;
 	}
 
+	player->loadDepots();
+	for (Item* item : getTransferableItems()) {
+		g_game.internalMoveItem(item->getParent(), player->getInbox(), INDEX_WHEREEVER, item, item->getItemCount(),
+		                        nullptr, FLAG_NOLIMIT);
+	}
+	return true;
+}
+
+ItemList House::getTransferableItems() const
+{
 	ItemList moveItemList;
 	for (HouseTile* tile : houseTiles) {
 		if (const TileItemVector* items = tile->getItemList()) {
@@ -229,12 +234,7 @@ bool House::transferToDepot(Player* player) const
 			}
 		}
 	}
-
-	for (Item* item : moveItemList) {
-		g_game.internalMoveItem(item->getParent(), player->getInbox(), INDEX_WHEREEVER, item, item->getItemCount(),
-		                        nullptr, FLAG_NOLIMIT);
-	}
-	return true;
+	return moveItemList;
 }
 
 bool House::getAccessList(uint32_t listId, std::string& list) const
@@ -610,13 +610,182 @@ bool Houses::loadHousesXML(const std::string& filename)
 	return true;
 }
 
+namespace {
+
+// time the dispatcher may spend collecting rent before the rest waits for the next tick
+constexpr auto RENT_TICK_BUDGET = std::chrono::milliseconds(10);
+
+struct RentCollection
+{
+	RentPeriod_t rentPeriod;
+	time_t currentTime;
+
+	// every owner with the houses they pay for, collected in this order
+	std::vector<std::pair<uint32_t, std::vector<uint32_t>>> owners;
+	size_t next = 0;
+};
+
+time_t getRentPaidUntil(RentPeriod_t rentPeriod, time_t currentTime)
+{
+	switch (rentPeriod) {
+		case RENTPERIOD_DAILY:
+			return currentTime + 24 * 60 * 60;
+		case RENTPERIOD_WEEKLY:
+			return currentTime + 24 * 60 * 60 * 7;
+		case RENTPERIOD_MONTHLY:
+			return currentTime + 24 * 60 * 60 * 30;
+		case RENTPERIOD_YEARLY:
+			return currentTime + 24 * 60 * 60 * 365;
+		default:
+			return currentTime;
+	}
+}
+
+Item* createRentWarning(const House* house, RentPeriod_t rentPeriod)
+{
+	std::string period;
+	switch (rentPeriod) {
+		case RENTPERIOD_DAILY:
+			period = "daily";
+			break;
+
+		case RENTPERIOD_WEEKLY:
+			period = "weekly";
+			break;
+
+		case RENTPERIOD_MONTHLY:
+			period = "monthly";
+			break;
+
+		case RENTPERIOD_YEARLY:
+			period = "annual";
+			break;
+
+		default:
+			break;
+	}
+
+	int32_t daysLeft = 7 - house->getPayRentWarnings();
+
+	Item* letter = Item::CreateItem(ITEM_LETTER_STAMPED);
+	letter->setText(fmt::format(
+	    "Warning! \nThe {:s} rent of {:d} gold for your house \"{:s}\" is payable. Have it within {:d} days or you will lose this house.",
+	    period, house->getRent(), house->getName(), daysLeft));
+	return letter;
+}
+
+// the balance of an offline owner is read by the caller, their delivery gets the rent and the warnings
+void payRent(const RentCollection& collection, House* house, Player* player, uint64_t* offlineBalance,
+             OfflineDelivery* delivery)
+{
+	const uint32_t rent = house->getRent();
+	const uint64_t balance = player ? player->getBankBalance() : *offlineBalance;
+	if (balance >= rent) {
+		if (player) {
+			player->setBankBalance(balance - rent);
+		} else {
+			*offlineBalance -= rent;
+			delivery->balance -= rent;
+		}
+
+		house->setPaidUntil(getRentPaidUntil(collection.rentPeriod, collection.currentTime));
+		house->setPayRentWarnings(0);
+	} else if (house->getPayRentWarnings() < 7) {
+		Item* letter = createRentWarning(house, collection.rentPeriod);
+		if (player) {
+			player->loadDepots();
+			g_game.internalAddItem(player->getInbox(), letter, INDEX_WHEREEVER, FLAG_NOLIMIT);
+		} else {
+			delivery->addItem(letter);
+			delete letter;
+		}
+		house->setPayRentWarnings(house->getPayRentWarnings() + 1);
+	} else {
+		house->setOwner(0, true, player);
+	}
+}
+
+void collectOfflineRent(const std::shared_ptr<RentCollection>& collection, uint32_t ownerId,
+                        const std::vector<uint32_t>& houseIds)
+{
+	// the owner can not log in until the delivery is queued, so the balance read here stays valid
+	auto task = [=](Database& db) {
+		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `balance` FROM `players` WHERE `id` = {:d}", ownerId));
+		const bool exists = result != nullptr;
+		const uint64_t balance = exists ? result->getNumber<uint64_t>("balance") : 0;
+
+		g_dispatcher.addTask([=]() {
+			uint64_t offlineBalance = balance;
+			OfflineDelivery delivery;
+			for (uint32_t houseId : houseIds) {
+				House* house = g_game.map.houses.getHouse(houseId);
+				if (!house || house->getOwner() != ownerId) {
+					continue;
+				}
+
+				if (!exists) {
+					// Player doesn't exist, reset house owner
+					house->setOwner(0);
+					continue;
+				}
+
+				payRent(*collection, house, nullptr, &offlineBalance, &delivery);
+			}
+			IOLoginData::queueOfflineDelivery(ownerId, std::move(delivery));
+		});
+	};
+
+	if (!g_databaseTasks.addTask(task, ownerId)) {
+		task(Database::getInstance());
+	}
+}
+
+void collectRent(const std::shared_ptr<RentCollection>& collection)
+{
+	const auto deadline = std::chrono::steady_clock::now() + RENT_TICK_BUDGET;
+
+	while (collection->next < collection->owners.size() && std::chrono::steady_clock::now() < deadline) {
+		const auto& owner = collection->owners[collection->next++];
+		const uint32_t ownerId = owner.first;
+
+		Player* player = g_game.getPlayerByGUID(ownerId);
+		if (!player) {
+			// held only around the read and the write of this owner
+			if (!g_loginTasks.beginOfflineWrite(ownerId)) {
+				// logging in right now, the rent is collected the next time
+				continue;
+			}
+
+			collectOfflineRent(collection, ownerId, owner.second);
+			continue;
+		}
+
+		for (uint32_t houseId : owner.second) {
+			House* house = g_game.map.houses.getHouse(houseId);
+			if (house && house->getOwner() == ownerId) {
+				payRent(*collection, house, player, nullptr, nullptr);
+			}
+		}
+	}
+
+	if (collection->next < collection->owners.size()) {
+		g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [collection]() { collectRent(collection); }));
+	}
+}
+
+} // namespace
+
 void Houses::payHouses(RentPeriod_t rentPeriod) const
 {
 	if (rentPeriod == RENTPERIOD_NEVER) {
 		return;
 	}
 
-	time_t currentTime = time(nullptr);
+	auto collection = std::make_shared<RentCollection>();
+	collection->rentPeriod = rentPeriod;
+	collection->currentTime = time(nullptr);
+
+	std::unordered_map<uint32_t, size_t> ownerIndexes;
 	for (const auto& it : houseMap) {
 		House* house = it.second;
 		if (house->getOwner() == 0) {
@@ -624,7 +793,7 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 		}
 
 		const uint32_t rent = house->getRent();
-		if (rent == 0 || house->getPaidUntil() > currentTime) {
+		if (rent == 0 || house->getPaidUntil() > collection->currentTime) {
 			continue;
 		}
 
@@ -634,74 +803,14 @@ void Houses::payHouses(RentPeriod_t rentPeriod) const
 			continue;
 		}
 
-		Player player(nullptr);
-		if (!IOLoginData::loadPlayerById(&player, ownerId)) {
-			// Player doesn't exist, reset house owner
-			house->setOwner(0);
-			continue;
-		}
-
-		if (player.getBankBalance() >= rent) {
-			player.setBankBalance(player.getBankBalance() - rent);
-
-			time_t paidUntil = currentTime;
-			switch (rentPeriod) {
-				case RENTPERIOD_DAILY:
-					paidUntil += 24 * 60 * 60;
-					break;
-				case RENTPERIOD_WEEKLY:
-					paidUntil += 24 * 60 * 60 * 7;
-					break;
-				case RENTPERIOD_MONTHLY:
-					paidUntil += 24 * 60 * 60 * 30;
-					break;
-				case RENTPERIOD_YEARLY:
-					paidUntil += 24 * 60 * 60 * 365;
-					break;
-				default:
-					break;
-			}
-
-			house->setPaidUntil(paidUntil);
-			house->setPayRentWarnings(0);
-		} else {
-			if (house->getPayRentWarnings() < 7) {
-				int32_t daysLeft = 7 - house->getPayRentWarnings();
-
-				Item* letter = Item::CreateItem(ITEM_LETTER_STAMPED);
-				std::string period;
-
-				switch (rentPeriod) {
-					case RENTPERIOD_DAILY:
-						period = "daily";
-						break;
-
-					case RENTPERIOD_WEEKLY:
-						period = "weekly";
-						break;
-
-					case RENTPERIOD_MONTHLY:
-						period = "monthly";
-						break;
-
-					case RENTPERIOD_YEARLY:
-						period = "annual";
-						break;
-
-					default:
-						break;
-				}
-
-				letter->setText(fmt::format(
-				    "Warning! \nThe {:s} rent of {:d} gold for your house \"{:s}\" is payable. Have it within {:d} days or you will lose this house.",
-				    period, house->getRent(), house->getName(), daysLeft));
-				g_game.internalAddItem(player.getInbox(), letter, INDEX_WHEREEVER, FLAG_NOLIMIT);
-				house->setPayRentWarnings(house->getPayRentWarnings() + 1);
-			} else {
-				house->setOwner(0, true, &player);
-			}
+		auto ownerIt = ownerIndexes.emplace(ownerId, collection->owners.size()).first;
+		if (ownerIt->second == collection->owners.size()) {
+			collection->owners.emplace_back(ownerId, std::vector<uint32_t>());
 		}
+		collection->owners[ownerIt->second].second.push_back(house->getId());
+	}
 
-		IOLoginData::savePlayer(&player);
+	if (!collection->owners.empty()) {
+		collectRent(collection);
 	}
 }
@@ -144,6 +144,10 @@ public:
 
 	uint32_t getId() const { return id; }
 
+	// set whenever an item on one of the house tiles, or inside a container on them, changes
+	void setItemsChanged(bool changed = true) { itemsChanged = changed; }
+	bool hasItemsChanged() const { return itemsChanged; }
+
 	void addDoor(Door* door);
 	void removeDoor(Door* door);
 	Door* getDoorByNumber(uint32_t doorId) const;
@@ -168,6 +172,7 @@ public:
 private:
 	bool transferToDepot() const;
 	bool transferToDepot(Player* player) const;
+	ItemList getTransferableItems() const;
 
 	AccessList guestList;
 	AccessList subOwnerList;
@@ -195,6 +200,7 @@ private:
 	Position posEntry = {};
 
 	bool isLoaded = false;
+	bool itemsChanged = false;
 };
 
 using HouseMap = std::map<uint32_t, House*>;
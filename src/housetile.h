@@ -25,7 +25,7 @@ public:
 	void addThing(int32_t index, Thing* thing) override;
 	void internalAddThing(uint32_t index, Thing* thing) override;
 
-	House* getHouse() const { return house; }
+	House* getHouse() const override { return house; }
 
 private:
 	void updateHouse(Item* item);
@@ -7,19 +7,26 @@
 
 #include "condition.h"
 #include "configmanager.h"
+#include "databasetasks.h"
 #include "depotchest.h"
 #include "game.h"
 #include "inbox.h"
+#include "logintasks.h"
+#include "serversave.h"
 #include "storeinbox.h"
+#include "tasks.h"
 
 extern ConfigManager g_config;
+extern DatabaseTasks g_databaseTasks;
+extern Dispatcher g_dispatcher;
 extern Game g_game;
+extern LoginTasks g_loginTasks;
 
-Account IOLoginData::loadAccount(uint32_t accno)
+Account IOLoginData::loadAccount(uint32_t accno, Database& db /* = Database::getInstance()*/)
 {
 	Account account;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
+	DBResult_ptr result = db.storeQuery(fmt::format(
 	    "SELECT `id`, `name`, `password`, `type`, `premium_ends_at` FROM `accounts` WHERE `id` = {:d}", accno));
 	if (!result) {
 		return account;
@@ -190,10 +197,8 @@ void IOLoginData::updateOnlineStatus(uint32_t guid, bool login)
 	}
 }
 
-bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
+bool IOLoginData::preloadPlayer(Player* player, const std::string& name, Database& db /* = Database::getInstance()*/)
 {
-	Database& db = Database::getInstance();
-
 	DBResult_ptr result = db.storeQuery(fmt::format(
 	    "SELECT `p`.`id`, `p`.`account_id`, `p`.`group_id`, `a`.`type`, `a`.`premium_ends_at` FROM `players` as `p` JOIN `accounts` as `a` ON `a`.`id` = `p`.`account_id` WHERE `p`.`name` = {:s} AND `p`.`deletion` = 0",
 	    db.escapeString(name)));
@@ -217,12 +222,23 @@ bool IOLoginData::preloadPlayer(Player* player, const std::string& name)
 
 bool IOLoginData::loadPlayerById(Player* player, uint32_t id)
 {
-	Database& db = Database::getInstance();
+	PendingPlayerData pending;
+	if (!loadDetachedPlayerById(Database::getInstance(), player, id, pending)) {
+		return false;
+	}
+
+	finishLoadPlayer(player, pending);
+	return true;
+}
+
+bool IOLoginData::loadDetachedPlayerById(Database& db, Player* player, uint32_t id, PendingPlayerData& pending)
+{
 	return loadPlayer(
-	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = {:d}",
-	        id)));
+	    db, player,
+	    db.prepare(
+	          "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `id` = ?")
+	        .query({id}),
+	    pending);
 }
 
 bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
@@ -230,14 +246,23 @@ bool IOLoginData::loadPlayerByName(Player* player, const std::string& name)
 	Database& db = Database::getInstance();
 	return loadPlayer(
 	    player,
-	    db.storeQuery(fmt::format(
-	        "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = {:s}",
-	        db.escapeString(name))));
+	    db.prepare(
+	          "SELECT `id`, `name`, `account_id`, `group_id`, `sex`, `vocation`, `experience`, `level`, `maglevel`, `health`, `healthmax`, `blessings`, `mana`, `manamax`, `manaspent`, `soul`, `lookbody`, `lookfeet`, `lookhead`, `looklegs`, `looktype`, `lookaddons`, `lookmount`, `lookmounthead`, `lookmountbody`, `lookmountlegs`, `lookmountfeet`, `randomizemount`, `posx`, `posy`, `posz`, `cap`, `lastlogin`, `lastlogout`, `lastip`, `conditions`, `skulltime`, `skull`, `town_id`, `balance`, `offlinetraining_time`, `offlinetraining_skill`, `stamina`, `skill_fist`, `skill_fist_tries`, `skill_club`, `skill_club_tries`, `skill_sword`, `skill_sword_tries`, `skill_axe`, `skill_axe_tries`, `skill_dist`, `skill_dist_tries`, `skill_shielding`, `skill_shielding_tries`, `skill_fishing`, `skill_fishing_tries`, `direction` FROM `players` WHERE `name` = ?")
+	        .query({name}));
 }
 
-static GuildWarVector getWarList(uint32_t guildId)
+static uint64_t hashItemRow(int32_t pid, uint16_t type, uint16_t count, const char* attributes, size_t attributesSize)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
+	uint64_t hash = std::hash<std::string_view>{}({attributes, attributesSize});
+	for (uint64_t value : {static_cast<uint64_t>(pid), static_cast<uint64_t>(type), static_cast<uint64_t>(count)}) {
+		hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+	}
+	return hash;
+}
+
+static GuildWarVector getWarList(Database& db, uint32_t guildId)
+{
+	DBResult_ptr result = db.storeQuery(fmt::format(
 	    "SELECT `guild1`, `guild2` FROM `guild_wars` WHERE (`guild1` = {:d} OR `guild2` = {:d}) AND `ended` = 0 AND `status` = 1",
 	    guildId, guildId));
 	if (!result) {
@@ -256,16 +281,28 @@ static GuildWarVector getWarList(uint32_t guildId)
 	return guildWarVector;
 }
 
-bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
+bool IOLoginData::loadPlayer(Player* player, DBStatementResult_ptr result)
+{
+	PendingPlayerData pending;
+	if (!loadPlayer(Database::getInstance(), player, std::move(result), pending)) {
+		return false;
+	}
+
+	finishLoadPlayer(player, pending);
+	return true;
+}
+
+bool IOLoginData::loadPlayer(Database& db, Player* player, DBStatementResult_ptr result, PendingPlayerData& pending)
 {
 	if (!result) {
 		return false;
 	}
 
-	Database& db = Database::getInstance();
+	// called on the login loader threads, finishLoadPlayer registers the unique ids on the dispatcher
+	DeferUniqueIds deferUniqueIds(pending.uniqueItems);
 
 	uint32_t accno = result->getNumber<uint32_t>("account_id");
-	Account acc = loadAccount(accno);
+	Account acc = loadAccount(accno, db);
 
 	player->setGUID(result->getNumber<uint32_t>("id"));
 	player->name = result->getString("name");
@@ -420,54 +457,27 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		player->skills[i].percent = Player::getPercentLevel(skillTries, nextSkillTries);
 	}
 
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = {:d}",
-	                     player->getGUID())))) {
-		uint32_t guildId = result->getNumber<uint32_t>("guild_id");
-		uint32_t playerRankId = result->getNumber<uint32_t>("rank_id");
+	if ((result = db.prepare("SELECT `guild_id`, `rank_id`, `nick` FROM `guild_membership` WHERE `player_id` = ?")
+	                  .query({player->getGUID()}))) {
+		pending.guildId = result->getNumber<uint32_t>("guild_id");
+		pending.guildRankId = result->getNumber<uint32_t>("rank_id");
 		player->guildNick = result->getString("nick");
 
-		Guild* guild = g_game.getGuild(guildId);
-		if (!guild) {
-			guild = IOGuild::loadGuild(guildId);
-			if (guild) {
-				g_game.addGuild(guild);
-			} else {
-				std::cout << "[Warning - IOLoginData::loadPlayer] " << player->name << " has Guild ID " << guildId
-				          << " which doesn't exist" << std::endl;
-			}
-		}
-
-		if (guild) {
-			player->guild = guild;
-			GuildRank_ptr rank = guild->getRankById(playerRankId);
-			if (!rank) {
-				if ((result = db.storeQuery(fmt::format(
-				         "SELECT `id`, `name`, `level` FROM `guild_ranks` WHERE `id` = {:d}", playerRankId)))) {
-					guild->addRank(result->getNumber<uint32_t>("id"), result->getString("name"),
-					               result->getNumber<uint16_t>("level"));
-				}
-
-				rank = guild->getRankById(playerRankId);
-				if (!rank) {
-					player->guild = nullptr;
-				}
-			}
+		// the guild may not be cached yet, it is resolved against the game's guilds in finishLoadPlayer
+		pending.guild.reset(IOGuild::loadGuild(pending.guildId, db));
+		pending.guildWarVector = getWarList(db, pending.guildId);
 
-			player->guildRank = rank;
-			player->guildWarVector = getWarList(guildId);
-
-			if ((result = db.storeQuery(fmt::format(
-			         "SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = {:d}", guildId)))) {
-				guild->setMemberCount(result->getNumber<uint32_t>("members"));
-			}
+		if ((result = db.prepare("SELECT COUNT(*) AS `members` FROM `guild_membership` WHERE `guild_id` = ?")
+		                  .query({pending.guildId}))) {
+			pending.guildMemberCount = result->getNumber<uint32_t>("members");
 		}
 	}
 
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = {:d}",
-	                                        player->getGUID())))) {
+	if ((result = db.prepare("SELECT `player_id`, `name` FROM `player_spells` WHERE `player_id` = ?")
+	                  .query({player->getGUID()}))) {
 		do {
-			player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			const std::string& spellName = player->learnedInstantSpellList.emplace_front(result->getString("name"));
+			player->saveState.spells.insert(spellName);
 		} while (result->next());
 	}
 
@@ -475,10 +485,11 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	ItemMap itemMap;
 	std::map<uint8_t, Container*> openContainersList;
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
-		loadItems(itemMap, result);
+	if ((result = db.prepare(
+	                    "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_items` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	                  .query({player->getGUID()}))) {
+		loadItems(itemMap, result, player->saveState.items[PLAYER_ITEM_TABLE_INVENTORY],
+		          player->saveState.itemSids[PLAYER_ITEM_TABLE_INVENTORY]);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
 			const std::pair<Item*, int32_t>& pair = it->second;
@@ -509,80 +520,24 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 		}
 	}
 
-	for (auto& it : openContainersList) {
-		player->addContainer(it.first - 1, it.second);
-		player->onSendContainer(it.second);
-	}
-
-	// load depot items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_depotitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-
-			int32_t pid = pair.second;
-			if (pid >= 0 && pid < 100) {
-				DepotChest* depotChest = player->getDepotChest(pid, true);
-				if (depotChest) {
-					depotChest->internalAddThing(item);
-				}
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
-	}
-
-	// load inbox items
-	itemMap.clear();
-
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_inboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
-		loadItems(itemMap, result);
-
-		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
-			const std::pair<Item*, int32_t>& pair = it->second;
-			Item* item = pair.first;
-			int32_t pid = pair.second;
-
-			if (pid >= 0 && pid < 100) {
-				player->getInbox()->internalAddThing(item);
-			} else {
-				ItemMap::const_iterator it2 = itemMap.find(pid);
+	pending.openContainers = std::move(openContainersList);
 
-				if (it2 == itemMap.end()) {
-					continue;
-				}
-
-				Container* container = it2->second.first->getContainer();
-				if (container) {
-					container->internalAddThing(item);
-				}
-			}
-		}
+	if (pending.deferDepots) {
+		player->depotsState = DEPOTS_UNLOADED;
+	} else {
+		PlayerDepotItems depotItems;
+		loadDepotItems(db, player->getGUID(), depotItems);
+		finishLoadDepots(player, depotItems);
 	}
 
 	// load store inbox items
 	itemMap.clear();
 
-	if ((result = db.storeQuery(fmt::format(
-	         "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = {:d} ORDER BY `sid` DESC",
-	         player->getGUID())))) {
-		loadItems(itemMap, result);
+	if ((result = db.prepare(
+	                    "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `player_storeinboxitems` WHERE `player_id` = ? ORDER BY `sid` DESC")
+	                  .query({player->getGUID()}))) {
+		loadItems(itemMap, result, player->saveState.items[PLAYER_ITEM_TABLE_STORE_INBOX],
+		          player->saveState.itemSids[PLAYER_ITEM_TABLE_STORE_INBOX]);
 
 		for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
 			const std::pair<Item*, int32_t>& pair = it->second;
@@ -607,141 +562,425 @@ bool IOLoginData::loadPlayer(Player* player, DBResult_ptr result)
 	}
 
 	// load storage map
-	if ((result = db.storeQuery(
-	         fmt::format("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID())))) {
+	if ((result = db.prepare("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?")
+	                  .query({player->getGUID()}))) {
 		do {
-			player->addStorageValue(result->getNumber<uint32_t>("key"), result->getNumber<int32_t>("value"), true);
+			uint32_t key = result->getNumber<uint32_t>("key");
+			int32_t value = result->getNumber<int32_t>("value");
+			player->addStorageValue(key, value, true);
+			player->saveState.storage[key] = value;
 		} while (result->next());
 	}
 
 	// load vip list
-	if ((result = db.storeQuery(fmt::format("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = {:d}",
-	                                        player->getAccount())))) {
+	if ((result = db.prepare("SELECT `player_id` FROM `account_viplist` WHERE `account_id` = ?")
+	                  .query({player->getAccount()}))) {
 		do {
 			player->addVIPInternal(result->getNumber<uint32_t>("player_id"));
 		} while (result->next());
 	}
 
+	for (const auto& rows : player->saveState.items) {
+		pending.loadedItems += rows.size();
+	}
+
+	player->saveState.valid = true;
+
 	player->updateBaseSpeed();
 	player->updateInventoryWeight();
 	player->updateItemsLight(true);
 	return true;
 }
 
-bool IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
-                            PropWriteStream& propWriteStream)
+void IOLoginData::finishLoadPlayer(Player* player, PendingPlayerData& pending)
 {
-	using ContainerBlock = std::pair<Container*, int32_t>;
-	std::vector<ContainerBlock> containers;
-	containers.reserve(32);
+	Item::registerUniqueIds(pending.uniqueItems);
+	pending.uniqueItems.clear();
+
+	if (pending.guildId != 0) {
+		Guild* guild = g_game.getGuild(pending.guildId);
+		if (!guild && pending.guild) {
+			guild = pending.guild.release();
+			g_game.addGuild(guild);
+		}
 
-	int32_t runningId = 100;
-	const auto& openContainers = player->getOpenContainers();
+		if (guild) {
+			player->guild = guild;
+			GuildRank_ptr rank = guild->getRankById(pending.guildRankId);
+			if (!rank && pending.guild) {
+				if (GuildRank_ptr loadedRank = pending.guild->getRankById(pending.guildRankId)) {
+					guild->addRank(loadedRank->id, loadedRank->name, loadedRank->level);
+				}
 
-	Database& db = Database::getInstance();
-	for (const auto& it : itemList) {
-		int32_t pid = it.first;
-		Item* item = it.second;
-		++runningId;
+				rank = guild->getRankById(pending.guildRankId);
+			}
 
-		if (Container* container = item->getContainer()) {
-			if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-				container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
+			if (!rank) {
+				player->guild = nullptr;
 			}
 
-			if (!openContainers.empty()) {
-				for (const auto& its : openContainers) {
-					auto openContainer = its.second;
-					auto opcontainer = openContainer.container;
+			player->guildRank = rank;
+			player->guildWarVector = std::move(pending.guildWarVector);
+			guild->setMemberCount(pending.guildMemberCount);
+		} else {
+			std::cout << "[Warning - IOLoginData::loadPlayer] " << player->name << " has Guild ID " << pending.guildId
+			          << " which doesn't exist" << std::endl;
+		}
+	}
 
-					if (opcontainer == container) {
-						container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(its.first) + 1);
-						break;
-					}
-				}
+	for (auto& it : pending.openContainers) {
+		player->addContainer(it.first - 1, it.second);
+		player->onSendContainer(it.second);
+	}
+}
+
+// Rows are numbered from here down on a full renumbering, so that new items can take the sids below the existing rows.
+static constexpr int32_t ITEM_SID_BASE = 1 << 20;
+
+void IOLoginData::saveItems(const Player* player, const ItemBlockList& itemList, size_t table,
+                            PlayerSnapshot& snapshot, PropWriteStream& propWriteStream)
+{
+	struct SaveItem
+	{
+		Item* item;
+		int32_t pid;   // for the items not inside a container
+		size_t parent; // position of the container, SIZE_MAX for the items not inside one
+	};
+
+	// items sharing a parent follow each other front to back, as they are loaded in the order of their sids
+	std::vector<SaveItem> items;
+	items.reserve(itemList.size() * 4);
+	for (const auto& it : itemList) {
+		items.push_back({it.second, it.first, SIZE_MAX});
+	}
+
+	const auto& openContainers = player->getOpenContainers();
+	for (size_t i = 0; i < items.size(); ++i) {
+		Container* container = items[i].item->getContainer();
+		if (!container) {
+			continue;
+		}
+
+		if (container->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
+			container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
+		}
+
+		for (const auto& it : openContainers) {
+			if (it.second.container == container) {
+				container->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, static_cast<int64_t>(it.first) + 1);
+				break;
 			}
+		}
+
+		for (Item* item : container->getItemList()) {
+			items.push_back({item, 0, i});
+		}
+	}
 
-			containers.emplace_back(container, runningId);
+	// An item keeps the row it was loaded from or last saved to, so adding or removing an item only writes that
+	// item. Walking each group of siblings from the back, an item keeps its row while the sids still decrease and
+	// takes a new sid below every row otherwise, which is what an item put in front of its container needs.
+	const std::map<int32_t, uint64_t>& savedRows = snapshot.saved.items[table];
+	const PlayerItemSids& savedSids = snapshot.saved.itemSids[table];
+
+	std::vector<int32_t> sids(items.size());
+	std::unordered_set<int32_t> keptSids;
+	int32_t nextSid = savedRows.empty() ? ITEM_SID_BASE : savedRows.begin()->first;
+	int32_t upperSid = std::numeric_limits<int32_t>::max();
+	bool renumber = false;
+	for (size_t i = items.size(); i-- > 0;) {
+		if (i + 1 == items.size() || items[i].parent != items[i + 1].parent || items[i].pid != items[i + 1].pid) {
+			upperSid = std::numeric_limits<int32_t>::max();
 		}
 
+		auto it = savedSids.find(items[i].item);
+		if (it != savedSids.end() && it->second < upperSid && savedRows.find(it->second) != savedRows.end() &&
+		    keptSids.insert(it->second).second) {
+			sids[i] = it->second;
+		} else if (nextSid > 101) {
+			sids[i] = --nextSid;
+		} else {
+			// no sids left below the rows, e.g. rows written before the sids were kept
+			renumber = true;
+			break;
+		}
+		upperSid = sids[i];
+	}
+
+	if (renumber) {
+		nextSid = std::max<int32_t>(ITEM_SID_BASE, items.size() + 101);
+		for (size_t i = items.size(); i-- > 0;) {
+			sids[i] = --nextSid;
+		}
+	}
+
+	std::vector<PlayerItemRow>& rows = snapshot.itemRows[table];
+	PlayerItemSids& itemSids = snapshot.state.itemSids[table];
+	rows.reserve(items.size());
+	itemSids.reserve(items.size());
+	for (size_t i = 0; i < items.size(); ++i) {
+		const SaveItem& saveItem = items[i];
+		const int32_t pid = saveItem.parent == SIZE_MAX ? saveItem.pid : sids[saveItem.parent];
+
 		propWriteStream.clear();
-		item->serializeAttr(propWriteStream);
+		saveItem.item->serializeAttr(propWriteStream);
 
 		size_t attributesSize;
 		const char* attributes = propWriteStream.getStream(attributesSize);
 
-		if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), pid, runningId,
-		                                     item->getID(), item->getSubType(),
-		                                     db.escapeBlob(attributes, attributesSize)))) {
+		const uint16_t type = saveItem.item->getID();
+		const uint16_t count = saveItem.item->getSubType();
+		rows.push_back({pid, sids[i], type, count, std::string(attributes, attributesSize),
+		                hashItemRow(pid, type, count, attributes, attributesSize)});
+		itemSids.emplace(saveItem.item, sids[i]);
+	}
+}
+
+static constexpr std::array<std::string_view, PLAYER_ITEM_TABLE_LAST + 1> playerItemTables = {
+    "player_items", "player_depotitems", "player_inboxitems", "player_storeinboxitems"};
+
+static bool rewritePlayerRows(Database& db, uint32_t guid, const PlayerItemRows& itemRows,
+                              const PlayerItemTables& skippedTables, const PlayerSaveState& state)
+{
+	// learned spells
+	if (!db.prepare("DELETE FROM `player_spells` WHERE `player_id` = ?").execute({guid})) {
+		return false;
+	}
+
+	DBStatementInsert spellsQuery(db, "INSERT INTO `player_spells` (`player_id`, `name`) VALUES ", 2);
+	for (const std::string& spellName : state.spells) {
+		if (!spellsQuery.addRow({guid, spellName})) {
 			return false;
 		}
 	}
 
-	for (size_t i = 0; i < containers.size(); i++) {
-		const ContainerBlock& cb = containers[i];
-		Container* container = cb.first;
-		int32_t parentId = cb.second;
+	if (!spellsQuery.execute()) {
+		return false;
+	}
 
-		for (Item* item : container->getItemList()) {
-			++runningId;
+	// items
+	for (size_t table = 0; table < itemRows.size(); ++table) {
+		if (skippedTables.test(table)) {
+			continue;
+		}
 
-			Container* subContainer = item->getContainer();
-			if (subContainer) {
-				containers.emplace_back(subContainer, runningId);
+		if (!db.prepare(fmt::format("DELETE FROM `{:s}` WHERE `player_id` = ?", playerItemTables[table]))
+		         .execute({guid})) {
+			return false;
+		}
 
-				if (subContainer->getIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER)) {
-					subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, 0);
-				}
+		DBStatementInsert itemsQuery(
+		    db,
+		    fmt::format(
+		        "INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ",
+		        playerItemTables[table]),
+		    6);
+		for (const PlayerItemRow& row : itemRows[table]) {
+			if (!itemsQuery.addRow({guid, row.pid, row.sid, row.type, row.count,
+			                        DBParam::blob(row.attributes.data(), row.attributes.size())})) {
+				return false;
+			}
+		}
 
-				if (!openContainers.empty()) {
-					for (const auto& it : openContainers) {
-						auto openContainer = it.second;
-						auto opcontainer = openContainer.container;
+		if (!itemsQuery.execute()) {
+			return false;
+		}
+	}
 
-						if (opcontainer == subContainer) {
-							subContainer->setIntAttr(ITEM_ATTRIBUTE_OPENCONTAINER, it.first + 1);
-							break;
-						}
-					}
-				}
+	// storage
+	if (!db.prepare("DELETE FROM `player_storage` WHERE `player_id` = ?").execute({guid})) {
+		return false;
+	}
+
+	DBStatementInsert storageQuery(db, "INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", 3);
+	for (const auto& it : state.storage) {
+		if (!storageQuery.addRow({guid, it.first, it.second})) {
+			return false;
+		}
+	}
+	return storageQuery.execute();
+}
+
+static bool savePlayerRowChanges(Database& db, uint32_t guid, const PlayerItemRows& itemRows,
+                                 const PlayerItemTables& skippedTables, const PlayerSaveState& saved,
+                                 const PlayerSaveState& state)
+{
+	// learned spells, there are only a few of them so they are not batched
+	for (const std::string& spellName : saved.spells) {
+		if (state.spells.find(spellName) == state.spells.end() &&
+		    !db.prepare("DELETE FROM `player_spells` WHERE `player_id` = ? AND `name` = ?").execute({guid, spellName})) {
+			return false;
+		}
+	}
+
+	DBStatementInsert spellsQuery(db, "INSERT INTO `player_spells` (`player_id`, `name`) VALUES ", 2);
+	for (const std::string& spellName : state.spells) {
+		if (saved.spells.find(spellName) == saved.spells.end() && !spellsQuery.addRow({guid, spellName})) {
+			return false;
+		}
+	}
+
+	if (!spellsQuery.execute()) {
+		return false;
+	}
+
+	// items, rows are identified by their sid, which an item keeps from save to save
+	for (size_t table = 0; table < itemRows.size(); ++table) {
+		if (skippedTables.test(table)) {
+			continue;
+		}
+
+		const auto& savedRows = saved.items[table];
+		const auto& rows = state.items[table];
+
+		DBStatementInsert deleteQuery(
+		    db, fmt::format("DELETE FROM `{:s}` WHERE (`player_id`, `sid`) IN (", playerItemTables[table]), 2, ")");
+		for (const auto& it : savedRows) {
+			if (rows.find(it.first) == rows.end() && !deleteQuery.addRow({guid, it.first})) {
+				return false;
 			}
+		}
 
-			propWriteStream.clear();
-			item->serializeAttr(propWriteStream);
+		if (!deleteQuery.execute()) {
+			return false;
+		}
 
-			size_t attributesSize;
-			const char* attributes = propWriteStream.getStream(attributesSize);
+		DBStatementInsert upsertQuery(
+		    db,
+		    fmt::format(
+		        "INSERT INTO `{:s}` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ",
+		        playerItemTables[table]),
+		    6,
+		    " ON DUPLICATE KEY UPDATE `pid` = VALUES(`pid`), `itemtype` = VALUES(`itemtype`), `count` = VALUES(`count`), `attributes` = VALUES(`attributes`)");
+		for (const PlayerItemRow& row : itemRows[table]) {
+			auto it = savedRows.find(row.sid);
+			if (it != savedRows.end() && it->second == row.hash) {
+				continue;
+			}
 
-			if (!query_insert.addRow(fmt::format("{:d}, {:d}, {:d}, {:d}, {:d}, {:s}", player->getGUID(), parentId,
-			                                     runningId, item->getID(), item->getSubType(),
-			                                     db.escapeBlob(attributes, attributesSize)))) {
+			if (!upsertQuery.addRow({guid, row.pid, row.sid, row.type, row.count,
+			                         DBParam::blob(row.attributes.data(), row.attributes.size())})) {
 				return false;
 			}
 		}
+
+		if (!upsertQuery.execute()) {
+			return false;
+		}
+	}
+
+	// storage
+	DBStatementInsert deleteQuery(db, "DELETE FROM `player_storage` WHERE (`player_id`, `key`) IN (", 2, ")");
+	for (const auto& it : saved.storage) {
+		if (state.storage.find(it.first) == state.storage.end() && !deleteQuery.addRow({guid, it.first})) {
+			return false;
+		}
+	}
+
+	if (!deleteQuery.execute()) {
+		return false;
+	}
+
+	DBStatementInsert upsertQuery(db, "INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ", 3,
+	                              " ON DUPLICATE KEY UPDATE `value` = VALUES(`value`)");
+	for (const auto& it : state.storage) {
+		auto savedIt = saved.storage.find(it.first);
+		if ((savedIt == saved.storage.end() || savedIt->second != it.second) &&
+		    !upsertQuery.addRow({guid, it.first, it.second})) {
+			return false;
+		}
 	}
-	return query_insert.execute();
+	return upsertQuery.execute();
 }
 
-bool IOLoginData::savePlayer(Player* player)
+// Reads back the rows of a player and compares them with the state that was just saved.
+static bool checkPlayerRows(Database& db, uint32_t guid, const PlayerItemTables& skippedTables,
+                            const PlayerSaveState& state)
 {
-	if (player->isDead()) {
-		player->changeHealth(1);
+	for (size_t table = 0; table < state.items.size(); ++table) {
+		if (skippedTables.test(table)) {
+			continue;
+		}
+
+		const std::string query = fmt::format(
+		    "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `{:s}` WHERE `player_id` = ?",
+		    playerItemTables[table]);
+
+		std::map<int32_t, uint64_t> rows;
+		if (DBStatementResult_ptr result = db.prepare(query).query({guid})) {
+			do {
+				unsigned long attributesSize;
+				const char* attributes = result->getStream("attributes", attributesSize);
+				rows[result->getNumber<int32_t>("sid")] =
+				    hashItemRow(result->getNumber<int32_t>("pid"), result->getNumber<uint16_t>("itemtype"),
+				                result->getNumber<uint16_t>("count"), attributes, attributesSize);
+			} while (result->next());
+		}
+
+		if (rows != state.items[table]) {
+			return false;
+		}
 	}
 
-	Database& db = Database::getInstance();
+	std::map<uint32_t, int32_t> storage;
+	if (DBStatementResult_ptr result =
+	        db.prepare("SELECT `key`, `value` FROM `player_storage` WHERE `player_id` = ?").query({guid})) {
+		do {
+			storage[result->getNumber<uint32_t>("key")] = result->getNumber<int32_t>("value");
+		} while (result->next());
+	}
 
-	DBResult_ptr result =
-	    db.storeQuery(fmt::format("SELECT `save` FROM `players` WHERE `id` = {:d}", player->getGUID()));
-	if (!result) {
+	if (storage != state.storage) {
 		return false;
 	}
 
-	if (result->getNumber<uint16_t>("save") == 0) {
-		return db.executeQuery(
-		    fmt::format("UPDATE `players` SET `lastlogin` = {:d}, `lastip` = INET6_ATON('{:s}') WHERE `id` = {:d}",
-		                player->lastLoginSaved, player->lastIP.to_string(), player->getGUID()));
+	std::multiset<std::string> spells;
+	if (DBStatementResult_ptr result =
+	        db.prepare("SELECT `name` FROM `player_spells` WHERE `player_id` = ?").query({guid})) {
+		do {
+			spells.insert(result->getString("name"));
+		} while (result->next());
+	}
+	return spells.size() == state.spells.size() && std::equal(spells.begin(), spells.end(), state.spells.begin());
+}
+
+bool IOLoginData::savePlayer(Player* player)
+{
+	// a snapshot of the player taken by a running server save must not be written after this one
+	g_serverSave.cancelPlayer(player->getGUID());
+
+	PlayerSnapshot snapshot = snapshotPlayer(player);
+	if (!saveSnapshot(Database::getInstance(), snapshot)) {
+		return false;
 	}
 
+	player->saveState = std::move(snapshot.state);
+	return true;
+}
+
+PlayerSnapshot IOLoginData::snapshotPlayer(Player* player)
+{
+	if (player->isDead()) {
+		player->changeHealth(1);
+	}
+
+	// items that arrived in the inbox before it was loaded have no rows yet, they can only be written along with it,
+	// until the load queued here is done both tables are left as they are
+	if (player->depotsState != DEPOTS_LOADED && !player->getInbox()->empty()) {
+		player->loadDepots();
+	}
+
+	PlayerSnapshot snapshot;
+	snapshot.guid = player->getGUID();
+	snapshot.revision = ++player->saveRevision;
+	snapshot.name = player->name;
+	snapshot.lastLoginSaved = player->lastLoginSaved;
+	snapshot.lastIP = player->lastIP.to_string();
+
+	// the rows are compared against the state of the last save, until this snapshot is written there is none
+	snapshot.saved = std::move(player->saveState);
+	player->saveState = {};
+
 	// serialize conditions
 	PropWriteStream propWriteStream;
 	for (Condition* condition : player->conditions) {
@@ -754,51 +993,44 @@ bool IOLoginData::savePlayer(Player* player)
 	size_t conditionsSize;
 	const char* conditions = propWriteStream.getStream(conditionsSize);
 
-	// First, an UPDATE query to write the player itself
-	std::ostringstream query;
-	query << "UPDATE `players` SET ";
-	query << "`level` = " << player->level << ',';
-	query << "`group_id` = " << player->group->id << ',';
-	query << "`vocation` = " << player->getVocationId() << ',';
-	query << "`health` = " << player->health << ',';
-	query << "`healthmax` = " << player->healthMax << ',';
-	query << "`experience` = " << player->experience << ',';
-	query << "`lookbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookBody) << ',';
-	query << "`lookfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookFeet) << ',';
-	query << "`lookhead` = " << static_cast<uint32_t>(player->defaultOutfit.lookHead) << ',';
-	query << "`looklegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookLegs) << ',';
-	query << "`looktype` = " << player->defaultOutfit.lookType << ',';
-	query << "`lookaddons` = " << static_cast<uint32_t>(player->defaultOutfit.lookAddons) << ',';
-	query << "`lookmount` = " << player->defaultOutfit.lookMount << ',';
-	query << "`lookmounthead` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountHead) << ',';
-	query << "`lookmountbody` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountBody) << ',';
-	query << "`lookmountlegs` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountLegs) << ',';
-	query << "`lookmountfeet` = " << static_cast<uint32_t>(player->defaultOutfit.lookMountFeet) << ',';
-	query << "`randomizemount` = " << player->randomizeMount << ",";
-	query << "`maglevel` = " << player->magLevel << ',';
-	query << "`mana` = " << player->mana << ',';
-	query << "`manamax` = " << player->manaMax << ',';
-	query << "`manaspent` = " << player->manaSpent << ',';
-	query << "`soul` = " << static_cast<uint16_t>(player->soul) << ',';
-	query << "`town_id` = " << player->town->getID() << ',';
-
+	// First, an UPDATE query to write the player itself. Values that are only written under some conditions fall
+	// back to the stored column in SQL, so the statement text only differs by world type.
 	const Position& loginPosition = player->getLoginPosition();
-	query << "`posx` = " << loginPosition.getX() << ',';
-	query << "`posy` = " << loginPosition.getY() << ',';
-	query << "`posz` = " << loginPosition.getZ() << ',';
-
-	query << "`cap` = " << (player->capacity / 100) << ',';
-	query << "`sex` = " << static_cast<uint16_t>(player->sex) << ',';
-
-	if (player->lastLoginSaved != 0) {
-		query << "`lastlogin` = " << player->lastLoginSaved << ',';
-	}
-
-	if (!player->lastIP.is_unspecified()) {
-		query << "`lastip` = INET6_ATON('" << player->lastIP.to_string() << "'),";
-	}
-
-	query << "`conditions` = " << db.escapeBlob(conditions, conditionsSize) << ',';
+	snapshot.query =
+	    "UPDATE `players` SET `level` = ?, `group_id` = ?, `vocation` = ?, `health` = ?, `healthmax` = ?, `experience` = ?, `lookbody` = ?, `lookfeet` = ?, `lookhead` = ?, `looklegs` = ?, `looktype` = ?, `lookaddons` = ?, `lookmount` = ?, `lookmounthead` = ?, `lookmountbody` = ?, `lookmountlegs` = ?, `lookmountfeet` = ?, `randomizemount` = ?, `maglevel` = ?, `mana` = ?, `manamax` = ?, `manaspent` = ?, `soul` = ?, `town_id` = ?, `posx` = ?, `posy` = ?, `posz` = ?, `cap` = ?, `sex` = ?, `lastlogin` = COALESCE(NULLIF(?, 0), `lastlogin`), `lastip` = COALESCE(INET6_ATON(?), `lastip`), `conditions` = ?, ";
+	DBParams& params = snapshot.params;
+	params = {player->level,
+	                player->group->id,
+	                player->getVocationId(),
+	                player->health,
+	                player->healthMax,
+	                player->experience,
+	                player->defaultOutfit.lookBody,
+	                player->defaultOutfit.lookFeet,
+	                player->defaultOutfit.lookHead,
+	                player->defaultOutfit.lookLegs,
+	                player->defaultOutfit.lookType,
+	                player->defaultOutfit.lookAddons,
+	                player->defaultOutfit.lookMount,
+	                player->defaultOutfit.lookMountHead,
+	                player->defaultOutfit.lookMountBody,
+	                player->defaultOutfit.lookMountLegs,
+	                player->defaultOutfit.lookMountFeet,
+	                player->randomizeMount,
+	                player->magLevel,
+	                player->mana,
+	                player->manaMax,
+	                player->manaSpent,
+	                player->soul,
+	                player->town->getID(),
+	                loginPosition.getX(),
+	                loginPosition.getY(),
+	                loginPosition.getZ(),
+	                player->capacity / 100,
+	                static_cast<uint16_t>(player->sex),
+	                player->lastLoginSaved,
+	                player->lastIP.is_unspecified() ? std::string() : player->lastIP.to_string(),
+	                DBParam::blob(conditions, conditionsSize)};
 
 	if (g_game.getWorldType() != WORLD_TYPE_PVP_ENFORCED) {
 		int64_t skullTime = 0;
@@ -806,7 +1038,6 @@ bool IOLoginData::savePlayer(Player* player)
 		if (player->skullTicks > 0) {
 			skullTime = time(nullptr) + player->skullTicks;
 		}
-		query << "`skulltime` = " << skullTime << ',';
 
 		Skulls_t skull = SKULL_NONE;
 		if (player->skull == SKULL_RED) {
@@ -814,70 +1045,39 @@ bool IOLoginData::savePlayer(Player* player)
 		} else if (player->skull == SKULL_BLACK) {
 			skull = SKULL_BLACK;
 		}
-		query << "`skull` = " << static_cast<int64_t>(skull) << ',';
-	}
-
-	query << "`lastlogout` = " << player->getLastLogout() << ',';
-	query << "`balance` = " << player->bankBalance << ',';
-	query << "`offlinetraining_time` = " << player->getOfflineTrainingTime() / 1000 << ',';
-	query << "`offlinetraining_skill` = " << player->getOfflineTrainingSkill() << ',';
-	query << "`stamina` = " << player->getStaminaMinutes() << ',';
-
-	query << "`skill_fist` = " << player->skills[SKILL_FIST].level << ',';
-	query << "`skill_fist_tries` = " << player->skills[SKILL_FIST].tries << ',';
-	query << "`skill_club` = " << player->skills[SKILL_CLUB].level << ',';
-	query << "`skill_club_tries` = " << player->skills[SKILL_CLUB].tries << ',';
-	query << "`skill_sword` = " << player->skills[SKILL_SWORD].level << ',';
-	query << "`skill_sword_tries` = " << player->skills[SKILL_SWORD].tries << ',';
-	query << "`skill_axe` = " << player->skills[SKILL_AXE].level << ',';
-	query << "`skill_axe_tries` = " << player->skills[SKILL_AXE].tries << ',';
-	query << "`skill_dist` = " << player->skills[SKILL_DISTANCE].level << ',';
-	query << "`skill_dist_tries` = " << player->skills[SKILL_DISTANCE].tries << ',';
-	query << "`skill_shielding` = " << player->skills[SKILL_SHIELD].level << ',';
-	query << "`skill_shielding_tries` = " << player->skills[SKILL_SHIELD].tries << ',';
-	query << "`skill_fishing` = " << player->skills[SKILL_FISHING].level << ',';
-	query << "`skill_fishing_tries` = " << player->skills[SKILL_FISHING].tries << ',';
-	query << "`direction` = " << static_cast<uint16_t>(player->getDirection()) << ',';
-
-	if (!player->isOffline()) {
-		query << "`onlinetime` = `onlinetime` + " << (time(nullptr) - player->lastLoginSaved) << ',';
-	}
-	query << "`blessings` = " << player->blessings.to_ulong();
-	query << " WHERE `id` = " << player->getGUID();
-
-	DBTransaction transaction;
-	if (!transaction.begin()) {
-		return false;
-	}
-
-	if (!db.executeQuery(query.str())) {
-		return false;
-	}
-
-	// learned spells
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_spells` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert spellsQuery("INSERT INTO `player_spells` (`player_id`, `name`) VALUES ");
-	for (const std::string& spellName : player->learnedInstantSpellList) {
-		if (!spellsQuery.addRow(fmt::format("{:d}, {:s}", player->getGUID(), db.escapeString(spellName)))) {
-			return false;
-		}
-	}
-
-	if (!spellsQuery.execute()) {
-		return false;
-	}
-
-	// item saving
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_items` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
-
-	DBInsert itemsQuery(
-	    "INSERT INTO `player_items` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
 
+		snapshot.query.append("`skulltime` = ?, `skull` = ?, ");
+		params.emplace_back(skullTime);
+		params.emplace_back(static_cast<int64_t>(skull));
+	}
+
+	snapshot.query.append(
+	    "`lastlogout` = ?, `balance` = ?, `offlinetraining_time` = ?, `offlinetraining_skill` = ?, `stamina` = ?, `skill_fist` = ?, `skill_fist_tries` = ?, `skill_club` = ?, `skill_club_tries` = ?, `skill_sword` = ?, `skill_sword_tries` = ?, `skill_axe` = ?, `skill_axe_tries` = ?, `skill_dist` = ?, `skill_dist_tries` = ?, `skill_shielding` = ?, `skill_shielding_tries` = ?, `skill_fishing` = ?, `skill_fishing_tries` = ?, `direction` = ?, `onlinetime` = `onlinetime` + ?, `blessings` = ? WHERE `id` = ?");
+	params.insert(params.end(), {player->getLastLogout(),
+	                             player->bankBalance,
+	                             player->getOfflineTrainingTime() / 1000,
+	                             player->getOfflineTrainingSkill(),
+	                             player->getStaminaMinutes(),
+	                             player->skills[SKILL_FIST].level,
+	                             player->skills[SKILL_FIST].tries,
+	                             player->skills[SKILL_CLUB].level,
+	                             player->skills[SKILL_CLUB].tries,
+	                             player->skills[SKILL_SWORD].level,
+	                             player->skills[SKILL_SWORD].tries,
+	                             player->skills[SKILL_AXE].level,
+	                             player->skills[SKILL_AXE].tries,
+	                             player->skills[SKILL_DISTANCE].level,
+	                             player->skills[SKILL_DISTANCE].tries,
+	                             player->skills[SKILL_SHIELD].level,
+	                             player->skills[SKILL_SHIELD].tries,
+	                             player->skills[SKILL_FISHING].level,
+	                             player->skills[SKILL_FISHING].tries,
+	                             static_cast<uint16_t>(player->getDirection()),
+	                             player->isOffline() ? 0 : time(nullptr) - player->lastLoginSaved,
+	                             player->blessings.to_ulong(),
+	                             player->getGUID()});
+
+	PlayerItemRows& itemRows = snapshot.itemRows;
 	ItemBlockList itemList;
 	for (int32_t slotId = CONST_SLOT_FIRST; slotId <= CONST_SLOT_LAST; ++slotId) {
 		Item* item = player->inventory[slotId];
@@ -886,78 +1086,94 @@ bool IOLoginData::savePlayer(Player* player)
 		}
 	}
 
-	if (!saveItems(player, itemList, itemsQuery, propWriteStream)) {
-		return false;
-	}
+	saveItems(player, itemList, PLAYER_ITEM_TABLE_INVENTORY, snapshot, propWriteStream);
 
-	// save depot items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_depotitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
-	}
+	if (player->depotsState == DEPOTS_LOADED) {
+		itemList.clear();
+		for (const auto& it : player->depotChests) {
+			for (Item* item : it.second->getItemList()) {
+				itemList.emplace_back(it.first, item);
+			}
+		}
 
-	DBInsert depotQuery(
-	    "INSERT INTO `player_depotitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
+		saveItems(player, itemList, PLAYER_ITEM_TABLE_DEPOT, snapshot, propWriteStream);
 
-	for (const auto& it : player->depotChests) {
-		for (Item* item : it.second->getItemList()) {
-			itemList.emplace_back(it.first, item);
+		itemList.clear();
+		for (Item* item : player->getInbox()->getItemList()) {
+			itemList.emplace_back(0, item);
 		}
-	}
 
-	if (!saveItems(player, itemList, depotQuery, propWriteStream)) {
-		return false;
-	}
-
-	// save inbox items
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_inboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
-		return false;
+		saveItems(player, itemList, PLAYER_ITEM_TABLE_INBOX, snapshot, propWriteStream);
+	} else {
+		snapshot.skippedTables.set(PLAYER_ITEM_TABLE_DEPOT).set(PLAYER_ITEM_TABLE_INBOX);
 	}
 
-	DBInsert inboxQuery(
-	    "INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
 	itemList.clear();
-
-	for (Item* item : player->getInbox()->getItemList()) {
+	for (Item* item : player->getStoreInbox()->getItemList()) {
 		itemList.emplace_back(0, item);
 	}
 
-	if (!saveItems(player, itemList, inboxQuery, propWriteStream)) {
-		return false;
+	saveItems(player, itemList, PLAYER_ITEM_TABLE_STORE_INBOX, snapshot, propWriteStream);
+
+	player->genReservedStorageRange();
+
+	PlayerSaveState& state = snapshot.state;
+	for (size_t table = 0; table < itemRows.size(); ++table) {
+		for (const PlayerItemRow& row : itemRows[table]) {
+			state.items[table].emplace(row.sid, row.hash);
+		}
+	}
+	for (size_t table = 0; table < itemRows.size(); ++table) {
+		if (snapshot.skippedTables.test(table)) {
+			state.items[table] = snapshot.saved.items[table];
+			state.itemSids[table] = snapshot.saved.itemSids[table];
+		}
 	}
+	state.storage = player->storageMap;
+	state.spells.insert(player->learnedInstantSpellList.begin(), player->learnedInstantSpellList.end());
+	state.valid = true;
+	return snapshot;
+}
 
-	// save store inbox items
-	if (!db.executeQuery(
-	        fmt::format("DELETE FROM `player_storeinboxitems` WHERE `player_id` = {:d}", player->getGUID()))) {
+bool IOLoginData::saveSnapshot(Database& db, PlayerSnapshot& snapshot)
+{
+	DBStatementResult_ptr result = db.prepare("SELECT `save` FROM `players` WHERE `id` = ?").query({snapshot.guid});
+	if (!result) {
 		return false;
 	}
 
-	DBInsert storeInboxQuery(
-	    "INSERT INTO `player_storeinboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ");
-	itemList.clear();
-
-	for (Item* item : player->getStoreInbox()->getItemList()) {
-		itemList.emplace_back(0, item);
+	if (result->getNumber<uint16_t>("save") == 0) {
+		// the rows are left as they are, and so is the state they match
+		snapshot.state = std::move(snapshot.saved);
+		return db.prepare("UPDATE `players` SET `lastlogin` = ?, `lastip` = INET6_ATON(?) WHERE `id` = ?")
+		    .execute({snapshot.lastLoginSaved, snapshot.lastIP, snapshot.guid});
 	}
 
-	if (!saveItems(player, itemList, storeInboxQuery, propWriteStream)) {
+	DBTransaction transaction(db);
+	if (!transaction.begin()) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `player_storage` WHERE `player_id` = {:d}", player->getGUID()))) {
+	if (!db.prepare(snapshot.query).execute(snapshot.params)) {
 		return false;
 	}
 
-	DBInsert storageQuery("INSERT INTO `player_storage` (`player_id`, `key`, `value`) VALUES ");
-	player->genReservedStorageRange();
-
-	for (const auto& it : player->storageMap) {
-		if (!storageQuery.addRow(fmt::format("{:d}, {:d}, {:d}", player->getGUID(), it.first, it.second))) {
+	bool rewrite = !snapshot.saved.valid || !g_config.getBoolean(ConfigManager::INCREMENTAL_PLAYER_SAVE);
+	if (!rewrite) {
+		if (!savePlayerRowChanges(db, snapshot.guid, snapshot.itemRows, snapshot.skippedTables, snapshot.saved,
+		                          snapshot.state)) {
 			return false;
 		}
+
+		if (g_config.getBoolean(ConfigManager::CHECK_PLAYER_SAVE_CONSISTENCY) &&
+		    !checkPlayerRows(db, snapshot.guid, snapshot.skippedTables, snapshot.state)) {
+			std::cout << "[Warning - IOLoginData::saveSnapshot] Saved rows of " << snapshot.name
+			          << " do not match the database, rewriting them." << std::endl;
+			rewrite = true;
+		}
 	}
 
-	if (!storageQuery.execute()) {
+	if (rewrite && !rewritePlayerRows(db, snapshot.guid, snapshot.itemRows, snapshot.skippedTables, snapshot.state)) {
 		return false;
 	}
 
@@ -1026,7 +1242,8 @@ bool IOLoginData::formatPlayerName(std::string& name)
 	return true;
 }
 
-void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
+void IOLoginData::loadItems(ItemMap& itemMap, DBStatementResult_ptr result, std::map<int32_t, uint64_t>& savedRows,
+                            PlayerItemSids& itemSids)
 {
 	do {
 		uint32_t sid = result->getNumber<uint32_t>("sid");
@@ -1037,6 +1254,9 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 		unsigned long attrSize;
 		const char* attr = result->getStream("attributes", attrSize);
 
+		// rows that fail to load are still in the database, the next save removes them
+		savedRows[sid] = hashItemRow(pid, type, count, attr, attrSize);
+
 		PropStream propStream;
 		propStream.init(attr, attrSize);
 
@@ -1048,16 +1268,226 @@ void IOLoginData::loadItems(ItemMap& itemMap, DBResult_ptr result)
 
 			std::pair<Item*, uint32_t> pair(item, pid);
 			itemMap[sid] = pair;
+			itemSids[item] = sid;
 		}
 	} while (result->next());
 }
 
+void IOLoginData::loadItemTree(Database& db, std::string_view table, uint32_t guid, ItemBlockList& topItems,
+                               std::map<int32_t, uint64_t>& savedRows, PlayerItemSids& itemSids)
+{
+	DBStatementResult_ptr result =
+	    db.prepare(fmt::format(
+	                   "SELECT `pid`, `sid`, `itemtype`, `count`, `attributes` FROM `{:s}` WHERE `player_id` = ? ORDER BY `sid` DESC",
+	                   table))
+	        .query({guid});
+	if (!result) {
+		return;
+	}
+
+	ItemMap itemMap;
+	loadItems(itemMap, result, savedRows, itemSids);
+
+	for (ItemMap::const_reverse_iterator it = itemMap.rbegin(), end = itemMap.rend(); it != end; ++it) {
+		const std::pair<Item*, int32_t>& pair = it->second;
+		Item* item = pair.first;
+		int32_t pid = pair.second;
+
+		if (pid >= 0 && pid < 100) {
+			topItems.emplace_back(pid, item);
+		} else {
+			ItemMap::const_iterator it2 = itemMap.find(pid);
+			if (it2 == itemMap.end()) {
+				continue;
+			}
+
+			Container* container = it2->second.first->getContainer();
+			if (container) {
+				container->internalAddThing(item);
+			}
+		}
+	}
+}
+
+PlayerDepotItems::~PlayerDepotItems()
+{
+	for (const auto& it : depotItems) {
+		delete it.second;
+	}
+
+	for (const auto& it : inboxItems) {
+		delete it.second;
+	}
+}
+
+void IOLoginData::loadDepotItems(Database& db, uint32_t guid, PlayerDepotItems& items)
+{
+	loadItemTree(db, "player_depotitems", guid, items.depotItems, items.depotRows, items.depotSids);
+	loadItemTree(db, "player_inboxitems", guid, items.inboxItems, items.inboxRows, items.inboxSids);
+}
+
+void IOLoginData::finishLoadDepots(Player* player, PlayerDepotItems& items)
+{
+	for (const auto& it : items.depotItems) {
+		if (DepotChest* depotChest = player->getDepotChest(it.first, true)) {
+			depotChest->internalAddThing(it.second);
+		} else {
+			delete it.second;
+		}
+	}
+	items.depotItems.clear();
+
+	for (const auto& it : items.inboxItems) {
+		player->getInbox()->internalAddThing(it.second);
+	}
+	items.inboxItems.clear();
+
+	player->saveState.items[PLAYER_ITEM_TABLE_DEPOT] = std::move(items.depotRows);
+	player->saveState.items[PLAYER_ITEM_TABLE_INBOX] = std::move(items.inboxRows);
+	player->saveState.itemSids[PLAYER_ITEM_TABLE_DEPOT] = std::move(items.depotSids);
+	player->saveState.itemSids[PLAYER_ITEM_TABLE_INBOX] = std::move(items.inboxSids);
+
+	// a snapshot still being written left these tables out, the state it would put back must not replace this one
+	++player->saveRevision;
+	player->depotsState = DEPOTS_LOADED;
+
+	for (const auto& callback : std::exchange(player->depotsCallbacks, {})) {
+		callback(player);
+	}
+}
+
+void IOLoginData::queueLoadDepots(uint32_t guid, uint32_t playerId)
+{
+	// the lane of the player keeps this after its queued saves, and those leave the depot tables alone
+	auto task = [guid, playerId](Database& db) {
+		auto items = std::make_shared<PlayerDepotItems>();
+		{
+			DeferUniqueIds deferUniqueIds(items->uniqueItems);
+			loadDepotItems(db, guid, *items);
+		}
+
+		g_dispatcher.addTask([playerId, items]() {
+			// the player may have logged out, or needed them sooner and loaded them meanwhile
+			Player* player = g_game.getPlayerByID(playerId);
+			if (!player || player->depotsState != DEPOTS_LOADING) {
+				return;
+			}
+
+			Item::registerUniqueIds(items->uniqueItems);
+
+			const size_t itemCount = items->depotRows.size() + items->inboxRows.size();
+			const int64_t requestedAt = player->depotsRequestedAt;
+			finishLoadDepots(player, *items);
+			g_loginTasks.addDepotLoad(OTSYS_TIME() - requestedAt, itemCount);
+		});
+	};
+
+	if (!g_databaseTasks.addTask(task, guid)) {
+		task(Database::getInstance());
+	}
+}
+
+void IOLoginData::loadDepots(Player* player)
+{
+	if (player->depotsState == DEPOTS_LOADED) {
+		return;
+	}
+
+	const int64_t requestedAt = player->depotsState == DEPOTS_LOADING ? player->depotsRequestedAt : OTSYS_TIME();
+
+	PlayerDepotItems items;
+	loadDepotItems(Database::getInstance(), player->getGUID(), items);
+
+	const size_t itemCount = items.depotRows.size() + items.inboxRows.size();
+	finishLoadDepots(player, items);
+	g_loginTasks.addDepotLoad(OTSYS_TIME() - requestedAt, itemCount);
+}
+
 void IOLoginData::increaseBankBalance(uint32_t guid, uint64_t bankBalance)
 {
 	Database::getInstance().executeQuery(
 	    fmt::format("UPDATE `players` SET `balance` = `balance` + {:d} WHERE `id` = {:d}", bankBalance, guid));
 }
 
+void OfflineDelivery::addItem(const Item* item, uint32_t parent /* = 0*/)
+{
+	PropWriteStream propWriteStream;
+	item->serializeAttr(propWriteStream);
+
+	size_t attributesSize;
+	const char* attributes = propWriteStream.getStream(attributesSize);
+	items.push_back({parent, item->getID(), item->getSubType(), std::string(attributes, attributesSize)});
+
+	if (const Container* container = item->getContainer()) {
+		const uint32_t index = items.size();
+		for (const Item* containerItem : container->getItemList()) {
+			addItem(containerItem, index);
+		}
+	}
+}
+
+void IOLoginData::queueOfflineDelivery(uint32_t guid, OfflineDelivery&& delivery)
+{
+	if (delivery.empty()) {
+		g_loginTasks.endOfflineWrite(guid);
+		return;
+	}
+
+	auto task = [guid, delivery = std::move(delivery)](Database& db) {
+		if (!saveOfflineDelivery(db, guid, delivery)) {
+			std::cout << "[Error - IOLoginData::queueOfflineDelivery] Failed to deliver " << delivery.items.size()
+			          << " items and " << delivery.balance << " gold to player " << guid << '.' << std::endl;
+		}
+		g_loginTasks.endOfflineWrite(guid);
+	};
+
+	if (!g_databaseTasks.addTask(task, guid)) {
+		task(Database::getInstance());
+	}
+}
+
+bool IOLoginData::saveOfflineDelivery(Database& db, uint32_t guid, const OfflineDelivery& delivery)
+{
+	DBTransaction transaction(db);
+	if (!transaction.begin()) {
+		return false;
+	}
+
+	if (delivery.balance != 0 &&
+	    !db.prepare("UPDATE `players` SET `balance` = `balance` + ? WHERE `id` = ?").execute({delivery.balance, guid})) {
+		return false;
+	}
+
+	if (!delivery.items.empty()) {
+		// new rows go after every row the player saved, directly into the inbox
+		int32_t sid = 100;
+		if (DBStatementResult_ptr result =
+		        db.prepare("SELECT MAX(`sid`) AS `sid` FROM `player_inboxitems` WHERE `player_id` = ? FOR UPDATE")
+		            .query({guid})) {
+			sid = std::max(sid, result->getNumber<int32_t>("sid"));
+		}
+
+		DBStatementInsert stmt(
+		    db, "INSERT INTO `player_inboxitems` (`player_id`, `pid`, `sid`, `itemtype`, `count`, `attributes`) VALUES ",
+		    6);
+		// sids of the new rows follow the order of the items, so a container is found by its position
+		const int32_t firstSid = sid + 1;
+		for (const OfflineInboxItem& item : delivery.items) {
+			const int32_t pid = item.parent == 0 ? 0 : firstSid + static_cast<int32_t>(item.parent) - 1;
+			if (!stmt.addRow({guid, pid, ++sid, item.type, item.count,
+			                  DBParam::blob(item.attributes.data(), item.attributes.size())})) {
+				return false;
+			}
+		}
+
+		if (!stmt.execute()) {
+			return false;
+		}
+	}
+
+	return transaction.commit();
+}
+
 bool IOLoginData::hasBiddedOnHouse(uint32_t guid)
 {
 	Database& db = Database::getInstance();
@@ -6,18 +6,108 @@
 
 #include "account.h"
 #include "database.h"
+#include "guild.h"
+#include "player.h"
 
+class Container;
 class Item;
-class Player;
 class PropWriteStream;
 struct VIPEntry;
 
 using ItemBlockList = std::list<std::pair<int32_t, Item*>>;
 
+// Parts of a player loaded off the dispatcher thread that touch shared game state and therefore can only be applied
+// once the player is handed back to it.
+struct PendingPlayerData
+{
+	bool deferDepots = false; // set by the caller to leave the depot chests and the inbox to Player::loadDepots
+	size_t loadedItems = 0;
+
+	std::map<uint8_t, Container*> openContainers;
+	std::vector<Item*> uniqueItems; // registered by finishLoadPlayer, see DeferUniqueIds
+
+	uint32_t guildId = 0;
+	uint32_t guildRankId = 0;
+	uint32_t guildMemberCount = 0;
+	std::unique_ptr<Guild> guild;
+	GuildWarVector guildWarVector;
+};
+
+// Depot chests and inbox of a player who logged in without them, read on the database lane of the player.
+struct PlayerDepotItems
+{
+	PlayerDepotItems() = default;
+	~PlayerDepotItems();
+
+	// non-copyable
+	PlayerDepotItems(const PlayerDepotItems&) = delete;
+	PlayerDepotItems& operator=(const PlayerDepotItems&) = delete;
+
+	ItemBlockList depotItems; // depot id and the items directly inside the depot chest, owned until handed over
+	ItemBlockList inboxItems;
+	std::map<int32_t, uint64_t> depotRows; // sid -> row hash, as in PlayerSaveState
+	std::map<int32_t, uint64_t> inboxRows;
+	PlayerItemSids depotSids;
+	PlayerItemSids inboxSids;
+	std::vector<Item*> uniqueItems; // read by a database thread, registered on the dispatcher before handing over
+};
+
+struct PlayerItemRow
+{
+	int32_t pid;
+	int32_t sid;
+	uint16_t type;
+	uint16_t count;
+	std::string attributes;
+	uint64_t hash;
+};
+
+using PlayerItemRows = std::array<std::vector<PlayerItemRow>, PLAYER_ITEM_TABLE_LAST + 1>;
+using PlayerItemTables = std::bitset<PLAYER_ITEM_TABLE_LAST + 1>;
+
+// Everything savePlayer writes for a player, taken on the dispatcher thread so that it can be written by any thread
+// owning a connection.
+struct PlayerSnapshot
+{
+	uint32_t guid = 0;
+	uint32_t revision = 0;
+	std::string name;
+	time_t lastLoginSaved = 0;
+	std::string lastIP;
+
+	std::string query;
+	DBParams params;
+	PlayerItemRows itemRows;
+	PlayerItemTables skippedTables; // not loaded, the rows are left as they are
+
+	PlayerSaveState saved; // what the database holds, the rows are compared against it
+	PlayerSaveState state; // what the database holds once the snapshot is written
+};
+
+struct OfflineInboxItem
+{
+	uint32_t parent; // 0 for the inbox itself, otherwise the position of the container in the items plus one
+	uint16_t type;
+	uint16_t count;
+	std::string attributes;
+};
+
+// Items and money for a player who is not online, written without loading the player.
+struct OfflineDelivery
+{
+	// serializes the item and everything inside it, the item itself is left to the caller
+	void addItem(const Item* item, uint32_t parent = 0);
+
+	bool empty() const { return items.empty() && balance == 0; }
+
+	std::vector<OfflineInboxItem> items;
+	int64_t balance = 0;
+};
+
 class IOLoginData
 {
 public:
-	static Account loadAccount(uint32_t accno);
+	static Account loadAccount(uint32_t accno, Database& db = Database::getInstance());
 
 	static bool loginserverAuthentication(const std::string& name, const std::string& password, Account& account);
 	static uint32_t gameworldAuthentication(const std::string& accountName, const std::string& password,
@@ -28,17 +118,51 @@ public:
 	static AccountType_t getAccountType(uint32_t accountId);
 	static void setAccountType(uint32_t accountId, AccountType_t accountType);
 	static void updateOnlineStatus(uint32_t guid, bool login);
-	static bool preloadPlayer(Player* player, const std::string& name);
+	static bool preloadPlayer(Player* player, const std::string& name, Database& db = Database::getInstance());
 
 	static bool loadPlayerById(Player* player, uint32_t id);
 	static bool loadPlayerByName(Player* player, const std::string& name);
-	static bool loadPlayer(Player* player, DBResult_ptr result);
+	static bool loadPlayer(Player* player, DBStatementResult_ptr result);
+
+	/**
+	 * Loads a player that is not yet known to the game, safe to call from
+	 * any thread owning the given connection. finishLoadPlayer must be
+	 * called on the dispatcher thread before the player is placed.
+	 */
+	static bool loadDetachedPlayerById(Database& db, Player* player, uint32_t id, PendingPlayerData& pending);
+	static void finishLoadPlayer(Player* player, PendingPlayerData& pending);
+
+	/**
+	 * Loads the depot chests and the inbox left out by the login, see
+	 * Player::loadDepots. queueLoadDepots reads them on the database lane of
+	 * the player, loadDepots right away on the dispatcher thread, for when
+	 * they are needed before the queued load would finish.
+	 */
+	static void queueLoadDepots(uint32_t guid, uint32_t playerId);
+	static void loadDepots(Player* player);
 	static bool savePlayer(Player* player);
+
+	/**
+	 * Serializes the player for saveSnapshot, which writes it on any thread
+	 * owning the given connection. The saved state of the player is moved
+	 * into the snapshot and has to be replaced by snapshot.state once it
+	 * was written.
+	 */
+	static PlayerSnapshot snapshotPlayer(Player* player);
+	static bool saveSnapshot(Database& db, PlayerSnapshot& snapshot);
 	static uint32_t getGuidByName(const std::string& name);
 	static bool getGuidByNameEx(uint32_t& guid, bool& specialVip, std::string& name);
 	static std::string getNameByGuid(uint32_t guid);
 	static bool formatPlayerName(std::string& name);
 	static void increaseBankBalance(uint32_t guid, uint64_t bankBalance);
+
+	/**
+	 * Queues a delivery to an offline player on the database lane of the
+	 * player. The caller must have begun an offline write of the player with
+	 * LoginTasks::beginOfflineWrite, it is ended once the delivery is written.
+	 */
+	static void queueOfflineDelivery(uint32_t guid, OfflineDelivery&& delivery);
+	static bool saveOfflineDelivery(Database& db, uint32_t guid, const OfflineDelivery& delivery);
 	static bool hasBiddedOnHouse(uint32_t guid);
 
 	static std::forward_list<VIPEntry> getVIPEntries(uint32_t accountId);
@@ -53,8 +177,14 @@ public:
 private:
 	using ItemMap = std::map<uint32_t, std::pair<Item*, uint32_t>>;
 
-	static void loadItems(ItemMap& itemMap, DBResult_ptr result);
-	static bool saveItems(const Player* player, const ItemBlockList& itemList, DBInsert& query_insert,
+	static bool loadPlayer(Database& db, Player* player, DBStatementResult_ptr result, PendingPlayerData& pending);
+	static void loadItems(ItemMap& itemMap, DBStatementResult_ptr result, std::map<int32_t, uint64_t>& savedRows,
+	                      PlayerItemSids& itemSids);
+	static void loadItemTree(Database& db, std::string_view table, uint32_t guid, ItemBlockList& topItems,
+	                         std::map<int32_t, uint64_t>& savedRows, PlayerItemSids& itemSids);
+	static void loadDepotItems(Database& db, uint32_t guid, PlayerDepotItems& items);
+	static void finishLoadDepots(Player* player, PlayerDepotItems& items);
+	static void saveItems(const Player* player, const ItemBlockList& itemList, size_t table, PlayerSnapshot& snapshot,
 	                      PropWriteStream& propWriteStream);
 };
 
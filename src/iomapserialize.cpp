@@ -6,20 +6,34 @@
 #include "iomapserialize.h"
 
 #include "bed.h"
+#include "databasetasks.h"
 #include "game.h"
 #include "housetile.h"
+#include "tasks.h"
 
+extern DatabaseTasks g_databaseTasks;
+extern Dispatcher g_dispatcher;
 extern Game g_game;
 
+namespace {
+
+// a house row starts with a position no map can have, rows of older versions hold a single tile and start with its
+// position
+constexpr uint16_t HOUSE_TILES_MARKER = 0xFFFF;
+constexpr uint8_t HOUSE_TILES_VERSION = 1;
+
+} // namespace
+
 void IOMapSerialize::loadHouseItems(Map* map)
 {
 	int64_t start = OTSYS_TIME();
 
-	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `data` FROM `tile_store`");
+	DBResult_ptr result = Database::getInstance().storeQuery("SELECT `house_id`, `data` FROM `tile_store`");
 	if (!result) {
 		return;
 	}
 
+	std::vector<House*> convertedHouses;
 	do {
 		unsigned long attrSize;
 		const char* attr = result->getStream("data", attrSize);
@@ -27,73 +41,77 @@ void IOMapSerialize::loadHouseItems(Map* map)
 		PropStream propStream;
 		propStream.init(attr, attrSize);
 
-		uint16_t x, y;
-		uint8_t z;
-		if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z)) {
+		uint16_t marker;
+		if (!propStream.read<uint16_t>(marker)) {
 			continue;
 		}
 
-		Tile* tile = map->getTile(x, y, z);
-		if (!tile) {
+		if (marker != HOUSE_TILES_MARKER) {
+			propStream.init(attr, attrSize);
+			loadTile(propStream, map);
+
+			// write the house in the current format with the next save
+			if (House* house = map->houses.getHouse(result->getNumber<uint32_t>("house_id"))) {
+				convertedHouses.push_back(house);
+			}
 			continue;
 		}
 
-		uint32_t item_count;
-		if (!propStream.read<uint32_t>(item_count)) {
+		uint8_t version;
+		uint32_t tileCount;
+		if (!propStream.read<uint8_t>(version) || version != HOUSE_TILES_VERSION ||
+		    !propStream.read<uint32_t>(tileCount)) {
+			std::cout << "[Warning - IOMapSerialize::loadHouseItems] Unknown tile data format of house "
+			          << result->getNumber<uint32_t>("house_id") << '.' << std::endl;
 			continue;
 		}
 
-		while (item_count--) {
-			loadItem(propStream, tile);
+		while (tileCount--) {
+			if (!loadTile(propStream, map)) {
+				break;
+			}
 		}
 	} while (result->next());
+
+	// loading the items reports them as changed
+	for (const auto& it : map->houses.getHouses()) {
+		it.second->setItemsChanged(false);
+	}
+
+	for (House* house : convertedHouses) {
+		house->setItemsChanged();
+	}
 	std::cout << "> Loaded house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
 }
 
-bool IOMapSerialize::saveHouseItems()
+bool IOMapSerialize::loadTile(PropStream& propStream, Map* map)
 {
-	int64_t start = OTSYS_TIME();
-	Database& db = Database::getInstance();
-
-	// Start the transaction
-	DBTransaction transaction;
-	if (!transaction.begin()) {
+	uint16_t x, y;
+	uint8_t z;
+	uint32_t item_count;
+	if (!propStream.read<uint16_t>(x) || !propStream.read<uint16_t>(y) || !propStream.read<uint8_t>(z) ||
+	    !propStream.read<uint32_t>(item_count)) {
 		return false;
 	}
 
-	// clear old tile data
-	if (!db.executeQuery("DELETE FROM `tile_store`")) {
+	Tile* tile = map->getTile(x, y, z);
+	if (!tile) {
+		// the items of the tiles following it can not be found without reading these
 		return false;
 	}
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
-
-	PropWriteStream stream;
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		// save house items
-		House* house = it.second;
-		for (HouseTile* tile : house->getTiles()) {
-			saveTile(stream, tile);
-
-			size_t attributesSize;
-			const char* attributes = stream.getStream(attributesSize);
-			if (attributesSize > 0) {
-				if (!stmt.addRow(
-				        fmt::format("{:d}, {:s}", house->getId(), db.escapeBlob(attributes, attributesSize)))) {
-					return false;
-				}
-				stream.clear();
-			}
-		}
-	}
-
-	if (!stmt.execute()) {
-		return false;
+	while (item_count--) {
+		loadItem(propStream, tile);
 	}
+	return true;
+}
 
-	// End the transaction
-	bool success = transaction.commit();
-	std::cout << "> Saved house items in: " << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
+bool IOMapSerialize::saveHouseItems(Database& db, const HousesSnapshot& snapshot)
+{
+	int64_t start = OTSYS_TIME();
+	bool success = saveHouseTiles(db, snapshot.tiles);
+	std::cout << "> Saved items of " << snapshot.tiles.size() << " changed houses in: "
+	          << (OTSYS_TIME() - start) / (1000.) << " s" << std::endl;
 	return success;
 }
 
@@ -220,11 +238,11 @@ void IOMapSerialize::saveItem(PropWriteStream& stream, const Item* item)
 	stream.write<uint8_t>(0x00); // attr end
 }
 
-void IOMapSerialize::saveTile(PropWriteStream& stream, const Tile* tile)
+bool IOMapSerialize::saveTile(PropWriteStream& stream, const Tile* tile)
 {
 	const TileItemVector* tileItems = tile->getItemList();
 	if (!tileItems) {
-		return;
+		return false;
 	}
 
 	std::forward_list<Item*> items;
@@ -242,17 +260,20 @@ void IOMapSerialize::saveTile(PropWriteStream& stream, const Tile* tile)
 		++count;
 	}
 
-	if (!items.empty()) {
-		const Position& tilePosition = tile->getPosition();
-		stream.write<uint16_t>(tilePosition.x);
-		stream.write<uint16_t>(tilePosition.y);
-		stream.write<uint8_t>(tilePosition.z);
+	if (items.empty()) {
+		return false;
+	}
+
+	const Position& tilePosition = tile->getPosition();
+	stream.write<uint16_t>(tilePosition.x);
+	stream.write<uint16_t>(tilePosition.y);
+	stream.write<uint8_t>(tilePosition.z);
 
-		stream.write<uint32_t>(count);
-		for (const Item* item : items) {
-			saveItem(stream, item);
-		}
+	stream.write<uint32_t>(count);
+	for (const Item* item : items) {
+		saveItem(stream, item);
 	}
+	return true;
 }
 
 bool IOMapSerialize::loadHouseInfo()
@@ -285,11 +306,9 @@ bool IOMapSerialize::loadHouseInfo()
 	return true;
 }
 
-bool IOMapSerialize::saveHouseInfo()
+bool IOMapSerialize::saveHouseInfo(Database& db, const HousesSnapshot& snapshot)
 {
-	Database& db = Database::getInstance();
-
-	DBTransaction transaction;
+	DBTransaction transaction(db);
 	if (!transaction.begin()) {
 		return false;
 	}
@@ -298,95 +317,166 @@ bool IOMapSerialize::saveHouseInfo()
 		return false;
 	}
 
-	for (const auto& it : g_game.map.houses.getHouses()) {
-		House* house = it.second;
-		DBResult_ptr result = db.storeQuery(fmt::format("SELECT `id` FROM `houses` WHERE `id` = {:d}", house->getId()));
-		if (result) {
-			db.executeQuery(fmt::format(
-			    "UPDATE `houses` SET `owner` = {:d}, `paid` = {:d}, `warnings` = {:d}, `name` = {:s}, `town_id` = {:d}, `rent` = {:d}, `size` = {:d}, `beds` = {:d} WHERE `id` = {:d}",
-			    house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount(), house->getId()));
-		} else {
-			db.executeQuery(fmt::format(
-			    "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ({:d}, {:d}, {:d}, {:d}, {:s}, {:d}, {:d}, {:d}, {:d})",
-			    house->getId(), house->getOwner(), house->getPaidUntil(), house->getPayRentWarnings(),
-			    db.escapeString(house->getName()), house->getTownId(), house->getRent(), house->getTiles().size(),
-			    house->getBedCount()));
+	DBStatementInsert houseStmt(
+	    db,
+	    "INSERT INTO `houses` (`id`, `owner`, `paid`, `warnings`, `name`, `town_id`, `rent`, `size`, `beds`) VALUES ",
+	    9,
+	    " ON DUPLICATE KEY UPDATE `owner` = VALUES(`owner`), `paid` = VALUES(`paid`), `warnings` = VALUES(`warnings`), `name` = VALUES(`name`), `town_id` = VALUES(`town_id`), `rent` = VALUES(`rent`), `size` = VALUES(`size`), `beds` = VALUES(`beds`)");
+	for (const HouseInfoRow& row : snapshot.houses) {
+		if (!houseStmt.addRow(
+		        {row.id, row.owner, row.paid, row.warnings, row.name, row.townId, row.rent, row.size, row.beds})) {
+			return false;
 		}
 	}
 
-	DBInsert stmt("INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ");
+	if (!houseStmt.execute()) {
+		return false;
+	}
+
+	DBStatementInsert stmt(db, "INSERT INTO `house_lists` (`house_id` , `listid` , `list`) VALUES ", 3);
+	for (const HouseListRow& row : snapshot.lists) {
+		if (!stmt.addRow({row.houseId, row.listId, row.list})) {
+			return false;
+		}
+	}
+
+	if (!stmt.execute()) {
+		return false;
+	}
 
+	return transaction.commit();
+}
+
+HousesSnapshot IOMapSerialize::snapshotHouses()
+{
+	HousesSnapshot snapshot;
 	for (const auto& it : g_game.map.houses.getHouses()) {
 		House* house = it.second;
+		snapshot.houses.push_back({house->getId(), house->getOwner(), house->getPaidUntil(),
+		                           house->getPayRentWarnings(), house->getName(), house->getTownId(), house->getRent(),
+		                           static_cast<uint32_t>(house->getTiles().size()), house->getBedCount()});
 
 		std::string listText;
 		if (house->getAccessList(GUEST_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {}, {:s}", house->getId(), GUEST_LIST, db.escapeString(listText)))) {
-				return false;
-			}
-
+			snapshot.lists.push_back({house->getId(), GUEST_LIST, std::move(listText)});
 			listText.clear();
 		}
 
 		if (house->getAccessList(SUBOWNER_LIST, listText) && !listText.empty()) {
-			if (!stmt.addRow(fmt::format("{:d}, {}, {:s}", house->getId(), SUBOWNER_LIST, db.escapeString(listText)))) {
-				return false;
-			}
-
+			snapshot.lists.push_back({house->getId(), SUBOWNER_LIST, std::move(listText)});
 			listText.clear();
 		}
 
 		for (Door* door : house->getDoors()) {
 			if (door->getAccessList(listText) && !listText.empty()) {
-				if (!stmt.addRow(fmt::format("{:d}, {:d}, {:s}", house->getId(), door->getDoorId(),
-				                             db.escapeString(listText)))) {
-					return false;
-				}
-
+				snapshot.lists.push_back({house->getId(), door->getDoorId(), std::move(listText)});
 				listText.clear();
 			}
 		}
+
+		if (house->hasItemsChanged()) {
+			snapshot.tiles.push_back(snapshotHouseTiles(house));
+		}
 	}
+	return snapshot;
+}
 
-	if (!stmt.execute()) {
-		return false;
+HouseTileRow IOMapSerialize::snapshotHouseTiles(House* house)
+{
+	PropWriteStream stream;
+	stream.write<uint16_t>(HOUSE_TILES_MARKER);
+	stream.write<uint8_t>(HOUSE_TILES_VERSION);
+	stream.write<uint32_t>(0); // tile count, patched below
+
+	uint32_t tileCount = 0;
+	for (HouseTile* tile : house->getTiles()) {
+		if (saveTile(stream, tile)) {
+			++tileCount;
+		}
 	}
 
-	return transaction.commit();
+	house->setItemsChanged(false);
+
+	if (tileCount == 0) {
+		return {house->getId(), {}};
+	}
+
+	size_t size;
+	const char* data = stream.getStream(size);
+	std::string blob(data, size);
+	std::memcpy(blob.data() + sizeof(uint16_t) + sizeof(uint8_t), &tileCount, sizeof(tileCount));
+	return {house->getId(), std::move(blob)};
 }
 
-bool IOMapSerialize::saveHouse(House* house)
+void IOMapSerialize::setHousesChanged(const std::vector<HouseTileRow>& rows)
 {
-	Database& db = Database::getInstance();
+	std::vector<uint32_t> houseIds;
+	houseIds.reserve(rows.size());
+	for (const HouseTileRow& row : rows) {
+		houseIds.push_back(row.houseId);
+	}
+
+	g_dispatcher.addTask([houseIds = std::move(houseIds)]() {
+		for (uint32_t houseId : houseIds) {
+			if (House* house = g_game.map.houses.getHouse(houseId)) {
+				house->setItemsChanged();
+			}
+		}
+	});
+}
+
+bool IOMapSerialize::saveHouse(House* house, std::function<void(bool)> callback /* = nullptr*/)
+{
+	auto rows = std::make_shared<std::vector<HouseTileRow>>();
+	rows->push_back(snapshotHouseTiles(house));
+
+	// server saves write the houses on the same lane, so an older snapshot never overwrites this one
+	auto task = [rows, callback = std::move(callback)](Database& db) {
+		const bool success = saveHouseTiles(db, *rows);
+		if (!success) {
+			std::cout << "[Error - IOMapSerialize::saveHouse] Failed to save the items of house "
+			          << rows->front().houseId << '.' << std::endl;
+			setHousesChanged(*rows);
+		}
+
+		if (callback) {
+			g_dispatcher.addTask([callback, success]() { callback(success); });
+		}
+	};
+	if (!g_databaseTasks.addTask(task, DatabaseTasks::getKey("houses"))) {
+		task(Database::getInstance());
+	}
+	return true;
+}
+
+bool IOMapSerialize::saveHouseTiles(Database& db, const std::vector<HouseTileRow>& rows)
+{
+	if (rows.empty()) {
+		return true;
+	}
 
 	// Start the transaction
-	DBTransaction transaction;
+	DBTransaction transaction(db);
 	if (!transaction.begin()) {
 		return false;
 	}
 
-	uint32_t houseId = house->getId();
+	// clear old tile data, older versions kept a row per tile
+	DBStatementInsert deleteQuery(db, "DELETE FROM `tile_store` WHERE `house_id` IN (", 1, ")");
+	for (const HouseTileRow& row : rows) {
+		if (!deleteQuery.addRow({row.houseId})) {
+			return false;
+		}
+	}
 
-	// clear old tile data
-	if (!db.executeQuery(fmt::format("DELETE FROM `tile_store` WHERE `house_id` = {:d}", houseId))) {
+	if (!deleteQuery.execute()) {
 		return false;
 	}
 
-	DBInsert stmt("INSERT INTO `tile_store` (`house_id`, `data`) VALUES ");
-
-	PropWriteStream stream;
-	for (HouseTile* tile : house->getTiles()) {
-		saveTile(stream, tile);
-
-		size_t attributesSize;
-		const char* attributes = stream.getStream(attributesSize);
-		if (attributesSize > 0) {
-			if (!stmt.addRow(fmt::format("{:d}, {:s}", houseId, db.escapeBlob(attributes, attributesSize)))) {
-				return false;
-			}
-			stream.clear();
+	DBStatementInsert stmt(db, "INSERT INTO `tile_store` (`house_id`, `data`) VALUES ", 2);
+	for (const HouseTileRow& row : rows) {
+		if (!row.data.empty() && !stmt.addRow({row.houseId, DBParam::blob(row.data.data(), row.data.size())})) {
+			return false;
 		}
 	}
 
@@ -4,6 +4,8 @@
 #ifndef FS_IOMAPSERIALIZE_H
 #define FS_IOMAPSERIALIZE_H
 
+#include "database.h"
+
 class Container;
 class Cylinder;
 class House;
@@ -13,20 +15,74 @@ class PropStream;
 class PropWriteStream;
 class Tile;
 
+struct HouseInfoRow
+{
+	uint32_t id;
+	uint32_t owner;
+	time_t paid;
+	uint32_t warnings;
+	std::string name;
+	uint32_t townId;
+	uint32_t rent;
+	uint32_t size;
+	uint32_t beds;
+};
+
+struct HouseListRow
+{
+	uint32_t houseId;
+	uint32_t listId;
+	std::string list;
+};
+
+// All tiles of a house in one tile_store row, empty when none of them has items worth saving.
+struct HouseTileRow
+{
+	uint32_t houseId;
+	std::string data;
+};
+
+// Everything Map::save writes, taken on the dispatcher thread so that it can be written by any thread owning a
+// connection.
+struct HousesSnapshot
+{
+	std::vector<HouseInfoRow> houses;
+	std::vector<HouseListRow> lists;
+	std::vector<HouseTileRow> tiles; // only the houses whose items changed since they were last written
+};
+
 class IOMapSerialize
 {
 public:
 	static void loadHouseItems(Map* map);
-	static bool saveHouseItems();
+	static bool saveHouseItems(Database& db, const HousesSnapshot& snapshot);
 	static bool loadHouseInfo();
-	static bool saveHouseInfo();
+	static bool saveHouseInfo(Database& db, const HousesSnapshot& snapshot);
+
+	static HousesSnapshot snapshotHouses();
+
+	/**
+	 * Marks the houses of tile rows that could not be written as changed
+	 * again, so that the next save retries them. Safe to call from any thread.
+	 */
+	static void setHousesChanged(const std::vector<HouseTileRow>& rows);
 
-	static bool saveHouse(House* house);
+	/**
+	 * Queues the items of a single house to be written after any server
+	 * save still being written, returns before they are.
+	 *
+	 * @param callback called on the dispatcher thread once written, with
+	 * whether that succeeded
+	 */
+	static bool saveHouse(House* house, std::function<void(bool)> callback = nullptr);
 
 private:
 	static void saveItem(PropWriteStream& stream, const Item* item);
-	static void saveTile(PropWriteStream& stream, const Tile* tile);
+	static bool saveTile(PropWriteStream& stream, const Tile* tile);
+	static HouseTileRow snapshotHouseTiles(House* house);
+	static bool saveHouseTiles(Database& db, const std::vector<HouseTileRow>& rows);
 
+	static bool loadTile(PropStream& propStream, Map* map);
 	static bool loadContainer(PropStream& propStream, Container* container);
 	static bool loadItem(PropStream& propStream, Cylinder* parent);
 };
@@ -10,37 +10,147 @@
 #include "game.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "logintasks.h"
 #include "scheduler.h"
 
 extern ConfigManager g_config;
+extern Dispatcher g_dispatcher;
 extern Game g_game;
+extern LoginTasks g_loginTasks;
+
+namespace {
+
+// time the dispatcher may spend on expired offers before the rest waits for the next tick
+constexpr auto EXPIRED_OFFERS_TICK_BUDGET = std::chrono::milliseconds(10);
+
+const size_t marketOffersKey = DatabaseTasks::getKey("market_offers");
+const size_t marketHistoryKey = DatabaseTasks::getKey("market_history");
+
+void addMarketTask(std::function<void(Database&)> task, size_t key)
+{
+	if (!g_databaseTasks.addTask(task, key)) {
+		task(Database::getInstance());
+	}
+}
+
+} // namespace
+
+void IOMarket::loadOffers()
+{
+	DBResult_ptr result = Database::getInstance().storeQuery(
+	    "SELECT `market_offers`.`id`, `player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`, `players`.`name`, `players`.`account_id` FROM `market_offers` INNER JOIN `players` ON `players`.`id` = `market_offers`.`player_id`");
+
+	IOMarket& market = getInstance();
+	if (result) {
+		do {
+			MarketOrder offer;
+			offer.id = result->getNumber<uint32_t>("id");
+			offer.playerId = result->getNumber<uint32_t>("player_id");
+			offer.accountId = result->getNumber<uint32_t>("account_id");
+			offer.created = result->getNumber<uint32_t>("created");
+			offer.price = result->getNumber<uint64_t>("price");
+			offer.itemId = result->getNumber<uint16_t>("itemtype");
+			offer.amount = result->getNumber<uint16_t>("amount");
+			offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
+			offer.anonymous = result->getNumber<uint16_t>("anonymous") != 0;
+			offer.playerName = result->getString("name");
+			market.nextOfferId = std::max(market.nextOfferId, offer.id + 1);
+			market.addOffer(std::move(offer));
+		} while (result->next());
+	}
+
+	std::cout << "> Loaded " << market.offers.size() << " market offers." << std::endl;
+}
+
+void IOMarket::addOffer(MarketOrder&& offer)
+{
+	const uint32_t offerId = offer.id;
+	itemOffers[offer.itemId][offer.type].emplace(offer.price, offerId);
+	playerOffers[offer.playerId].insert(offerId);
+	counterOffers[getCounterKey(offer.created, offerId & 0xFFFF)] = offerId;
+	offersByCreation.emplace(offer.created, offerId);
+	offers.emplace(offerId, std::move(offer));
+}
+
+bool IOMarket::removeOffer(uint32_t offerId, MarketOrder* removed /* = nullptr*/)
+{
+	auto it = offers.find(offerId);
+	if (it == offers.end()) {
+		return false;
+	}
+
+	const MarketOrder& offer = it->second;
+
+	auto itemIt = itemOffers.find(offer.itemId);
+	if (itemIt != itemOffers.end()) {
+		auto& sides = itemIt->second;
+		sides[offer.type].erase({offer.price, offerId});
+		if (sides[MARKETACTION_BUY].empty() && sides[MARKETACTION_SELL].empty()) {
+			itemOffers.erase(itemIt);
+		}
+	}
+
+	auto playerIt = playerOffers.find(offer.playerId);
+	if (playerIt != playerOffers.end()) {
+		playerIt->second.erase(offerId);
+		if (playerIt->second.empty()) {
+			playerOffers.erase(playerIt);
+		}
+	}
+
+	// another offer created in the same second may share the counter
+	auto counterIt = counterOffers.find(getCounterKey(offer.created, offerId & 0xFFFF));
+	if (counterIt != counterOffers.end() && counterIt->second == offerId) {
+		counterOffers.erase(counterIt);
+	}
+
+	offersByCreation.erase({offer.created, offerId});
+
+	if (removed) {
+		*removed = std::move(it->second);
+	}
+	offers.erase(it);
+	return true;
+}
 
 MarketOfferList IOMarket::getActiveOffers(MarketAction_t action, uint16_t itemId)
 {
 	MarketOfferList offerList;
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `sale` = {:d} AND `itemtype` = {:d}",
-	    action, itemId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.itemOffers.find(itemId);
+	if (it == market.itemOffers.end()) {
 		return offerList;
 	}
 
 	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	do {
-		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		if (result->getNumber<uint16_t>("anonymous") == 0) {
-			offer.playerName = result->getString("player_name");
+	auto addOffer = [&](uint32_t offerId) {
+		const MarketOrder& order = market.offers[offerId];
+
+		MarketOffer& offer = offerList.emplace_back();
+		offer.amount = order.amount;
+		offer.price = order.price;
+		offer.timestamp = order.created + marketOfferDuration;
+		offer.counter = order.id & 0xFFFF;
+		if (!order.anonymous) {
+			offer.playerName = order.playerName;
 		} else {
 			offer.playerName = "Anonymous";
 		}
-		offerList.push_back(offer);
-	} while (result->next());
+	};
+
+	// best prices first: the highest buy offers and the lowest sell offers
+	const auto& offerIds = it->second[action];
+	if (action == MARKETACTION_BUY) {
+		for (auto offerIt = offerIds.rbegin(), end = offerIds.rend(); offerIt != end; ++offerIt) {
+			addOffer(offerIt->second);
+		}
+	} else {
+		for (const auto& offerId : offerIds) {
+			addOffer(offerId.second);
+		}
+	}
 	return offerList;
 }
 
@@ -48,142 +158,198 @@ MarketOfferList IOMarket::getOwnOffers(MarketAction_t action, uint32_t playerId)
 {
 	MarketOfferList offerList;
 
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `amount`, `price`, `created`, `itemtype` FROM `market_offers` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, action));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return offerList;
 	}
 
-	do {
-		MarketOffer offer;
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("created") + marketOfferDuration;
-		offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offerList.push_back(offer);
-	} while (result->next());
+	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+
+	for (uint32_t offerId : it->second) {
+		const MarketOrder& order = market.offers[offerId];
+		if (order.type != action) {
+			continue;
+		}
+
+		MarketOffer& offer = offerList.emplace_back();
+		offer.amount = order.amount;
+		offer.price = order.price;
+		offer.timestamp = order.created + marketOfferDuration;
+		offer.counter = order.id & 0xFFFF;
+		offer.itemId = order.itemId;
+	}
 	return offerList;
 }
 
-HistoryMarketOfferList IOMarket::getOwnHistory(MarketAction_t action, uint32_t playerId)
+void IOMarket::getOwnHistory(uint32_t playerId,
+                             std::function<void(HistoryMarketOfferList&&, HistoryMarketOfferList&&)> callback)
 {
-	HistoryMarketOfferList offerList;
+	// on the lane history is appended on, so the latest transactions are included
+	addMarketTask(
+	    [playerId, callback = std::move(callback)](Database& db) {
+		    auto buyOffers = std::make_shared<HistoryMarketOfferList>();
+		    auto sellOffers = std::make_shared<HistoryMarketOfferList>();
+
+		    DBStatementResult_ptr result =
+		        db.prepare(
+		              "SELECT `sale`, `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = ?")
+		            .query({playerId});
+		    if (result) {
+			    do {
+				    HistoryMarketOffer offer;
+				    offer.itemId = result->getNumber<uint16_t>("itemtype");
+				    offer.amount = result->getNumber<uint16_t>("amount");
+				    offer.price = result->getNumber<uint64_t>("price");
+				    offer.timestamp = result->getNumber<uint32_t>("expires_at");
+
+				    auto offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
+				    if (offerState == OFFERSTATE_ACCEPTEDEX) {
+					    offerState = OFFERSTATE_ACCEPTED;
+				    }
+
+				    offer.state = offerState;
+
+				    if (result->getNumber<uint16_t>("sale") == MARKETACTION_BUY) {
+					    buyOffers->push_back(offer);
+				    } else {
+					    sellOffers->push_back(offer);
+				    }
+			    } while (result->next());
+		    }
+
+		    g_dispatcher.addTask(
+		        [callback, buyOffers, sellOffers]() { callback(std::move(*buyOffers), std::move(*sellOffers)); });
+	    },
+	    marketHistoryKey);
+}
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `itemtype`, `amount`, `price`, `expires_at`, `state` FROM `market_history` WHERE `player_id` = {:d} AND `sale` = {:d}",
-	    playerId, action));
-	if (!result) {
-		return offerList;
-	}
+void IOMarket::createOfferItems(const ItemType& itemType, uint16_t amount, const std::function<bool(Item*)>& add)
+{
+	if (itemType.stackable) {
+		while (amount > 0) {
+			uint16_t stackCount = std::min<uint16_t>(100, amount);
+			if (!add(Item::CreateItem(itemType.id, stackCount))) {
+				break;
+			}
 
-	do {
-		HistoryMarketOffer offer;
-		offer.itemId = result->getNumber<uint16_t>("itemtype");
-		offer.amount = result->getNumber<uint16_t>("amount");
-		offer.price = result->getNumber<uint64_t>("price");
-		offer.timestamp = result->getNumber<uint32_t>("expires_at");
-
-		MarketOfferState_t offerState = static_cast<MarketOfferState_t>(result->getNumber<uint16_t>("state"));
-		if (offerState == OFFERSTATE_ACCEPTEDEX) {
-			offerState = OFFERSTATE_ACCEPTED;
+			amount -= stackCount;
+		}
+	} else {
+		int32_t subType;
+		if (itemType.charges != 0) {
+			subType = itemType.charges;
+		} else {
+			subType = -1;
 		}
 
-		offer.state = offerState;
-
-		offerList.push_back(offer);
-	} while (result->next());
-	return offerList;
+		for (uint16_t i = 0; i < amount; ++i) {
+			if (!add(Item::CreateItem(itemType.id, subType))) {
+				break;
+			}
+		}
+	}
 }
 
-void IOMarket::processExpiredOffers(DBResult_ptr result, bool)
+void IOMarket::processExpiredOffers(std::vector<uint32_t> offerIds)
 {
-	if (!result) {
-		return;
-	}
+	const auto deadline = std::chrono::steady_clock::now() + EXPIRED_OFFERS_TICK_BUDGET;
 
-	do {
-		if (!IOMarket::moveOfferToHistory(result->getNumber<uint32_t>("id"), OFFERSTATE_EXPIRED)) {
+	IOMarket& market = getInstance();
+
+	// everything owed to offline owners is written at once per owner, without loading them
+	std::map<uint32_t, OfflineDelivery> deliveries;
+
+	size_t processed = 0;
+	while (processed < offerIds.size() && std::chrono::steady_clock::now() < deadline) {
+		const uint32_t offerId = offerIds[processed++];
+		auto it = market.offers.find(offerId);
+		if (it == market.offers.end()) {
+			// accepted or cancelled meanwhile
 			continue;
 		}
 
-		const uint32_t playerId = result->getNumber<uint32_t>("player_id");
-		const uint16_t amount = result->getNumber<uint16_t>("amount");
-		if (result->getNumber<uint16_t>("sale") == 1) {
-			const ItemType& itemType = Item::items[result->getNumber<uint16_t>("itemtype")];
-			if (itemType.id == 0) {
-				continue;
-			}
+		const uint32_t playerId = it->second.playerId;
+		Player* player = g_game.getPlayerByGUID(playerId);
 
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (!player) {
-				player = new Player(nullptr);
-				if (!IOLoginData::loadPlayerById(player, playerId)) {
-					delete player;
+		OfflineDelivery* delivery = nullptr;
+		if (!player) {
+			auto deliveryIt = deliveries.find(playerId);
+			if (deliveryIt == deliveries.end()) {
+				if (!g_loginTasks.beginOfflineWrite(playerId)) {
+					// the owner is logging in, a later check delivers to them online
 					continue;
 				}
+				deliveryIt = deliveries.emplace(playerId, OfflineDelivery()).first;
 			}
+			delivery = &deliveryIt->second;
+		}
 
-			if (itemType.stackable) {
-				uint16_t tmpAmount = amount;
-				while (tmpAmount > 0) {
-					uint16_t stackCount = std::min<uint16_t>(100, tmpAmount);
-					Item* item = Item::CreateItem(itemType.id, stackCount);
-					if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) !=
-					    RETURNVALUE_NOERROR) {
-						delete item;
-						break;
-					}
+		MarketOrder offer = it->second;
+		if (!moveOfferToHistory(offerId, OFFERSTATE_EXPIRED)) {
+			continue;
+		}
 
-					tmpAmount -= stackCount;
-				}
-			} else {
-				int32_t subType;
-				if (itemType.charges != 0) {
-					subType = itemType.charges;
-				} else {
-					subType = -1;
-				}
+		if (offer.type == MARKETACTION_SELL) {
+			const ItemType& itemType = Item::items[offer.itemId];
+			if (itemType.id == 0) {
+				continue;
+			}
 
-				for (uint16_t i = 0; i < amount; ++i) {
-					Item* item = Item::CreateItem(itemType.id, subType);
+			if (delivery) {
+				createOfferItems(itemType, offer.amount, [delivery](Item* item) {
+					delivery->addItem(item);
+					delete item;
+					return true;
+				});
+			} else {
+				player->loadDepots();
+				createOfferItems(itemType, offer.amount, [player](Item* item) {
 					if (g_game.internalAddItem(player->getInbox(), item, INDEX_WHEREEVER, FLAG_NOLIMIT) !=
 					    RETURNVALUE_NOERROR) {
 						delete item;
-						break;
+						return false;
 					}
-				}
-			}
-
-			if (player->isOffline()) {
-				IOLoginData::savePlayer(player);
-				delete player;
+					return true;
+				});
 			}
 		} else {
-			uint64_t totalPrice = result->getNumber<uint64_t>("price") * amount;
-
-			Player* player = g_game.getPlayerByGUID(playerId);
-			if (player) {
-				player->setBankBalance(player->getBankBalance() + totalPrice);
+			uint64_t totalPrice = offer.price * offer.amount;
+			if (delivery) {
+				delivery->balance += totalPrice;
 			} else {
-				IOLoginData::increaseBankBalance(playerId, totalPrice);
+				player->setBankBalance(player->getBankBalance() + totalPrice);
 			}
 		}
-	} while (result->next());
+	}
+
+	for (auto& it : deliveries) {
+		IOLoginData::queueOfflineDelivery(it.first, std::move(it.second));
+	}
+
+	if (processed < offerIds.size()) {
+		offerIds.erase(offerIds.begin(), offerIds.begin() + processed);
+		g_scheduler.addEvent(createSchedulerTask(SCHEDULER_MINTICKS, [offerIds = std::move(offerIds)]() mutable {
+			processExpiredOffers(std::move(offerIds));
+		}));
+	}
 }
 
 void IOMarket::checkExpiredOffers()
 {
 	const time_t lastExpireDate = time(nullptr) - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	g_databaseTasks.addTask(
-	    fmt::format(
-	        "SELECT `id`, `amount`, `price`, `itemtype`, `player_id`, `sale` FROM `market_offers` WHERE `created` <= {:d}",
-	        lastExpireDate),
-	    IOMarket::processExpiredOffers, true);
+	std::vector<uint32_t> expiredIds;
+	for (const auto& it : getInstance().offersByCreation) {
+		if (it.first > lastExpireDate) {
+			break;
+		}
+		expiredIds.push_back(it.second);
+	}
+
+	if (!expiredIds.empty()) {
+		processExpiredOffers(std::move(expiredIds));
+	}
 
 	int32_t checkExpiredMarketOffersEachMinutes =
 	    g_config.getNumber(ConfigManager::CHECK_EXPIRED_MARKET_OFFERS_EACH_MINUTES);
@@ -197,93 +363,134 @@ void IOMarket::checkExpiredOffers()
 
 uint32_t IOMarket::getPlayerOfferCount(uint32_t playerId)
 {
-	DBResult_ptr result = Database::getInstance().storeQuery(
-	    fmt::format("SELECT COUNT(*) AS `count` FROM `market_offers` WHERE `player_id` = {:d}", playerId));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.playerOffers.find(playerId);
+	if (it == market.playerOffers.end()) {
 		return 0;
 	}
-	return result->getNumber<int32_t>("count");
+	return it->second.size();
 }
 
 MarketOfferEx IOMarket::getOfferByCounter(uint32_t timestamp, uint16_t counter)
 {
 	MarketOfferEx offer;
 
-	const int32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	const uint32_t created = timestamp - g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
 
-	DBResult_ptr result = Database::getInstance().storeQuery(fmt::format(
-	    "SELECT `id`, `sale`, `itemtype`, `amount`, `created`, `price`, `player_id`, `anonymous`, (SELECT `name` FROM `players` WHERE `id` = `player_id`) AS `player_name` FROM `market_offers` WHERE `created` = {:d} AND (`id` & 65535) = {:d} LIMIT 1",
-	    created, counter));
-	if (!result) {
+	IOMarket& market = getInstance();
+	auto it = market.counterOffers.find(getCounterKey(created, counter));
+	if (it == market.counterOffers.end()) {
 		offer.id = 0;
 		offer.playerId = 0;
 		return offer;
 	}
 
-	offer.id = result->getNumber<uint32_t>("id");
-	offer.type = static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale"));
-	offer.amount = result->getNumber<uint16_t>("amount");
-	offer.counter = result->getNumber<uint32_t>("id") & 0xFFFF;
-	offer.timestamp = result->getNumber<uint32_t>("created");
-	offer.price = result->getNumber<uint64_t>("price");
-	offer.itemId = result->getNumber<uint16_t>("itemtype");
-	offer.playerId = result->getNumber<uint32_t>("player_id");
-	if (result->getNumber<uint16_t>("anonymous") == 0) {
-		offer.playerName = result->getString("player_name");
+	const MarketOrder& order = market.offers[it->second];
+	offer.id = order.id;
+	offer.type = order.type;
+	offer.amount = order.amount;
+	offer.counter = order.id & 0xFFFF;
+	offer.timestamp = order.created;
+	offer.price = order.price;
+	offer.itemId = order.itemId;
+	offer.playerId = order.playerId;
+	offer.accountId = order.accountId;
+	if (!order.anonymous) {
+		offer.playerName = order.playerName;
 	} else {
 		offer.playerName = "Anonymous";
 	}
 	return offer;
 }
 
-void IOMarket::createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price,
-                           bool anonymous)
+void IOMarket::createOffer(const Player& player, MarketAction_t action, uint16_t itemId, uint16_t amount,
+                           uint64_t price, bool anonymous)
 {
-	Database::getInstance().executeQuery(fmt::format(
-	    "INSERT INTO `market_offers` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `created`, `anonymous`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, action, itemId, amount, price, time(nullptr), anonymous));
+	IOMarket& market = getInstance();
+
+	MarketOrder offer;
+	offer.id = market.nextOfferId++;
+	offer.playerId = player.getGUID();
+	offer.accountId = player.getAccount();
+	offer.created = time(nullptr);
+	offer.price = price;
+	offer.itemId = itemId;
+	offer.amount = amount;
+	offer.type = action;
+	offer.anonymous = anonymous;
+	offer.playerName = player.getName();
+
+	addMarketTask(
+	    [id = offer.id, playerId = offer.playerId, action, itemId, amount, created = offer.created, anonymous,
+	     price](Database& db) {
+		    db.prepare(
+		          "INSERT INTO `market_offers` (`id`, `player_id`, `sale`, `itemtype`, `amount`, `created`, `anonymous`, `price`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)")
+		        .execute({id, playerId, static_cast<uint8_t>(action), itemId, amount, created, anonymous, price});
+	    },
+	    marketOffersKey);
+
+	market.addOffer(std::move(offer));
 }
 
 void IOMarket::acceptOffer(uint32_t offerId, uint16_t amount)
 {
-	Database::getInstance().executeQuery(
-	    fmt::format("UPDATE `market_offers` SET `amount` = `amount` - {:d} WHERE `id` = {:d}", amount, offerId));
+	IOMarket& market = getInstance();
+	auto it = market.offers.find(offerId);
+	if (it == market.offers.end()) {
+		return;
+	}
+
+	it->second.amount -= std::min(amount, it->second.amount);
+
+	addMarketTask(
+	    [offerId, amount](Database& db) {
+		    db.prepare("UPDATE `market_offers` SET `amount` = `amount` - ? WHERE `id` = ?").execute({amount, offerId});
+	    },
+	    marketOffersKey);
 }
 
 void IOMarket::deleteOffer(uint32_t offerId)
 {
-	Database::getInstance().executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId));
+	if (!getInstance().removeOffer(offerId)) {
+		return;
+	}
+
+	addMarketTask(
+	    [offerId](Database& db) { db.prepare("DELETE FROM `market_offers` WHERE `id` = ?").execute({offerId}); },
+	    marketOffersKey);
 }
 
 void IOMarket::appendHistory(uint32_t playerId, MarketAction_t type, uint16_t itemId, uint16_t amount, uint64_t price,
                              time_t timestamp, MarketOfferState_t state)
 {
-	g_databaseTasks.addTask(fmt::format(
-	    "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES ({:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d}, {:d})",
-	    playerId, type, itemId, amount, price, timestamp, time(nullptr), state));
+	if (state == OFFERSTATE_ACCEPTED) {
+		getInstance().addStatistics(type, itemId, price);
+	}
+
+	addMarketTask(
+	    [=, inserted = time(nullptr)](Database& db) {
+		    db.prepare(
+		          "INSERT INTO `market_history` (`player_id`, `sale`, `itemtype`, `amount`, `price`, `expires_at`, `inserted`, `state`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)")
+		        .execute({playerId, static_cast<uint8_t>(type), itemId, amount, price, timestamp, inserted,
+		                  static_cast<uint8_t>(state)});
+	    },
+	    marketHistoryKey);
 }
 
 bool IOMarket::moveOfferToHistory(uint32_t offerId, MarketOfferState_t state)
 {
-	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
-
-	Database& db = Database::getInstance();
-
-	DBResult_ptr result = db.storeQuery(fmt::format(
-	    "SELECT `player_id`, `sale`, `itemtype`, `amount`, `price`, `created` FROM `market_offers` WHERE `id` = {:d}",
-	    offerId));
-	if (!result) {
+	MarketOrder offer;
+	if (!getInstance().removeOffer(offerId, &offer)) {
 		return false;
 	}
 
-	if (!db.executeQuery(fmt::format("DELETE FROM `market_offers` WHERE `id` = {:d}", offerId))) {
-		return false;
-	}
+	addMarketTask(
+	    [offerId](Database& db) { db.prepare("DELETE FROM `market_offers` WHERE `id` = ?").execute({offerId}); },
+	    marketOffersKey);
 
-	appendHistory(
-	    result->getNumber<uint32_t>("player_id"), static_cast<MarketAction_t>(result->getNumber<uint16_t>("sale")),
-	    result->getNumber<uint16_t>("itemtype"), result->getNumber<uint16_t>("amount"),
-	    result->getNumber<uint64_t>("price"), result->getNumber<uint32_t>("created") + marketOfferDuration, state);
+	const int32_t marketOfferDuration = g_config.getNumber(ConfigManager::MARKET_OFFER_DURATION);
+	appendHistory(offer.playerId, offer.type, offer.itemId, offer.amount, offer.price,
+	              offer.created + marketOfferDuration, state);
 	return true;
 }
 
@@ -311,6 +518,17 @@ void IOMarket::updateStatistics()
 	} while (result->next());
 }
 
+void IOMarket::addStatistics(MarketAction_t type, uint16_t itemId, uint64_t price)
+{
+	MarketStatistics& statistics = type == MARKETACTION_BUY ? purchaseStatistics[itemId] : saleStatistics[itemId];
+	if (statistics.numTransactions == 0 || price < statistics.lowestPrice) {
+		statistics.lowestPrice = price;
+	}
+	statistics.highestPrice = std::max<uint64_t>(statistics.highestPrice, price);
+	statistics.totalPrice += price;
+	++statistics.numTransactions;
+}
+
 MarketStatistics* IOMarket::getPurchaseStatistics(uint16_t itemId)
 {
 	auto it = purchaseStatistics.find(itemId);
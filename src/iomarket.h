@@ -7,6 +7,30 @@
 #include "database.h"
 #include "enums.h"
 
+class Item;
+class ItemType;
+class Player;
+
+struct MarketOrder
+{
+	uint32_t id;
+	uint32_t playerId;
+	uint32_t accountId;
+	uint32_t created;
+	uint64_t price;
+	uint16_t itemId;
+	uint16_t amount;
+	MarketAction_t type;
+	bool anonymous;
+	std::string playerName;
+};
+
+/**
+ * Keeps every active market offer in memory, indexed by item, owner and
+ * client counter, so that browsing and accepting offers never waits for
+ * the database. The book is loaded once at startup and every change to it
+ * is written behind on the database task workers, in the order it was made.
+ */
 class IOMarket
 {
 public:
@@ -16,18 +40,37 @@ public:
 		return instance;
 	}
 
+	static void loadOffers();
+
 	static MarketOfferList getActiveOffers(MarketAction_t action, uint16_t itemId);
 	static MarketOfferList getOwnOffers(MarketAction_t action, uint32_t playerId);
-	static HistoryMarketOfferList getOwnHistory(MarketAction_t action, uint32_t playerId);
 
-	static void processExpiredOffers(DBResult_ptr result, bool);
+	/**
+	 * Reads the history of a player on a database task worker and calls back
+	 * on the dispatcher thread with the buy and the sell history.
+	 */
+	static void getOwnHistory(uint32_t playerId,
+	                          std::function<void(HistoryMarketOfferList&&, HistoryMarketOfferList&&)> callback);
+
+	/**
+	 * Creates the items an offer of the given amount is made of and passes
+	 * them to add, which takes ownership and returns false to stop.
+	 */
+	static void createOfferItems(const ItemType& itemType, uint16_t amount, const std::function<bool(Item*)>& add);
+
+	/**
+	 * Moves expired offers to the history and returns their items or money
+	 * to the owners, as many as fit in the time budget of a tick, and
+	 * continues with the rest on the next tick.
+	 */
+	static void processExpiredOffers(std::vector<uint32_t> offerIds);
 	static void checkExpiredOffers();
 
 	static uint32_t getPlayerOfferCount(uint32_t playerId);
 	static MarketOfferEx getOfferByCounter(uint32_t timestamp, uint16_t counter);
 
-	static void createOffer(uint32_t playerId, MarketAction_t action, uint32_t itemId, uint16_t amount, uint64_t price,
-	                        bool anonymous);
+	static void createOffer(const Player& player, MarketAction_t action, uint16_t itemId, uint16_t amount,
+	                        uint64_t price, bool anonymous);
 	static void acceptOffer(uint32_t offerId, uint16_t amount);
 	static void deleteOffer(uint32_t offerId);
 
@@ -43,6 +86,21 @@ public:
 private:
 	IOMarket() = default;
 
+	void addOffer(MarketOrder&& offer);
+	bool removeOffer(uint32_t offerId, MarketOrder* removed = nullptr);
+	void addStatistics(MarketAction_t type, uint16_t itemId, uint64_t price);
+
+	static uint64_t getCounterKey(uint32_t created, uint16_t counter) { return (uint64_t{created} << 16) | counter; }
+
+	std::unordered_map<uint32_t, MarketOrder> offers;
+
+	// ids by price for each item, indexed by MarketAction_t
+	std::unordered_map<uint16_t, std::array<std::set<std::pair<uint64_t, uint32_t>>, 2>> itemOffers;
+	std::unordered_map<uint32_t, std::set<uint32_t>> playerOffers;
+	std::unordered_map<uint64_t, uint32_t> counterOffers;
+	std::set<std::pair<uint32_t, uint32_t>> offersByCreation;
+	uint32_t nextOfferId = 1;
+
 	std::map<uint16_t, MarketStatistics> purchaseStatistics;
 	std::map<uint16_t, MarketStatistics> saleStatistics;
 };
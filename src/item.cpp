@@ -23,6 +23,24 @@ extern Vocations g_vocations;
 
 Items Item::items;
 
+namespace {
+
+thread_local std::vector<Item*>* deferredUniqueItems = nullptr;
+thread_local std::vector<Item*>* deferredDecayItems = nullptr;
+
+} // namespace
+
+DeferUniqueIds::DeferUniqueIds(std::vector<Item*>& items) : previous(deferredUniqueItems)
+{
+	deferredUniqueItems = &items;
+}
+
+DeferUniqueIds::~DeferUniqueIds() { deferredUniqueItems = previous; }
+
+DeferDecay::DeferDecay(std::vector<Item*>& items) : previous(deferredDecayItems) { deferredDecayItems = &items; }
+
+DeferDecay::~DeferDecay() { deferredDecayItems = previous; }
+
 Item* Item::CreateItem(const uint16_t type, uint16_t count /*= 0*/)
 {
 	Item* newItem = nullptr;
@@ -182,27 +200,22 @@ bool Item::equals(const Item* otherItem) const
 		return false;
 	}
 
+	// both lists are ordered by type, the same bits give the same types at the same positions
 	const auto& attributeList = attributes->attributes;
 	const auto& otherAttributeList = otherAttributes->attributes;
-	for (const auto& attribute : attributeList) {
+	for (size_t i = 0, size = attributeList.size(); i < size; ++i) {
+		const auto& attribute = attributeList[i];
+		const auto& otherAttribute = otherAttributeList[i];
 		if (ItemAttributes::isIntAttrType(attribute.type)) {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && attribute.value.integer != otherAttribute.value.integer) {
-					return false;
-				}
+			if (attribute.value.integer != otherAttribute.value.integer) {
+				return false;
 			}
 		} else if (ItemAttributes::isStrAttrType(attribute.type)) {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && *attribute.value.string != *otherAttribute.value.string) {
-					return false;
-				}
-			}
-		} else {
-			for (const auto& otherAttribute : otherAttributeList) {
-				if (attribute.type == otherAttribute.type && *attribute.value.custom != *otherAttribute.value.custom) {
-					return false;
-				}
+			if (*attribute.value.string != *otherAttribute.value.string) {
+				return false;
 			}
+		} else if (*attribute.value.custom != *otherAttribute.value.custom) {
+			return false;
 		}
 	}
 	return true;
@@ -311,6 +324,20 @@ const Tile* Item::getTile() const
 	return dynamic_cast<const Tile*>(cylinder);
 }
 
+void Item::setHouseItemsChanged()
+{
+	// the tile of a carried item is the tile of its holder, which is not a house item
+	if (getTopParent()->getCreature()) {
+		return;
+	}
+
+	if (Tile* tile = getTile()) {
+		if (House* house = tile->getHouse()) {
+			house->setItemsChanged();
+		}
+	}
+}
+
 uint16_t Item::getSubType() const
 {
 	const ItemType& it = items[id];
@@ -611,7 +638,7 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream)
 					return ATTR_READ_ERROR;
 				}
 
-				getAttributes()->reflect[combatType] = reflect;
+				getAttributes()->getCombatAttributes().reflect[combatType] = reflect;
 			}
 			break;
 		}
@@ -630,7 +657,7 @@ Attr_ReadValue Item::readAttr(AttrTypes_t attr, PropStream& propStream)
 					return ATTR_READ_ERROR;
 				}
 
-				getAttributes()->boostPercent[combatType] = percent;
+				getAttributes()->getCombatAttributes().boostPercent[combatType] = percent;
 			}
 			break;
 		}
@@ -885,8 +912,8 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 		}
 	}
 
-	if (attributes) {
-		const auto& reflects = attributes->reflect;
+	if (attributes && attributes->combatAttributes) {
+		const auto& reflects = attributes->combatAttributes->reflect;
 		if (!reflects.empty()) {
 			propWriteStream.write<uint8_t>(ATTR_REFLECT);
 			propWriteStream.write<uint16_t>(reflects.size());
@@ -898,7 +925,7 @@ void Item::serializeAttr(PropWriteStream& propWriteStream) const
 			}
 		}
 
-		const auto& boosts = attributes->boostPercent;
+		const auto& boosts = attributes->combatAttributes->boostPercent;
 		if (!boosts.empty()) {
 			propWriteStream.write<uint8_t>(ATTR_BOOST);
 			propWriteStream.write<uint16_t>(boosts.size());
@@ -1045,11 +1072,26 @@ void Item::setUniqueId(uint16_t n)
 		return;
 	}
 
+	if (deferredUniqueItems) {
+		getAttributes()->setUniqueId(n);
+		deferredUniqueItems->push_back(this);
+		return;
+	}
+
 	if (g_game.addUniqueItem(n, this)) {
 		getAttributes()->setUniqueId(n);
 	}
 }
 
+void Item::registerUniqueIds(const std::vector<Item*>& items)
+{
+	for (Item* item : items) {
+		if (!g_game.addUniqueItem(item->getUniqueId(), item)) {
+			item->removeAttribute(ITEM_ATTRIBUTE_UNIQUEID);
+		}
+	}
+}
+
 bool Item::canDecay() const
 {
 	if (isRemoved()) {
@@ -1128,7 +1170,7 @@ const std::string& ItemAttributes::getStrAttr(itemAttrTypes type) const
 
 void ItemAttributes::setStrAttr(itemAttrTypes type, const std::string& value)
 {
-	if (!isStrAttrType(type)) {
+	if (!isStrAttrType(type) || !isSingleAttrType(type)) {
 		return;
 	}
 
@@ -1143,23 +1185,11 @@ void ItemAttributes::setStrAttr(itemAttrTypes type, const std::string& value)
 
 void ItemAttributes::removeAttribute(itemAttrTypes type)
 {
-	if (!hasAttribute(type)) {
+	if (!hasAttribute(type) || !isSingleAttrType(type)) {
 		return;
 	}
 
-	auto prev_it = attributes.rbegin();
-	if ((*prev_it).type == type) {
-		attributes.pop_back();
-	} else {
-		auto it = prev_it, end = attributes.rend();
-		while (++it != end) {
-			if ((*it).type == type) {
-				(*it) = attributes.back();
-				attributes.pop_back();
-				break;
-			}
-		}
-	}
+	attributes.erase(attributes.begin() + getAttrIndex(type));
 	attributeBits &= ~type;
 }
 
@@ -1178,7 +1208,7 @@ int64_t ItemAttributes::getIntAttr(itemAttrTypes type) const
 
 void ItemAttributes::setIntAttr(itemAttrTypes type, int64_t value)
 {
-	if (!isIntAttrType(type)) {
+	if (!isIntAttrType(type) || !isSingleAttrType(type)) {
 		return;
 	}
 
@@ -1193,32 +1223,39 @@ void ItemAttributes::increaseIntAttr(itemAttrTypes type, int64_t value) { setInt
 
 const ItemAttributes::Attribute* ItemAttributes::getExistingAttr(itemAttrTypes type) const
 {
-	if (hasAttribute(type)) {
-		for (const Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return &attribute;
-			}
-		}
+	if (!hasAttribute(type) || !isSingleAttrType(type)) {
+		return nullptr;
 	}
-	return nullptr;
+	return &attributes[getAttrIndex(type)];
 }
 
 ItemAttributes::Attribute& ItemAttributes::getAttr(itemAttrTypes type)
 {
+	auto it = attributes.begin() + getAttrIndex(type);
 	if (hasAttribute(type)) {
-		for (Attribute& attribute : attributes) {
-			if (attribute.type == type) {
-				return attribute;
-			}
-		}
+		return *it;
 	}
 
 	attributeBits |= type;
-	attributes.emplace_back(type);
-	return attributes.back();
+	return *attributes.emplace(it, type);
+}
+
+void Item::startDecaying()
+{
+	if (deferredDecayItems) {
+		deferredDecayItems->push_back(this);
+		return;
+	}
+
+	g_game.startDecay(this);
 }
 
-void Item::startDecaying() { g_game.startDecay(this); }
+void Item::startDecays(const std::vector<Item*>& items)
+{
+	for (Item* item : items) {
+		g_game.startDecay(item);
+	}
+}
 
 bool Item::hasMarketAttributes() const
 {
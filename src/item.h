@@ -102,10 +102,25 @@ enum Attr_ReadValue
 	ATTR_READ_END,
 };
 
+/**
+ * The attributes of an item that differ from its type.
+ *
+ * The attributes are kept ordered by type, so that an attribute is found by
+ * counting the present types below it. The reflect and boost attributes, set
+ * by few items, are allocated on their first use.
+ */
 class ItemAttributes
 {
 public:
 	ItemAttributes() = default;
+	ItemAttributes(const ItemAttributes& other) :
+	    attributes(other.attributes),
+	    attributeBits(other.attributeBits),
+	    combatAttributes(other.combatAttributes ? new CombatAttributes(*other.combatAttributes) : nullptr)
+	{}
+
+	// non-assignable
+	ItemAttributes& operator=(const ItemAttributes&) = delete;
 
 	void setSpecialDescription(const std::string& desc) { setStrAttr(ITEM_ATTRIBUTE_DESCRIPTION, desc); }
 	const std::string& getSpecialDescription() const { return getStrAttr(ITEM_ATTRIBUTE_DESCRIPTION); }
@@ -308,7 +323,7 @@ private:
 				memset(&value, 0, sizeof(value));
 			}
 		}
-		Attribute(Attribute&& attribute) : value(attribute.value), type(attribute.type)
+		Attribute(Attribute&& attribute) noexcept : value(attribute.value), type(attribute.type)
 		{
 			memset(&attribute.value, 0, sizeof(value));
 			attribute.type = ITEM_ATTRIBUTE_NONE;
@@ -321,12 +336,13 @@ private:
 				delete value.custom;
 			}
 		}
-		Attribute& operator=(Attribute other)
+		Attribute& operator=(const Attribute& other)
 		{
-			Attribute::swap(*this, other);
+			Attribute tmp(other);
+			Attribute::swap(*this, tmp);
 			return *this;
 		}
-		Attribute& operator=(Attribute&& other)
+		Attribute& operator=(Attribute&& other) noexcept
 		{
 			if (this != &other) {
 				if (ItemAttributes::isStrAttrType(type)) {
@@ -351,21 +367,42 @@ private:
 		}
 	};
 
+	struct CombatAttributes
+	{
+		std::map<CombatType_t, Reflect> reflect;
+		std::map<CombatType_t, uint16_t> boostPercent;
+	};
+
 	std::vector<Attribute> attributes;
 	uint32_t attributeBits = 0;
 
-	std::map<CombatType_t, Reflect> reflect;
-	std::map<CombatType_t, uint16_t> boostPercent;
+	std::unique_ptr<CombatAttributes> combatAttributes;
+
+	CombatAttributes& getCombatAttributes()
+	{
+		if (!combatAttributes) {
+			combatAttributes.reset(new CombatAttributes());
+		}
+		return *combatAttributes;
+	}
 
 	const Reflect& getReflect(CombatType_t combatType)
 	{
-		auto it = reflect.find(combatType);
-		return it != reflect.end() ? it->second : emptyReflect;
+		if (!combatAttributes) {
+			return emptyReflect;
+		}
+
+		auto it = combatAttributes->reflect.find(combatType);
+		return it != combatAttributes->reflect.end() ? it->second : emptyReflect;
 	}
 	int16_t getBoostPercent(CombatType_t combatType)
 	{
-		auto it = boostPercent.find(combatType);
-		return it != boostPercent.end() ? it->second : 0;
+		if (!combatAttributes) {
+			return 0;
+		}
+
+		auto it = combatAttributes->boostPercent.find(combatType);
+		return it != combatAttributes->boostPercent.end() ? it->second : 0;
 	}
 
 	const std::string& getStrAttr(itemAttrTypes type) const;
@@ -375,6 +412,9 @@ private:
 	void setIntAttr(itemAttrTypes type, int64_t value);
 	void increaseIntAttr(itemAttrTypes type, int64_t value);
 
+	static bool isSingleAttrType(itemAttrTypes type) { return type != ITEM_ATTRIBUTE_NONE && (type & (type - 1)) == 0; }
+	size_t getAttrIndex(itemAttrTypes type) const { return std::bitset<32>(attributeBits & (type - 1)).count(); }
+
 	const Attribute* getExistingAttr(itemAttrTypes type) const;
 	Attribute& getAttr(itemAttrTypes type);
 
@@ -794,10 +834,16 @@ public:
 	uint32_t getWorth() const;
 	LightInfo getLightInfo() const;
 
-	void setReflect(CombatType_t combatType, const Reflect& reflect) { getAttributes()->reflect[combatType] = reflect; }
+	void setReflect(CombatType_t combatType, const Reflect& reflect)
+	{
+		getAttributes()->getCombatAttributes().reflect[combatType] = reflect;
+	}
 	Reflect getReflect(CombatType_t combatType, bool total = true) const;
 
-	void setBoostPercent(CombatType_t combatType, uint16_t value) { getAttributes()->boostPercent[combatType] = value; }
+	void setBoostPercent(CombatType_t combatType, uint16_t value)
+	{
+		getAttributes()->getCombatAttributes().boostPercent[combatType] = value;
+	}
 	uint16_t getBoostPercent(CombatType_t combatType, bool total = true) const;
 
 	bool hasProperty(ITEMPROPERTY prop) const;
@@ -867,6 +913,8 @@ public:
 	void setSubType(uint16_t n);
 
 	void setUniqueId(uint16_t n);
+	static void registerUniqueIds(const std::vector<Item*>& items);
+	static void startDecays(const std::vector<Item*>& items);
 
 	void setDefaultDuration()
 	{
@@ -917,6 +965,10 @@ public:
 	const Cylinder* getTopParent() const;
 	Tile* getTile() override;
 	const Tile* getTile() const override;
+
+	// marks the house the item lies in as changed, for changes the tile and its containers are not told about
+	void setHouseItemsChanged();
+
 	bool isRemoved() const override { return !parent || parent->isRemoved(); }
 
 protected:
@@ -939,6 +991,46 @@ private:
 };
 
 using ItemList = std::list<Item*>;
-using ItemDeque = std::deque<Item*>;
+// most containers hold a few items, which are kept inline without allocating
+using ContainerItemVector = boost::container::small_vector<Item*, 8>;
+
+/**
+ * Unique ids are registered in Game, which only the dispatcher thread may
+ * do. While an instance is alive, items read on its thread keep their unique
+ * id unregistered and are collected, to be registered by
+ * Item::registerUniqueIds on the dispatcher.
+ */
+class DeferUniqueIds
+{
+public:
+	explicit DeferUniqueIds(std::vector<Item*>& items);
+	~DeferUniqueIds();
+
+	// non-copyable
+	DeferUniqueIds(const DeferUniqueIds&) = delete;
+	DeferUniqueIds& operator=(const DeferUniqueIds&) = delete;
+
+private:
+	std::vector<Item*>* previous;
+};
+
+/**
+ * The decaying items are queued in Game, which only the dispatcher thread may
+ * do. While an instance is alive, items started decaying on its thread are
+ * collected instead, to be queued by Item::startDecays on the dispatcher.
+ */
+class DeferDecay
+{
+public:
+	explicit DeferDecay(std::vector<Item*>& items);
+	~DeferDecay();
+
+	// non-copyable
+	DeferDecay(const DeferDecay&) = delete;
+	DeferDecay& operator=(const DeferDecay&) = delete;
+
+private:
+	std::vector<Item*>* previous;
+};
 
 #endif // FS_ITEM_H
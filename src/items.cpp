@@ -602,8 +602,6 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 		it.pluralName = pluralAttribute.as_string();
 	}
 
-	Abilities& abilities = it.getAbilities();
-
 	for (auto attributeNode : itemNode.children()) {
 		pugi::xml_attribute keyAttribute = attributeNode.attribute("key");
 		if (!keyAttribute) {
@@ -917,162 +915,166 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 				}
 
 				case ITEM_PARSE_INVISIBLE: {
-					abilities.invisible = valueAttribute.as_bool();
+					it.getAbilities().invisible = valueAttribute.as_bool();
 					break;
 				}
 
 				case ITEM_PARSE_SPEED: {
-					abilities.speed = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().speed = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_HEALTHGAIN: {
-					abilities.regeneration = true;
-					abilities.healthGain = pugi::cast<uint32_t>(valueAttribute.value());
+					it.getAbilities().regeneration = true;
+					it.getAbilities().healthGain = pugi::cast<uint32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_HEALTHTICKS: {
-					abilities.regeneration = true;
-					abilities.healthTicks = pugi::cast<uint32_t>(valueAttribute.value());
+					it.getAbilities().regeneration = true;
+					it.getAbilities().healthTicks = pugi::cast<uint32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MANAGAIN: {
-					abilities.regeneration = true;
-					abilities.manaGain = pugi::cast<uint32_t>(valueAttribute.value());
+					it.getAbilities().regeneration = true;
+					it.getAbilities().manaGain = pugi::cast<uint32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MANATICKS: {
-					abilities.regeneration = true;
-					abilities.manaTicks = pugi::cast<uint32_t>(valueAttribute.value());
+					it.getAbilities().regeneration = true;
+					it.getAbilities().manaTicks = pugi::cast<uint32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MANASHIELD: {
-					abilities.manaShield = valueAttribute.as_bool();
+					it.getAbilities().manaShield = valueAttribute.as_bool();
 					break;
 				}
 
 				case ITEM_PARSE_SKILLSWORD: {
-					abilities.skills[SKILL_SWORD] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_SWORD] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLAXE: {
-					abilities.skills[SKILL_AXE] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_AXE] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLCLUB: {
-					abilities.skills[SKILL_CLUB] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_CLUB] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLDIST: {
-					abilities.skills[SKILL_DISTANCE] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_DISTANCE] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLFISH: {
-					abilities.skills[SKILL_FISHING] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_FISHING] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLSHIELD: {
-					abilities.skills[SKILL_SHIELD] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_SHIELD] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SKILLFIST: {
-					abilities.skills[SKILL_FIST] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().skills[SKILL_FIST] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_CRITICALHITAMOUNT: {
-					abilities.specialSkills[SPECIALSKILL_CRITICALHITAMOUNT] =
+					it.getAbilities().specialSkills[SPECIALSKILL_CRITICALHITAMOUNT] =
 					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_CRITICALHITCHANCE: {
-					abilities.specialSkills[SPECIALSKILL_CRITICALHITCHANCE] =
+					it.getAbilities().specialSkills[SPECIALSKILL_CRITICALHITCHANCE] =
 					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MANALEECHAMOUNT: {
-					abilities.specialSkills[SPECIALSKILL_MANALEECHAMOUNT] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().specialSkills[SPECIALSKILL_MANALEECHAMOUNT] =
+					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MANALEECHCHANCE: {
-					abilities.specialSkills[SPECIALSKILL_MANALEECHCHANCE] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().specialSkills[SPECIALSKILL_MANALEECHCHANCE] =
+					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_LIFELEECHAMOUNT: {
-					abilities.specialSkills[SPECIALSKILL_LIFELEECHAMOUNT] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().specialSkills[SPECIALSKILL_LIFELEECHAMOUNT] =
+					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_LIFELEECHCHANCE: {
-					abilities.specialSkills[SPECIALSKILL_LIFELEECHCHANCE] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().specialSkills[SPECIALSKILL_LIFELEECHCHANCE] =
+					    pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAXHITPOINTS: {
-					abilities.stats[STAT_MAXHITPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().stats[STAT_MAXHITPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAXHITPOINTSPERCENT: {
-					abilities.statsPercent[STAT_MAXHITPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().statsPercent[STAT_MAXHITPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAXMANAPOINTS: {
-					abilities.stats[STAT_MAXMANAPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().stats[STAT_MAXMANAPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAXMANAPOINTSPERCENT: {
-					abilities.statsPercent[STAT_MAXMANAPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().statsPercent[STAT_MAXMANAPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICPOINTS: {
-					abilities.stats[STAT_MAGICPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().stats[STAT_MAGICPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICPOINTSPERCENT: {
-					abilities.statsPercent[STAT_MAGICPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
+					it.getAbilities().statsPercent[STAT_MAGICPOINTS] = pugi::cast<int32_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_FIELDABSORBPERCENTENERGY: {
-					abilities.fieldAbsorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
+					it.getAbilities().fieldAbsorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_FIELDABSORBPERCENTFIRE: {
-					abilities.fieldAbsorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
+					it.getAbilities().fieldAbsorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_FIELDABSORBPERCENTPOISON: {
-					abilities.fieldAbsorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
+					it.getAbilities().fieldAbsorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTALL: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					for (auto& i : abilities.absorbPercent) {
+					for (auto& i : it.getAbilities().absorbPercent) {
 						i += value;
 					}
 					break;
@@ -1080,99 +1082,99 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 
 				case ITEM_PARSE_ABSORBPERCENTELEMENTS: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTMAGIC: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] += value;
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] += value;
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] += value;
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTENERGY: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTFIRE: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTPOISON: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTICE: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTHOLY: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTDEATH: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTLIFEDRAIN: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTMANADRAIN: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_MANADRAIN)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_MANADRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTDROWN: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTPHYSICAL: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTHEALING: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_HEALING)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_HEALING)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_ABSORBPERCENTUNDEFINED: {
-					abilities.absorbPercent[combatTypeToIndex(COMBAT_UNDEFINEDDAMAGE)] +=
+					it.getAbilities().absorbPercent[combatTypeToIndex(COMBAT_UNDEFINEDDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTALL: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					for (auto& i : abilities.reflect) {
+					for (auto& i : it.getAbilities().reflect) {
 						i.percent += value;
 					}
 					break;
@@ -1180,93 +1182,93 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 
 				case ITEM_PARSE_REFLECTPERCENTELEMENTS: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent += value;
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTMAGIC: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].percent += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].percent += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].percent += value;
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTENERGY: {
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTFIRE: {
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTEARTH: {
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTICE: {
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTHOLY: {
-					abilities.reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTDEATH: {
-					abilities.reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTLIFEDRAIN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_LIFEDRAIN)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_LIFEDRAIN)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTMANADRAIN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_MANADRAIN)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_MANADRAIN)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTDROWN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_DROWNDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DROWNDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTPHYSICAL: {
-					abilities.reflect[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTPERCENTHEALING: {
-					abilities.reflect[combatTypeToIndex(COMBAT_HEALING)].percent +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HEALING)].percent +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEALL: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					for (auto& i : abilities.reflect) {
+					for (auto& i : it.getAbilities().reflect) {
 						i.chance += value;
 					}
 					break;
@@ -1274,93 +1276,93 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 
 				case ITEM_PARSE_REFLECTCHANCEELEMENTS: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance += value;
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEMAGIC: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].chance += value;
-					abilities.reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].chance += value;
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].chance += value;
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEENERGY: {
-					abilities.reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ENERGYDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEFIRE: {
-					abilities.reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_FIREDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEEARTH: {
-					abilities.reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_EARTHDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEICE: {
-					abilities.reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_ICEDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEHOLY: {
-					abilities.reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HOLYDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEDEATH: {
-					abilities.reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DEATHDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCELIFEDRAIN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_LIFEDRAIN)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_LIFEDRAIN)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEMANADRAIN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_MANADRAIN)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_MANADRAIN)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEDROWN: {
-					abilities.reflect[combatTypeToIndex(COMBAT_DROWNDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_DROWNDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEPHYSICAL: {
-					abilities.reflect[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_REFLECTCHANCEHEALING: {
-					abilities.reflect[combatTypeToIndex(COMBAT_HEALING)].chance +=
+					it.getAbilities().reflect[combatTypeToIndex(COMBAT_HEALING)].chance +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTALL: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					for (auto& i : abilities.boostPercent) {
+					for (auto& i : it.getAbilities().boostPercent) {
 						i += value;
 					}
 					break;
@@ -1368,221 +1370,221 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 
 				case ITEM_PARSE_BOOSTPERCENTELEMENTS: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTMAGIC: {
 					int16_t value = pugi::cast<int16_t>(valueAttribute.value());
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] += value;
-					abilities.boostPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] += value;
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] += value;
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTENERGY: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTFIRE: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTEARTH: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTICE: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTHOLY: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTDEATH: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTLIFEDRAIN: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTMANADRAIN: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_MANADRAIN)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_MANADRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTDROWN: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTPHYSICAL: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_BOOSTPERCENTHEALING: {
-					abilities.boostPercent[combatTypeToIndex(COMBAT_HEALING)] +=
+					it.getAbilities().boostPercent[combatTypeToIndex(COMBAT_HEALING)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELENERGY: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_ENERGYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELFIRE: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_FIREDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELPOISON: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_EARTHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELICE: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_ICEDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELHOLY: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_HOLYDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELDEATH: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_DEATHDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELLIFEDRAIN: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_LIFEDRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELMANADRAIN: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_MANADRAIN)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_MANADRAIN)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELDROWN: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_DROWNDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELPHYSICAL: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_PHYSICALDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELHEALING: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_HEALING)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_HEALING)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_MAGICLEVELUNDEFINED: {
-					abilities.specialMagicLevelSkill[combatTypeToIndex(COMBAT_UNDEFINEDDAMAGE)] +=
+					it.getAbilities().specialMagicLevelSkill[combatTypeToIndex(COMBAT_UNDEFINEDDAMAGE)] +=
 					    pugi::cast<int16_t>(valueAttribute.value());
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSDRUNK: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_DRUNK;
+						it.getAbilities().conditionSuppressions |= CONDITION_DRUNK;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSENERGY: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_ENERGY;
+						it.getAbilities().conditionSuppressions |= CONDITION_ENERGY;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSFIRE: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_FIRE;
+						it.getAbilities().conditionSuppressions |= CONDITION_FIRE;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSPOISON: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_POISON;
+						it.getAbilities().conditionSuppressions |= CONDITION_POISON;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSDROWN: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_DROWN;
+						it.getAbilities().conditionSuppressions |= CONDITION_DROWN;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSPHYSICAL: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_BLEEDING;
+						it.getAbilities().conditionSuppressions |= CONDITION_BLEEDING;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSFREEZE: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_FREEZING;
+						it.getAbilities().conditionSuppressions |= CONDITION_FREEZING;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSDAZZLE: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_DAZZLED;
+						it.getAbilities().conditionSuppressions |= CONDITION_DAZZLED;
 					}
 					break;
 				}
 
 				case ITEM_PARSE_SUPPRESSCURSE: {
 					if (valueAttribute.as_bool()) {
-						abilities.conditionSuppressions |= CONDITION_CURSED;
+						it.getAbilities().conditionSuppressions |= CONDITION_CURSED;
 					}
 					break;
 				}
@@ -1733,38 +1735,38 @@ void Items::parseItemNode(const pugi::xml_node& itemNode, uint16_t id)
 				}
 
 				case ITEM_PARSE_ELEMENTICE: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_ICEDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_ICEDAMAGE;
 					break;
 				}
 
 				case ITEM_PARSE_ELEMENTEARTH: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_EARTHDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_EARTHDAMAGE;
 					break;
 				}
 
 				case ITEM_PARSE_ELEMENTFIRE: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_FIREDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_FIREDAMAGE;
 					break;
 				}
 
 				case ITEM_PARSE_ELEMENTENERGY: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_ENERGYDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_ENERGYDAMAGE;
 					break;
 				}
 
 				case ITEM_PARSE_ELEMENTDEATH: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_DEATHDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_DEATHDAMAGE;
 					break;
 				}
 
 				case ITEM_PARSE_ELEMENTHOLY: {
-					abilities.elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
-					abilities.elementType = COMBAT_HOLYDAMAGE;
+					it.getAbilities().elementDamage = pugi::cast<uint16_t>(valueAttribute.value());
+					it.getAbilities().elementType = COMBAT_HOLYDAMAGE;
 					break;
 				}
 
@@ -317,13 +317,47 @@ public:
 		return str;
 	}
 
+	// read by the checks made for every item moved or walked on, kept together at the start
 	itemgroup_t group = ITEM_GROUP_NONE;
 	ItemTypes_t type = ITEM_TYPE_NONE;
 	uint16_t id = 0;
 	uint16_t clientId = 0;
+
+	uint32_t weight = 0;
+	uint32_t charges = 0;
+
+	uint16_t slotPosition = SLOTP_HAND;
+	uint16_t maxItems = 8;
+	uint16_t wareId = 0;
+	uint16_t speed = 0;
+
+	uint8_t floorChange = 0;
+	uint8_t alwaysOnTopOrder = 0;
+	uint8_t lightLevel = 0;
+	uint8_t lightColor = 0;
+
 	bool stackable = false;
 	bool isAnimation = false;
+	bool blockSolid = false;
+	bool blockPickupable = false;
+	bool blockProjectile = false;
+	bool blockPathFind = false;
+	bool allowPickupable = false;
+	bool pickupable = false;
+	bool moveable = false;
+	bool alwaysOnTop = false;
+	bool hasHeight = false;
+	bool walkStack = true;
+	bool replaceable = true;
+	bool useable = false;
+	bool rotatable = false;
+	bool forceUse = false;
+	bool isVertical = false;
+	bool isHorizontal = false;
+	bool isHangable = false;
+	bool lookThrough = false;
 
+	// read by descriptions, fights and scripts
 	std::string name;
 	std::string article;
 	std::string pluralName;
@@ -335,13 +369,11 @@ public:
 	std::unique_ptr<ConditionDamage> conditionDamage;
 
 	uint32_t attackSpeed = 0;
-	uint32_t weight = 0;
 	uint32_t levelDoor = 0;
 	uint32_t decayTime = 0;
 	uint32_t wieldInfo = 0;
 	uint32_t minReqLevel = 0;
 	uint32_t minReqMagicLevel = 0;
-	uint32_t charges = 0;
 	int32_t maxHitChance = -1;
 	int32_t decayTo = -1;
 	int32_t attack = 0;
@@ -362,10 +394,6 @@ public:
 	uint16_t writeOnceItemId = 0;
 	uint16_t transformEquipTo = 0;
 	uint16_t transformDeEquipTo = 0;
-	uint16_t maxItems = 8;
-	uint16_t slotPosition = SLOTP_HAND;
-	uint16_t speed = 0;
-	uint16_t wareId = 0;
 
 	MagicEffectClasses magicEffect = CONST_ME_NONE;
 	Direction bedPartnerDir = DIRECTION_NONE;
@@ -375,40 +403,18 @@ public:
 	RaceType_t corpseType = RACE_NONE;
 	FluidTypes_t fluidSource = FLUID_NONE;
 
-	uint8_t floorChange = 0;
-	uint8_t alwaysOnTopOrder = 0;
-	uint8_t lightLevel = 0;
-	uint8_t lightColor = 0;
 	uint8_t shootRange = 1;
 	uint8_t classification = 0;
 	int8_t hitChance = 0;
 
 	bool storeItem = false;
-	bool forceUse = false;
 	bool forceSerialize = false;
-	bool hasHeight = false;
-	bool walkStack = true;
-	bool blockSolid = false;
-	bool blockPickupable = false;
-	bool blockProjectile = false;
-	bool blockPathFind = false;
-	bool allowPickupable = false;
 	bool showDuration = false;
 	bool showCharges = false;
 	bool showAttributes = false;
-	bool replaceable = true;
-	bool pickupable = false;
-	bool rotatable = false;
-	bool useable = false;
-	bool moveable = false;
-	bool alwaysOnTop = false;
 	bool canReadText = false;
 	bool canWriteText = false;
-	bool isVertical = false;
-	bool isHorizontal = false;
-	bool isHangable = false;
 	bool allowDistRead = false;
-	bool lookThrough = false;
 	bool stopTime = false;
 	bool showCount = true;
 	bool supply = false;
@@ -0,0 +1,235 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "logintasks.h"
+
+#include "configmanager.h"
+#include "tasks.h"
+
+extern ConfigManager g_config;
+extern Dispatcher g_dispatcher;
+
+namespace {
+
+constexpr auto SLOW_LOGIN_THRESHOLD = std::chrono::seconds(1);
+
+uint64_t toMicros(std::chrono::steady_clock::duration duration)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+bool LoginTasks::start()
+{
+	int32_t workers = std::max<int32_t>(1, g_config.getNumber(ConfigManager::LOGIN_WORKER_THREADS));
+	for (int32_t i = 0; i < workers; ++i) {
+		auto db = std::make_unique<Database>();
+		if (!db->connect()) {
+			return false;
+		}
+		connections.push_back(std::move(db));
+	}
+
+	threadState.store(THREAD_STATE_RUNNING, std::memory_order_relaxed);
+	for (auto& db : connections) {
+		threads.emplace_back(&LoginTasks::threadMain, this, std::ref(*db));
+	}
+	return true;
+}
+
+void LoginTasks::threadMain(Database& db)
+{
+	std::unique_lock<std::mutex> taskLockUnique(taskLock, std::defer_lock);
+	while (threadState.load(std::memory_order_relaxed) != THREAD_STATE_TERMINATED) {
+		taskLockUnique.lock();
+		if (tasks.empty()) {
+			taskSignal.wait(taskLockUnique);
+		}
+
+		if (!tasks.empty()) {
+			LoginTask task = std::move(tasks.front());
+			tasks.pop_front();
+			taskLockUnique.unlock();
+			runTask(db, task);
+		} else {
+			taskLockUnique.unlock();
+		}
+	}
+}
+
+bool LoginTasks::addTask(std::function<void(Database&)> load, std::function<void(void)> finish)
+{
+	const size_t maxQueueSize = std::max<int32_t>(0, g_config.getNumber(ConfigManager::LOGIN_QUEUE_SIZE));
+
+	std::unique_lock<std::mutex> guard{taskLock};
+	if (threadState.load(std::memory_order_relaxed) != THREAD_STATE_RUNNING ||
+	    (maxQueueSize != 0 && tasks.size() >= maxQueueSize)) {
+		guard.unlock();
+
+		std::lock_guard<std::mutex> statsGuard{statsLock};
+		++stats.rejected;
+		return false;
+	}
+
+	tasks.emplace_back(std::move(load), std::move(finish));
+	guard.unlock();
+
+	taskSignal.notify_one();
+	return true;
+}
+
+void LoginTasks::runTask(Database& db, LoginTask& task)
+{
+	const auto loadStart = std::chrono::steady_clock::now();
+	addStageTime(LOGIN_STAGE_QUEUE, loadStart - task.queuedAt);
+
+	{
+		std::shared_lock<std::shared_mutex> loadGuard{loadLock};
+		task.load(db);
+	}
+
+	const auto loadEnd = std::chrono::steady_clock::now();
+	addStageTime(LOGIN_STAGE_LOAD, loadEnd - loadStart);
+
+	g_dispatcher.addTask([this, queuedAt = task.queuedAt, loadStart, loadEnd, finish = std::move(task.finish)]() {
+		finish();
+
+		const auto now = std::chrono::steady_clock::now();
+		addStageTime(LOGIN_STAGE_PLACE, now - loadEnd);
+
+		if (now - queuedAt > SLOW_LOGIN_THRESHOLD) {
+			std::cout << "[Warning - LoginTasks::runTask] Slow login: queue " << toMicros(loadStart - queuedAt) / 1000
+			          << " ms, load " << toMicros(loadEnd - loadStart) / 1000 << " ms, place "
+			          << toMicros(now - loadEnd) / 1000 << " ms." << std::endl;
+		}
+	});
+}
+
+void LoginTasks::addStageTime(LoginStage_t stage, std::chrono::steady_clock::duration duration)
+{
+	const uint64_t micros = toMicros(duration);
+
+	std::lock_guard<std::mutex> statsGuard{statsLock};
+	LoginStageStats& stageStats = stats.stages[stage];
+	++stageStats.count;
+	stageStats.totalMicros += micros;
+	stageStats.maxMicros = std::max(stageStats.maxMicros, micros);
+}
+
+bool LoginTasks::beginOfflineWrite(uint32_t guid)
+{
+	std::lock_guard<std::mutex> guard{playerLock};
+	if (loadingPlayers.find(guid) != loadingPlayers.end()) {
+		return false;
+	}
+
+	++offlineWrites[guid];
+	return true;
+}
+
+void LoginTasks::endOfflineWrite(uint32_t guid)
+{
+	{
+		std::lock_guard<std::mutex> guard{playerLock};
+		auto it = offlineWrites.find(guid);
+		if (it != offlineWrites.end() && --it->second == 0) {
+			offlineWrites.erase(it);
+		}
+	}
+	playerSignal.notify_all();
+}
+
+void LoginTasks::beginLoad(uint32_t guid)
+{
+	std::unique_lock<std::mutex> guard{playerLock};
+	playerSignal.wait(guard, [this, guid]() { return offlineWrites.find(guid) == offlineWrites.end(); });
+	++loadingPlayers[guid];
+}
+
+void LoginTasks::endLoad(uint32_t guid)
+{
+	std::vector<std::function<void(void)>> callbacks;
+	{
+		std::lock_guard<std::mutex> guard{playerLock};
+		auto it = loadingPlayers.find(guid);
+		if (it != loadingPlayers.end() && --it->second == 0) {
+			loadingPlayers.erase(it);
+
+			auto callbacksIt = loadCallbacks.find(guid);
+			if (callbacksIt != loadCallbacks.end()) {
+				callbacks = std::move(callbacksIt->second);
+				loadCallbacks.erase(callbacksIt);
+			}
+		}
+	}
+
+	for (const auto& callback : callbacks) {
+		callback();
+	}
+}
+
+void LoginTasks::afterLoad(uint32_t guid, std::function<void(void)> callback)
+{
+	{
+		std::lock_guard<std::mutex> guard{playerLock};
+		if (loadingPlayers.find(guid) != loadingPlayers.end()) {
+			loadCallbacks[guid].push_back(std::move(callback));
+			return;
+		}
+	}
+
+	// the load already ended
+	callback();
+}
+
+void LoginTasks::addLoginItems(size_t items)
+{
+	std::lock_guard<std::mutex> statsGuard{statsLock};
+	stats.loginItems += items;
+}
+
+void LoginTasks::addDepotLoad(int64_t millis, size_t items)
+{
+	const uint64_t micros = std::max<int64_t>(0, millis) * 1000;
+
+	std::lock_guard<std::mutex> statsGuard{statsLock};
+	stats.depotItems += items;
+	++stats.depotLoads.count;
+	stats.depotLoads.totalMicros += micros;
+	stats.depotLoads.maxMicros = std::max(stats.depotLoads.maxMicros, micros);
+}
+
+LoginStats LoginTasks::getStats()
+{
+	LoginStats result;
+	{
+		std::lock_guard<std::mutex> statsGuard{statsLock};
+		result = stats;
+	}
+
+	std::lock_guard<std::mutex> guard{taskLock};
+	result.queueSize = tasks.size();
+	return result;
+}
+
+void LoginTasks::shutdown()
+{
+	{
+		std::lock_guard<std::mutex> guard{taskLock};
+		threadState.store(THREAD_STATE_TERMINATED, std::memory_order_relaxed);
+		tasks.clear();
+	}
+	taskSignal.notify_all();
+}
+
+void LoginTasks::join()
+{
+	for (std::thread& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+}
@@ -0,0 +1,153 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LOGINTASKS_H
+#define FS_LOGINTASKS_H
+
+#include "database.h"
+#include "enums.h"
+
+#include <shared_mutex>
+
+enum LoginStage_t : uint8_t
+{
+	LOGIN_STAGE_QUEUE, // waiting for a free loader
+	LOGIN_STAGE_LOAD, // loading the player on a loader connection
+	LOGIN_STAGE_PLACE, // waiting for the dispatcher and placing the player
+
+	LOGIN_STAGE_LAST = LOGIN_STAGE_PLACE
+};
+
+struct LoginStageStats
+{
+	uint64_t count = 0;
+	uint64_t totalMicros = 0;
+	uint64_t maxMicros = 0;
+};
+
+struct LoginStats
+{
+	std::array<LoginStageStats, LOGIN_STAGE_LAST + 1> stages;
+	uint64_t rejected = 0;
+	size_t queueSize = 0;
+
+	// item rows loaded by logins, the ones they keep resident, and by the depots loaded afterwards
+	uint64_t loginItems = 0;
+	uint64_t depotItems = 0;
+	LoginStageStats depotLoads; // from the first use of the depot until it is loaded
+};
+
+struct LoginTask
+{
+	LoginTask(std::function<void(Database&)>&& load, std::function<void(void)>&& finish) :
+	    load(std::move(load)), finish(std::move(finish)), queuedAt(std::chrono::steady_clock::now())
+	{}
+
+	std::function<void(Database&)> load;
+	std::function<void(void)> finish;
+	std::chrono::steady_clock::time_point queuedAt;
+};
+
+/**
+ * Loads players for logging in on a pool of threads, each owning its own
+ * database connection, so that the dispatcher only has to place them.
+ *
+ * The load function runs on a loader thread and must only touch the player
+ * being loaded and immutable game data (items, vocations, groups, towns).
+ * The finish function is then run on the dispatcher thread.
+ */
+class LoginTasks
+{
+public:
+	LoginTasks() = default;
+
+	// non-copyable
+	LoginTasks(const LoginTasks&) = delete;
+	LoginTasks& operator=(const LoginTasks&) = delete;
+
+	bool start();
+	void shutdown();
+	void join();
+
+	/**
+	 * Queues a player load.
+	 *
+	 * @return false if the login queue is full or the loaders are not running
+	 */
+	bool addTask(std::function<void(Database&)> load, std::function<void(void)> finish);
+
+	/**
+	 * Blocks new player loads and waits for the running ones, used while
+	 * reloading data the loaders read (e.g. items).
+	 */
+	std::unique_lock<std::shared_mutex> pause() { return std::unique_lock<std::shared_mutex>(loadLock); }
+
+	/**
+	 * Offline writes change the rows of a player who is not online (e.g.
+	 * items delivered to the inbox), so they must never overlap a load of the
+	 * same player: the loaded player would not have the rows and would
+	 * overwrite them with its next save.
+	 *
+	 * Called on the dispatcher thread before queuing the write.
+	 *
+	 * @return false if the player is being loaded, retry once it is online
+	 */
+	bool beginOfflineWrite(uint32_t guid);
+
+	/**
+	 * Called on any thread once the offline write has been committed.
+	 */
+	void endOfflineWrite(uint32_t guid);
+
+	/**
+	 * Called by a load once the guid is known, waits for the offline writes
+	 * of the player still being written.
+	 */
+	void beginLoad(uint32_t guid);
+
+	/**
+	 * Called on the dispatcher thread once the loaded player was placed, or
+	 * the load failed.
+	 */
+	void endLoad(uint32_t guid);
+
+	/**
+	 * Runs the callback on the dispatcher thread once the player being loaded
+	 * was placed or the load failed, used to retry an offline write that
+	 * beginOfflineWrite refused.
+	 */
+	void afterLoad(uint32_t guid, std::function<void(void)> callback);
+
+	void addLoginItems(size_t items);
+	void addDepotLoad(int64_t millis, size_t items);
+
+	LoginStats getStats();
+
+	void threadMain(Database& db);
+
+private:
+	void runTask(Database& db, LoginTask& task);
+	void addStageTime(LoginStage_t stage, std::chrono::steady_clock::duration duration);
+
+	std::vector<std::unique_ptr<Database>> connections;
+	std::vector<std::thread> threads;
+
+	std::list<LoginTask> tasks;
+	std::mutex taskLock;
+	std::condition_variable taskSignal;
+	std::shared_mutex loadLock;
+
+	std::mutex playerLock;
+	std::condition_variable playerSignal;
+	std::unordered_map<uint32_t, uint32_t> offlineWrites;
+	std::unordered_map<uint32_t, uint32_t> loadingPlayers;
+	std::unordered_map<uint32_t, std::vector<std::function<void(void)>>> loadCallbacks;
+	std::atomic<ThreadState> threadState{THREAD_STATE_TERMINATED};
+
+	std::mutex statsLock;
+	LoginStats stats;
+};
+
+extern LoginTasks g_loginTasks;
+
+#endif // FS_LOGINTASKS_H
@@ -0,0 +1,190 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaallocator.h"
+
+LuaAllocator::LuaAllocator()
+{
+	// the global environment, which also gets everything not allocated on behalf of a script interface
+	getOwner("Main Interface");
+}
+
+void* LuaAllocator::allocate(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+	LuaAllocator& allocator = *static_cast<LuaAllocator*>(ud);
+
+	// without a block, osize is the type of the object being created
+	if (!ptr) {
+		osize = 0;
+	}
+
+	const bool small = osize <= MAX_SMALL_SIZE && !allocator.isShrunkLarge(ptr);
+
+	if (nsize == 0) {
+		if (ptr) {
+			if (small) {
+				allocator.freeSmall(ptr, osize);
+			} else {
+				allocator.freeLarge(ptr, osize);
+			}
+		}
+		return nullptr;
+	}
+
+	if (osize == 0) {
+		return nsize <= MAX_SMALL_SIZE ? allocator.allocateSmall(nsize) : allocator.allocateLarge(nsize);
+	}
+
+	if (!small && nsize > MAX_SMALL_SIZE) {
+		return allocator.reallocateLarge(ptr, osize, nsize);
+	}
+
+	if (small && nsize <= MAX_SMALL_SIZE && getSizeClass(osize) == getSizeClass(nsize)) {
+		const auto chunk = reinterpret_cast<const ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(CHUNK_SIZE - 1));
+		LuaMemoryStats& ownerStats = allocator.stats[chunk->owner];
+		ownerStats.bytes = ownerStats.bytes - osize + nsize;
+		return ptr;
+	}
+
+	void* newPtr = nsize <= MAX_SMALL_SIZE ? allocator.allocateSmall(nsize) : allocator.allocateLarge(nsize);
+	if (!newPtr) {
+		if (nsize > osize) {
+			return nullptr;
+		}
+
+		// shrinking must not fail, the block is kept in its pool or as a large block
+		if (small) {
+			const auto chunk =
+			    reinterpret_cast<const ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(CHUNK_SIZE - 1));
+			LuaMemoryStats& ownerStats = allocator.stats[chunk->owner];
+			ownerStats.bytes = ownerStats.bytes - osize + nsize;
+			return ptr;
+		}
+		return allocator.reallocateLarge(ptr, osize, nsize);
+	}
+
+	std::memcpy(newPtr, ptr, std::min(osize, nsize));
+	if (small) {
+		allocator.freeSmall(ptr, osize);
+	} else {
+		allocator.freeLarge(ptr, osize);
+	}
+	return newPtr;
+}
+
+uint16_t LuaAllocator::getOwner(const std::string& name)
+{
+	for (size_t owner = 0, size = stats.size(); owner < size; ++owner) {
+		if (stats[owner].owner == name) {
+			return owner;
+		}
+	}
+
+	LuaMemoryStats& ownerStats = stats.emplace_back();
+	ownerStats.owner = name;
+	freeLists.emplace_back();
+	return stats.size() - 1;
+}
+
+std::vector<LuaMemoryStats> LuaAllocator::getStats() const { return stats; }
+
+void* LuaAllocator::allocateSmall(size_t size)
+{
+	const size_t sizeClass = getSizeClass(size);
+	FreeBlock*& freeList = freeLists[currentOwner][sizeClass];
+	if (!freeList) {
+		auto chunk = static_cast<char*>(::operator new(CHUNK_SIZE, std::align_val_t{CHUNK_SIZE}, std::nothrow));
+		if (!chunk) {
+			return nullptr;
+		}
+
+		chunks.push_back(chunk);
+		new (chunk) ChunkHeader{currentOwner, static_cast<uint8_t>(sizeClass)};
+
+		const size_t blockSize = (sizeClass + 1) * SIZE_CLASS_STEP;
+		for (size_t offset = HEADER_SIZE; offset + blockSize <= CHUNK_SIZE; offset += blockSize) {
+			auto block = reinterpret_cast<FreeBlock*>(chunk + offset);
+			block->next = freeList;
+			freeList = block;
+		}
+	}
+
+	FreeBlock* block = freeList;
+	freeList = block->next;
+
+	LuaMemoryStats& ownerStats = stats[currentOwner];
+	ownerStats.bytes += size;
+	++ownerStats.blocks;
+	return block;
+}
+
+void LuaAllocator::freeSmall(void* ptr, size_t size)
+{
+	const auto chunk = reinterpret_cast<const ChunkHeader*>(reinterpret_cast<uintptr_t>(ptr) & ~(CHUNK_SIZE - 1));
+	FreeBlock*& freeList = freeLists[chunk->owner][chunk->sizeClass];
+	auto block = static_cast<FreeBlock*>(ptr);
+	block->next = freeList;
+	freeList = block;
+
+	LuaMemoryStats& ownerStats = stats[chunk->owner];
+	ownerStats.bytes -= size;
+	--ownerStats.blocks;
+}
+
+void* LuaAllocator::allocateLarge(size_t size)
+{
+	auto base = static_cast<char*>(std::malloc(size + HEADER_SIZE));
+	if (!base) {
+		return nullptr;
+	}
+
+	*reinterpret_cast<uint16_t*>(base) = currentOwner;
+
+	LuaMemoryStats& ownerStats = stats[currentOwner];
+	ownerStats.bytes += size;
+	++ownerStats.blocks;
+	return base + HEADER_SIZE;
+}
+
+void* LuaAllocator::reallocateLarge(void* ptr, size_t osize, size_t nsize)
+{
+	// the list of shrunk blocks goes through their headers, which realloc may move
+	if (osize <= MAX_SMALL_SIZE) {
+		unlinkShrunkLarge(ptr);
+	}
+
+	auto base = static_cast<char*>(ptr) - HEADER_SIZE;
+	if (auto newBase = static_cast<char*>(std::realloc(base, nsize + HEADER_SIZE))) {
+		base = newBase;
+	} else if (nsize > osize) {
+		if (osize <= MAX_SMALL_SIZE) {
+			linkShrunkLarge(ptr);
+		}
+		return nullptr;
+	}
+
+	LuaMemoryStats& ownerStats = stats[*reinterpret_cast<uint16_t*>(base)];
+	ownerStats.bytes = ownerStats.bytes - osize + nsize;
+
+	void* newPtr = base + HEADER_SIZE;
+	if (nsize <= MAX_SMALL_SIZE) {
+		linkShrunkLarge(newPtr);
+	}
+	return newPtr;
+}
+
+void LuaAllocator::freeLarge(void* ptr, size_t size)
+{
+	if (size <= MAX_SMALL_SIZE) {
+		unlinkShrunkLarge(ptr);
+	}
+
+	char* base = static_cast<char*>(ptr) - HEADER_SIZE;
+
+	LuaMemoryStats& ownerStats = stats[*reinterpret_cast<uint16_t*>(base)];
+	ownerStats.bytes -= size;
+	--ownerStats.blocks;
+	std::free(base);
+}
@@ -0,0 +1,149 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAALLOCATOR_H
+#define FS_LUAALLOCATOR_H
+
+struct LuaMemoryStats
+{
+	std::string owner;
+	size_t bytes = 0;
+	size_t blocks = 0;
+};
+
+/**
+ * The lua_Alloc of the Lua state, which keeps the many small blocks of Lua
+ * out of the process heap and accounts memory to the script interface that
+ * allocated it.
+ *
+ * Blocks of up to 256 bytes come from pools with a free list per owner and
+ * size class, carved from aligned chunks whose header names the owner and
+ * the size class of their blocks. Larger blocks are allocated with malloc
+ * behind a small header naming the owner. Shrinking a block never fails: a
+ * block that cannot be moved stays where it is, and a large block shrunk to
+ * a small size is linked through its header so that it is still freed as a
+ * large block.
+ *
+ * Only used on the dispatcher thread, like the Lua state itself.
+ */
+class LuaAllocator
+{
+public:
+	static LuaAllocator& getInstance()
+	{
+		// never destroyed, g_luaEnvironment closes its state during static destruction
+		static LuaAllocator* instance = new LuaAllocator;
+		return *instance;
+	}
+
+	static void* allocate(void* ud, void* ptr, size_t osize, size_t nsize);
+
+	/**
+	 * Returns the owner id of the named script interface, interfaces sharing
+	 * a name share the owner.
+	 */
+	uint16_t getOwner(const std::string& name);
+
+	/**
+	 * Makes owner the owner of the blocks allocated from now on and returns
+	 * the previous one.
+	 */
+	uint16_t setOwner(uint16_t owner)
+	{
+		std::swap(owner, currentOwner);
+		return owner;
+	}
+	uint16_t getCurrentOwner() const { return currentOwner; }
+
+	std::vector<LuaMemoryStats> getStats() const;
+	size_t getPoolSize() const { return chunks.size() * CHUNK_SIZE; }
+
+private:
+	LuaAllocator();
+
+	// non-copyable
+	LuaAllocator(const LuaAllocator&) = delete;
+	LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+	static constexpr size_t MAX_SMALL_SIZE = 256;
+	static constexpr size_t SIZE_CLASS_STEP = 16;
+	static constexpr size_t SIZE_CLASSES = MAX_SMALL_SIZE / SIZE_CLASS_STEP;
+	static constexpr size_t CHUNK_SIZE = 16 * 1024;
+	static constexpr size_t HEADER_SIZE = 16;
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct ChunkHeader
+	{
+		uint16_t owner;
+		uint8_t sizeClass;
+	};
+
+	static size_t getSizeClass(size_t size) { return (size - 1) / SIZE_CLASS_STEP; }
+
+	// the header of a large block holds its owner and, once it is shrunk to a small size, the next shrunk block
+	static void*& getNextShrunkLarge(void* ptr)
+	{
+		return *reinterpret_cast<void**>(static_cast<char*>(ptr) - HEADER_SIZE + sizeof(void*));
+	}
+
+	bool isShrunkLarge(void* ptr) const
+	{
+		for (void* block = shrunkLargeBlocks; block; block = getNextShrunkLarge(block)) {
+			if (block == ptr) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void linkShrunkLarge(void* ptr)
+	{
+		getNextShrunkLarge(ptr) = shrunkLargeBlocks;
+		shrunkLargeBlocks = ptr;
+	}
+
+	void unlinkShrunkLarge(void* ptr)
+	{
+		for (void** link = &shrunkLargeBlocks; *link; link = &getNextShrunkLarge(*link)) {
+			if (*link == ptr) {
+				*link = getNextShrunkLarge(ptr);
+				return;
+			}
+		}
+	}
+
+	void* allocateSmall(size_t size);
+	void freeSmall(void* ptr, size_t size);
+	void* allocateLarge(size_t size);
+	void* reallocateLarge(void* ptr, size_t osize, size_t nsize);
+	void freeLarge(void* ptr, size_t size);
+
+	std::vector<std::array<FreeBlock*, SIZE_CLASSES>> freeLists;
+	std::vector<LuaMemoryStats> stats;
+	std::vector<void*> chunks;
+	void* shrunkLargeBlocks = nullptr;
+	uint16_t currentOwner = 0;
+};
+
+/**
+ * Accounts the Lua allocations of its scope to a script interface.
+ */
+class LuaMemoryOwnerGuard
+{
+public:
+	explicit LuaMemoryOwnerGuard(uint16_t owner) : previous(LuaAllocator::getInstance().setOwner(owner)) {}
+	~LuaMemoryOwnerGuard() { LuaAllocator::getInstance().setOwner(previous); }
+
+	// non-copyable
+	LuaMemoryOwnerGuard(const LuaMemoryOwnerGuard&) = delete;
+	LuaMemoryOwnerGuard& operator=(const LuaMemoryOwnerGuard&) = delete;
+
+private:
+	uint16_t previous;
+};
+
+#endif // FS_LUAALLOCATOR_H
@@ -0,0 +1,203 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "luaprofiler.h"
+
+#include <fstream>
+
+namespace {
+
+int64_t getMicros()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+	           std::chrono::steady_clock::now().time_since_epoch())
+	    .count();
+}
+
+std::string getFrameName(lua_State* L, lua_Debug& ar)
+{
+	lua_getinfo(L, "Sn", &ar);
+	if (ar.what && std::strcmp(ar.what, "C") == 0) {
+		return fmt::format("[C] {:s}", ar.name ? ar.name : "?");
+	}
+
+	if (ar.what && std::strcmp(ar.what, "main") == 0) {
+		return fmt::format("main ({:s})", ar.short_src);
+	}
+	return fmt::format("{:s} ({:s}:{:d})", ar.name ? ar.name : "?", ar.short_src, ar.linedefined);
+}
+
+void printTop(const std::string& title, const std::map<std::string, LuaProfileEntry>& entries, size_t limit)
+{
+	std::vector<const std::pair<const std::string, LuaProfileEntry>*> sorted;
+	sorted.reserve(entries.size());
+	for (const auto& it : entries) {
+		sorted.push_back(&it);
+	}
+
+	limit = std::min(limit, sorted.size());
+	std::partial_sort(sorted.begin(), sorted.begin() + limit, sorted.end(),
+	                  [](const auto* lhs, const auto* rhs) { return lhs->second.selfMicros > rhs->second.selfMicros; });
+
+	std::cout << "> " << title << " (self ms, total ms, count):" << std::endl;
+	for (size_t i = 0; i < limit; ++i) {
+		const LuaProfileEntry& entry = sorted[i]->second;
+		std::cout << fmt::format("  {:10.1f} {:10.1f} {:10d}  {:s}", entry.selfMicros / 1000., entry.totalMicros / 1000.,
+		                         entry.count, sorted[i]->first)
+		          << std::endl;
+	}
+}
+
+} // namespace
+
+void LuaProfiler::start(lua_State* L, int32_t interval)
+{
+	clear();
+	running = true;
+	lua_sethook(L, hook, LUA_MASKCOUNT, std::max<int32_t>(interval, 1));
+}
+
+void LuaProfiler::stop(lua_State* L)
+{
+	lua_sethook(L, nullptr, 0, 0);
+	running = false;
+
+	// a call still running was started while profiling, its end is not accounted anymore
+	calls.clear();
+	frames.clear();
+	stack.clear();
+}
+
+void LuaProfiler::clear()
+{
+	calls.clear();
+	frames.clear();
+	stack.clear();
+	events.clear();
+	functions.clear();
+	stacks.clear();
+}
+
+bool LuaProfiler::dump(const std::string& fileName) const
+{
+	// the name comes from a talkaction, it must not reach outside of the logs directory
+	if (fileName.empty() || fileName.find_first_of("/\\:") != std::string::npos ||
+	    fileName.find("..") != std::string::npos) {
+		std::cout << "[Error - LuaProfiler::dump] Invalid file name " << fileName << '.' << std::endl;
+		return false;
+	}
+
+	const std::string path = "data/logs/" + fileName;
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		std::cout << "[Error - LuaProfiler::dump] Cannot open " << path << " for writing." << std::endl;
+		return false;
+	}
+
+	for (const auto& it : stacks) {
+		file << it.first << ' ' << it.second << '\n';
+	}
+	file.close();
+
+	printTop("Lua events", events, 10);
+	printTop("Lua functions", functions, 20);
+	std::cout << "> Wrote " << stacks.size() << " Lua stacks to " << path << '.' << std::endl;
+	return true;
+}
+
+void LuaProfiler::enterCall(const std::string& interfaceName, const std::string& fileName)
+{
+	const int64_t now = getMicros();
+	flush(now);
+
+	Call call;
+	call.event = interfaceName + ';' + fileName;
+	call.stack = calls.empty() ? call.event : calls.back().stack + ';' + call.event;
+	call.startedAt = now;
+	calls.push_back(std::move(call));
+
+	// until the first sample, the time of the call is accounted to the call itself
+	frames.clear();
+	stack = calls.back().stack;
+}
+
+void LuaProfiler::leaveCall()
+{
+	if (calls.empty()) {
+		return;
+	}
+
+	const int64_t now = getMicros();
+	flush(now);
+
+	const Call& call = calls.back();
+	const int64_t micros = now - call.startedAt;
+
+	LuaProfileEntry& entry = events[call.event];
+	++entry.count;
+	entry.totalMicros += micros;
+	entry.selfMicros += micros - call.childMicros;
+
+	calls.pop_back();
+	frames.clear();
+	if (calls.empty()) {
+		stack.clear();
+	} else {
+		calls.back().childMicros += micros;
+		stack = calls.back().stack;
+	}
+}
+
+void LuaProfiler::hook(lua_State* L, lua_Debug*) { g_luaProfiler.sample(L); }
+
+void LuaProfiler::sample(lua_State* L)
+{
+	// instructions run outside of a timed call, such as loading a script, are not accounted
+	if (calls.empty()) {
+		return;
+	}
+
+	frames.clear();
+	lua_Debug ar;
+	for (int level = 0; lua_getstack(L, level, &ar) == 1; ++level) {
+		frames.push_back(getFrameName(L, ar));
+	}
+	std::reverse(frames.begin(), frames.end());
+
+	stack = calls.back().stack;
+	for (const std::string& frame : frames) {
+		stack.push_back(';');
+		stack.append(frame);
+	}
+
+	if (!frames.empty()) {
+		++functions[frames.back()].count;
+	}
+
+	// the time since the last sample is accounted to the stack it ends in
+	flush(getMicros());
+}
+
+void LuaProfiler::flush(int64_t now)
+{
+	const int64_t micros = now - lastSampleAt;
+	lastSampleAt = now;
+	if (stack.empty() || micros <= 0) {
+		return;
+	}
+
+	stacks[stack] += micros;
+	if (frames.empty()) {
+		return;
+	}
+
+	functions[frames.back()].selfMicros += micros;
+	for (auto it = frames.begin(), end = frames.end(); it != end; ++it) {
+		// a recursive function is accounted once per sample
+		if (std::find(frames.begin(), it, *it) == it) {
+			functions[*it].totalMicros += micros;
+		}
+	}
+}
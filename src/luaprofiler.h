@@ -0,0 +1,79 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_LUAPROFILER_H
+#define FS_LUAPROFILER_H
+
+struct LuaProfileEntry
+{
+	uint64_t count = 0; // calls for events, samples for functions
+	int64_t selfMicros = 0;
+	int64_t totalMicros = 0;
+};
+
+/**
+ * Measures where the dispatcher spends its time in Lua.
+ *
+ * Every call into a script is timed by wall clock and accounted to its
+ * interface and file. While a script runs, a count hook samples the Lua
+ * stack every interval instructions and accounts the time since the last
+ * sample to that stack, which gives the self and total time of each Lua
+ * function and the collapsed stacks a flame graph is drawn from.
+ *
+ * Only used on the dispatcher thread.
+ */
+class LuaProfiler
+{
+public:
+	LuaProfiler() = default;
+
+	// non-copyable
+	LuaProfiler(const LuaProfiler&) = delete;
+	LuaProfiler& operator=(const LuaProfiler&) = delete;
+
+	bool isRunning() const { return running; }
+
+	void start(lua_State* L, int32_t interval);
+	void stop(lua_State* L);
+	void clear();
+
+	/**
+	 * Writes the collapsed stacks, one "frame;frame;frame microseconds" line
+	 * per stack, to data/logs/fileName and prints the events and functions
+	 * that took the most time. fileName must be a plain file name, without a
+	 * directory.
+	 */
+	bool dump(const std::string& fileName) const;
+
+	void enterCall(const std::string& interfaceName, const std::string& fileName);
+	void leaveCall();
+
+private:
+	struct Call
+	{
+		std::string event;
+		std::string stack;
+		int64_t startedAt;
+		int64_t childMicros = 0;
+	};
+
+	static void hook(lua_State* L, lua_Debug* ar);
+
+	void sample(lua_State* L);
+	void flush(int64_t now);
+
+	std::vector<Call> calls;
+	std::vector<std::string> frames;
+	std::string stack;
+	int64_t lastSampleAt = 0;
+
+	std::map<std::string, LuaProfileEntry> events;
+	std::map<std::string, LuaProfileEntry> functions;
+	std::map<std::string, int64_t> stacks;
+
+	bool running = false;
+};
+
+extern LuaProfiler g_luaProfiler;
+
+#endif // FS_LUAPROFILER_H
@@ -19,6 +19,8 @@
 #include "iologindata.h"
 #include "iomapserialize.h"
 #include "iomarket.h"
+#include "luaallocator.h"
+#include "luaprofiler.h"
 #include "luavariant.h"
 #include "monster.h"
 #include "movement.h"
@@ -37,6 +39,8 @@
 #include "weapons.h"
 
 #include <boost/range/adaptor/reversed.hpp>
+#include <filesystem>
+#include <fstream>
 
 extern Chat* g_chat;
 extern Game g_game;
@@ -58,6 +62,128 @@ uint32_t ScriptEnvironment::lastResultId = 0;
 
 std::multimap<ScriptEnvironment*, Item*> ScriptEnvironment::tempItems;
 
+std::array<int, LuaData_Tile + 1> LuaScriptInterface::metatableRefs = {};
+int LuaScriptInterface::creatureCacheRef = LUA_NOREF;
+std::map<std::string, LuaLoadStats> LuaScriptInterface::loadStats;
+
+namespace {
+
+int writeBytecode(lua_State*, const void* p, size_t size, void* ud)
+{
+	static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+	return 0;
+}
+
+bool readFile(const std::string& fileName, std::string& contents)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !file.bad();
+}
+
+// the first two directories of the file below the working directory, such as data/scripts
+std::string getLoadDirectory(const std::string& file)
+{
+	namespace fs = std::filesystem;
+
+	fs::path path(file);
+	if (path.is_absolute()) {
+		path = path.lexically_relative(fs::current_path());
+	}
+
+	fs::path directory;
+	auto it = path.begin();
+	for (int i = 0; i < 2 && it != path.end() && std::next(it) != path.end(); ++i, ++it) {
+		directory /= *it;
+	}
+	return directory.generic_string();
+}
+
+/**
+ * Loads a script like luaL_loadfile, from the bytecode cache when the cache
+ * holds the script as it is now. The cache is keyed by a hash of the Lua
+ * version, the file name and the source, so a changed script is compiled
+ * and cached again and the stale entry is never read.
+ */
+int loadCachedFile(lua_State* L, const std::string& file, bool& cached)
+{
+	cached = false;
+
+	const std::string& cacheDirectory = g_config.getString(ConfigManager::LUA_BYTECODE_CACHE);
+	std::string source;
+	if (cacheDirectory.empty() || !readFile(file, source)) {
+		return luaL_loadfile(L, file.c_str());
+	}
+
+#ifdef LUAJIT_VERSION
+	const char* version = LUAJIT_VERSION;
+#else
+	const char* version = LUA_RELEASE;
+#endif
+	const std::string key = transformToSHA1(fmt::format("{:s}-{:d}\n{:s}\n{:s}", version, sizeof(void*), file, source));
+	const std::string cacheFile = fmt::format("{:s}/{:s}.luac", cacheDirectory, key);
+
+	const std::string chunkName = '@' + file;
+	std::string bytecode;
+	if (readFile(cacheFile, bytecode) && !bytecode.empty()) {
+		if (luaL_loadbuffer(L, bytecode.data(), bytecode.size(), chunkName.c_str()) == 0) {
+			cached = true;
+			return 0;
+		}
+
+		std::cout << "[Warning - LuaScriptInterface::loadFile] Ignoring the broken bytecode cache of " << file << '.'
+		          << std::endl;
+		lua_pop(L, 1);
+	}
+
+	// like luaL_loadfile, skip a byte order mark and comment out a first line starting with #, keeping line numbers
+	size_t offset = source.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+	if (source.compare(offset, 1, "#") == 0) {
+		source[offset] = '-';
+		source.insert(offset, 1, '-');
+	}
+
+	int ret = luaL_loadbuffer(L, source.data() + offset, source.size() - offset, chunkName.c_str());
+	if (ret != 0) {
+		return ret;
+	}
+
+	bytecode.clear();
+#if LUA_VERSION_NUM >= 503
+	lua_dump(L, writeBytecode, &bytecode, 0);
+#else
+	lua_dump(L, writeBytecode, &bytecode);
+#endif
+
+	// written aside and renamed, so a server loading at the same time never reads half a file
+	std::error_code ec;
+	std::filesystem::create_directories(cacheDirectory, ec);
+
+	const std::string tempFile = cacheFile + ".tmp";
+	if (!ec) {
+		std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+		if (!out.write(bytecode.data(), bytecode.size())) {
+			ec = std::make_error_code(std::errc::io_error);
+		}
+	}
+
+	if (!ec) {
+		std::filesystem::rename(tempFile, cacheFile, ec);
+	}
+
+	if (ec) {
+		std::cout << "[Warning - LuaScriptInterface::loadFile] Cannot write the bytecode cache of " << file << ": "
+		          << ec.message() << std::endl;
+	}
+	return 0;
+}
+
+} // namespace
+
 LuaEnvironment g_luaEnvironment;
 
 ScriptEnvironment::ScriptEnvironment() { resetEnv(); }
@@ -272,7 +398,8 @@ std::string LuaScriptInterface::getErrorDesc(ErrorCode_t code)
 ScriptEnvironment LuaScriptInterface::scriptEnv[16];
 int32_t LuaScriptInterface::scriptEnvIndex = -1;
 
-LuaScriptInterface::LuaScriptInterface(std::string interfaceName) : interfaceName(std::move(interfaceName))
+LuaScriptInterface::LuaScriptInterface(std::string interfaceName) :
+    memoryOwner(LuaAllocator::getInstance().getOwner(interfaceName)), interfaceName(std::move(interfaceName))
 {
 	if (!g_luaEnvironment.getLuaState()) {
 		g_luaEnvironment.initState();
@@ -293,19 +420,56 @@ bool LuaScriptInterface::reInitState()
 /// Same as lua_pcall, but adds stack trace to error strings in called function.
 int LuaScriptInterface::protectedCall(lua_State* L, int nargs, int nresults)
 {
+	ScriptEnvironment* env = scriptEnvIndex >= 0 ? getScriptEnv() : nullptr;
+	LuaScriptInterface* scriptInterface = env ? env->getScriptInterface() : nullptr;
+
+	// every event calls its script through here, so the memory of the call is charged to the interface of the
+	// script whether or not it went through callFunction
+	LuaAllocator& allocator = LuaAllocator::getInstance();
+	LuaMemoryOwnerGuard memoryOwnerGuard(scriptInterface ? scriptInterface->memoryOwner : allocator.getCurrentOwner());
+
+	// loading a file is not an event
+	LuaScriptInterface* profiledInterface = nullptr;
+	int32_t profiledScriptId = 0;
+	if (g_luaProfiler.isRunning() && scriptInterface && env->getScriptId() != EVENT_ID_LOADING) {
+		profiledInterface = scriptInterface;
+		profiledScriptId = env->getScriptId();
+	}
+
+	if (profiledInterface) {
+		g_luaProfiler.enterCall(profiledInterface->getInterfaceName(), profiledInterface->getFileById(profiledScriptId));
+	}
+
 	int error_index = lua_gettop(L) - nargs;
 	lua_pushcfunction(L, luaErrorHandler);
 	lua_insert(L, error_index);
 
 	int ret = lua_pcall(L, nargs, nresults, error_index);
 	lua_remove(L, error_index);
+
+	if (profiledInterface) {
+		g_luaProfiler.leaveCall();
+	}
 	return ret;
 }
 
 int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = nullptr*/)
 {
+	LuaMemoryOwnerGuard memoryOwnerGuard(memoryOwner);
+
 	// loads file as a chunk at stack top
-	int ret = luaL_loadfile(luaState, file.c_str());
+	const auto startedAt = std::chrono::steady_clock::now();
+	bool cached;
+	int ret = loadCachedFile(luaState, file, cached);
+
+	LuaLoadStats& stats = loadStats[getLoadDirectory(file)];
+	++stats.files;
+	if (cached) {
+		++stats.cached;
+	}
+	stats.micros +=
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt).count();
+
 	if (ret != 0) {
 		lastLuaError = popString(luaState);
 		return -1;
@@ -340,6 +504,24 @@ int32_t LuaScriptInterface::loadFile(const std::string& file, Npc* npc /* = null
 	return 0;
 }
 
+void LuaScriptInterface::reportLoadStats()
+{
+	LuaLoadStats total;
+	for (const auto& it : loadStats) {
+		total.files += it.second.files;
+		total.cached += it.second.cached;
+		total.micros += it.second.micros;
+	}
+
+	std::cout << "> Loaded " << total.files << " Lua files in " << total.micros / 1000 << " ms, " << total.cached
+	          << " from the bytecode cache:" << std::endl;
+	for (const auto& it : loadStats) {
+		std::cout << ">> " << it.first << ": " << it.second.files << " files in " << it.second.micros / 1000 << " ms, "
+		          << it.second.cached << " cached" << std::endl;
+	}
+	loadStats.clear();
+}
+
 int32_t LuaScriptInterface::getEvent(const std::string& eventName)
 {
 	// get our events table
@@ -546,7 +728,7 @@ bool LuaScriptInterface::callFunction(int params)
 	return result;
 }
 
-void LuaScriptInterface::callVoidFunction(int params)
+void LuaScriptInterface::callVoidFunction(int params, bool resetEnv /* = true*/)
 {
 	int size = lua_gettop(luaState);
 	if (protectedCall(luaState, params, 0) != 0) {
@@ -557,7 +739,9 @@ void LuaScriptInterface::callVoidFunction(int params)
 		LuaScriptInterface::reportError(nullptr, "Stack size changed!");
 	}
 
-	resetScriptEnv();
+	if (resetEnv) {
+		resetScriptEnv();
+	}
 }
 
 void LuaScriptInterface::pushVariant(lua_State* L, const LuaVariant& var)
@@ -601,18 +785,42 @@ void LuaScriptInterface::pushThing(lua_State* L, Thing* thing)
 		pushUserdata<Item>(L, item);
 		setItemMetatable(L, -1, item);
 	} else if (Creature* creature = thing->getCreature()) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
 }
 
-void LuaScriptInterface::pushCylinder(lua_State* L, Cylinder* cylinder)
+void LuaScriptInterface::pushCreature(lua_State* L, Creature* creature)
 {
-	if (Creature* creature = cylinder->getCreature()) {
+	const lua_Integer id = creature->getID();
+	if (id == 0 || creatureCacheRef == LUA_NOREF) {
+		pushUserdata<Creature>(L, creature);
+		setCreatureMetatable(L, -1, creature);
+		return;
+	}
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, creatureCacheRef);
+	lua_pushinteger(L, id);
+	lua_rawget(L, -2);
+
+	// a player logging in again gets the id of the previous session, whose userdata may still be held by a script
+	if (lua_isnil(L, -1) || *getRawUserdata<Creature>(L, -1) != creature) {
+		lua_pop(L, 1);
 		pushUserdata<Creature>(L, creature);
 		setCreatureMetatable(L, -1, creature);
+
+		lua_pushinteger(L, id);
+		lua_pushvalue(L, -2);
+		lua_rawset(L, -4);
+	}
+	lua_remove(L, -2);
+}
+
+void LuaScriptInterface::pushCylinder(lua_State* L, Cylinder* cylinder)
+{
+	if (Creature* creature = cylinder->getCreature()) {
+		pushCreature(L, creature);
 	} else if (Item* parentItem = cylinder->getItem()) {
 		pushUserdata<Item>(L, parentItem);
 		setItemMetatable(L, -1, parentItem);
@@ -653,6 +861,12 @@ void LuaScriptInterface::setMetatable(lua_State* L, int32_t index, const std::st
 	lua_setmetatable(L, index - 1);
 }
 
+void LuaScriptInterface::setMetatable(lua_State* L, int32_t index, LuaDataType type)
+{
+	lua_rawgeti(L, LUA_REGISTRYINDEX, metatableRefs[type]);
+	lua_setmetatable(L, index - 1);
+}
+
 void LuaScriptInterface::setWeakMetatable(lua_State* L, int32_t index, const std::string& name)
 {
 	static std::set<std::string> weakObjectTypes;
@@ -691,27 +905,25 @@ void LuaScriptInterface::setWeakMetatable(lua_State* L, int32_t index, const std
 void LuaScriptInterface::setItemMetatable(lua_State* L, int32_t index, const Item* item)
 {
 	if (item->getContainer()) {
-		luaL_getmetatable(L, "Container");
+		setMetatable(L, index, LuaData_Container);
 	} else if (item->getTeleport()) {
-		luaL_getmetatable(L, "Teleport");
+		setMetatable(L, index, LuaData_Teleport);
 	} else if (item->getPodium()) {
-		luaL_getmetatable(L, "Podium");
+		setMetatable(L, index, LuaData_Podium);
 	} else {
-		luaL_getmetatable(L, "Item");
+		setMetatable(L, index, LuaData_Item);
 	}
-	lua_setmetatable(L, index - 1);
 }
 
 void LuaScriptInterface::setCreatureMetatable(lua_State* L, int32_t index, const Creature* creature)
 {
 	if (creature->getPlayer()) {
-		luaL_getmetatable(L, "Player");
+		setMetatable(L, index, LuaData_Player);
 	} else if (creature->getMonster()) {
-		luaL_getmetatable(L, "Monster");
+		setMetatable(L, index, LuaData_Monster);
 	} else {
-		luaL_getmetatable(L, "Npc");
+		setMetatable(L, index, LuaData_Npc);
 	}
-	lua_setmetatable(L, index - 1);
 }
 
 // Get
@@ -2127,6 +2339,8 @@ void LuaScriptInterface::registerFunctions()
 	registerEnumIn("configKeys", ConfigManager::MYSQL_SOCK);
 	registerEnumIn("configKeys", ConfigManager::DEFAULT_PRIORITY);
 	registerEnumIn("configKeys", ConfigManager::MAP_AUTHOR);
+	registerEnumIn("configKeys", ConfigManager::LUA_BYTECODE_CACHE);
+	registerEnumIn("configKeys", ConfigManager::METRICS_IP);
 
 	registerEnumIn("configKeys", ConfigManager::SQL_PORT);
 	registerEnumIn("configKeys", ConfigManager::MAX_PLAYERS);
@@ -2165,8 +2379,21 @@ void LuaScriptInterface::registerFunctions()
 	registerEnumIn("configKeys", ConfigManager::TWO_FACTOR_AUTH);
 	registerEnumIn("configKeys", ConfigManager::STAMINA_REGEN_MINUTE);
 	registerEnumIn("configKeys", ConfigManager::STAMINA_REGEN_PREMIUM);
+	registerEnumIn("configKeys", ConfigManager::LOGIN_WORKER_THREADS);
+	registerEnumIn("configKeys", ConfigManager::LOGIN_QUEUE_SIZE);
+	registerEnumIn("configKeys", ConfigManager::DATABASE_TASK_WORKERS);
 	registerEnumIn("configKeys", ConfigManager::HOUSE_DOOR_SHOW_PRICE);
 	registerEnumIn("configKeys", ConfigManager::MONSTER_OVERSPAWN);
+	registerEnumIn("configKeys", ConfigManager::INCREMENTAL_PLAYER_SAVE);
+	registerEnumIn("configKeys", ConfigManager::CHECK_PLAYER_SAVE_CONSISTENCY);
+	registerEnumIn("configKeys", ConfigManager::LAZY_DEPOT_LOADING);
+	registerEnumIn("configKeys", ConfigManager::CHECK_ITEM_COUNT_INDEX);
+	registerEnumIn("configKeys", ConfigManager::LUA_PROFILER);
+	registerEnumIn("configKeys", ConfigManager::LUA_PROFILER_INTERVAL);
+	registerEnumIn("configKeys", ConfigManager::LUA_GC_PAUSE);
+	registerEnumIn("configKeys", ConfigManager::LUA_GC_STEPMUL);
+	registerEnumIn("configKeys", ConfigManager::LUA_GC_STEP_BUDGET);
+	registerEnumIn("configKeys", ConfigManager::METRICS_PORT);
 
 	// os
 	registerMethod("os", "mtime", LuaScriptInterface::luaSystemTime);
@@ -2221,6 +2448,11 @@ void LuaScriptInterface::registerFunctions()
 
 	registerMethod("Game", "reload", LuaScriptInterface::luaGameReload);
 
+	registerMethod("Game", "startLuaProfiler", LuaScriptInterface::luaGameStartLuaProfiler);
+	registerMethod("Game", "stopLuaProfiler", LuaScriptInterface::luaGameStopLuaProfiler);
+	registerMethod("Game", "dumpLuaProfile", LuaScriptInterface::luaGameDumpLuaProfile);
+	registerMethod("Game", "getLuaMemoryUsage", LuaScriptInterface::luaGameGetLuaMemoryUsage);
+
 	registerMethod("Game", "getAccountStorageValue", LuaScriptInterface::luaGameGetAccountStorageValue);
 	registerMethod("Game", "setAccountStorageValue", LuaScriptInterface::luaGameSetAccountStorageValue);
 	registerMethod("Game", "saveAccountStorageValues", LuaScriptInterface::luaGameSaveAccountStorageValues);
@@ -3368,27 +3600,33 @@ void LuaScriptInterface::registerClass(const std::string& className, const std::
 	lua_rawseti(luaState, metatable, 'p');
 
 	// className.metatable['t'] = type
+	LuaDataType type = LuaData_Unknown;
 	if (className == "Item") {
-		lua_pushnumber(luaState, LuaData_Item);
+		type = LuaData_Item;
 	} else if (className == "Container") {
-		lua_pushnumber(luaState, LuaData_Container);
+		type = LuaData_Container;
 	} else if (className == "Teleport") {
-		lua_pushnumber(luaState, LuaData_Teleport);
+		type = LuaData_Teleport;
 	} else if (className == "Podium") {
-		lua_pushnumber(luaState, LuaData_Podium);
+		type = LuaData_Podium;
 	} else if (className == "Player") {
-		lua_pushnumber(luaState, LuaData_Player);
+		type = LuaData_Player;
 	} else if (className == "Monster") {
-		lua_pushnumber(luaState, LuaData_Monster);
+		type = LuaData_Monster;
 	} else if (className == "Npc") {
-		lua_pushnumber(luaState, LuaData_Npc);
+		type = LuaData_Npc;
 	} else if (className == "Tile") {
-		lua_pushnumber(luaState, LuaData_Tile);
-	} else {
-		lua_pushnumber(luaState, LuaData_Unknown);
+		type = LuaData_Tile;
 	}
+	lua_pushnumber(luaState, type);
 	lua_rawseti(luaState, metatable, 't');
 
+	// the metatables of the object classes are also kept by reference, so pushing an object needs no name lookup
+	if (type != LuaData_Unknown) {
+		lua_pushvalue(luaState, metatable);
+		metatableRefs[type] = luaL_ref(luaState, LUA_REGISTRYINDEX);
+	}
+
 	// pop className, className.metatable
 	lua_pop(luaState, 2);
 }
@@ -3908,12 +4146,7 @@ int LuaScriptInterface::luaAddEvent(lua_State* L)
 	eventDesc.function = luaL_ref(L, LUA_REGISTRYINDEX);
 	eventDesc.scriptId = getScriptEnv()->getScriptId();
 
-	auto& lastTimerEventId = g_luaEnvironment.lastEventTimerId;
-	eventDesc.eventId = g_scheduler.addEvent(
-	    createSchedulerTask(delay, [=]() { g_luaEnvironment.executeTimerEvent(lastTimerEventId); }));
-
-	g_luaEnvironment.timerEvents.emplace(lastTimerEventId, std::move(eventDesc));
-	lua_pushnumber(L, lastTimerEventId++);
+	lua_pushnumber(L, g_luaEnvironment.addTimerEvent(std::move(eventDesc), delay));
 	return 1;
 }
 
@@ -3921,25 +4154,7 @@ int LuaScriptInterface::luaStopEvent(lua_State* L)
 {
 	// stopEvent(eventid)
 	uint32_t eventId = getNumber<uint32_t>(L, 1);
-
-	auto& timerEvents = g_luaEnvironment.timerEvents;
-	auto it = timerEvents.find(eventId);
-	if (it == timerEvents.end()) {
-		pushBoolean(L, false);
-		return 1;
-	}
-
-	LuaTimerEventDesc timerEventDesc = std::move(it->second);
-	timerEvents.erase(it);
-
-	g_scheduler.stopEvent(timerEventDesc.eventId);
-	luaL_unref(L, LUA_REGISTRYINDEX, timerEventDesc.function);
-
-	for (auto parameter : timerEventDesc.parameters) {
-		luaL_unref(L, LUA_REGISTRYINDEX, parameter);
-	}
-
-	pushBoolean(L, true);
+	pushBoolean(L, g_luaEnvironment.stopTimerEvent(eventId));
 	return 1;
 }
 
@@ -4118,6 +4333,9 @@ int LuaScriptInterface::luaConfigManagerGetBoolean(lua_State* L)
 	return 1;
 }
 
+// scripts may rely on their asynchronous queries running in the order they were issued
+static const size_t luaDatabaseTaskKey = DatabaseTasks::getKey("lua");
+
 const luaL_Reg LuaScriptInterface::luaDatabaseTable[] = {
     {"query", LuaScriptInterface::luaDatabaseExecute},
     {"asyncQuery", LuaScriptInterface::luaDatabaseAsyncExecute},
@@ -4161,7 +4379,7 @@ int LuaScriptInterface::luaDatabaseAsyncExecute(lua_State* L)
 			luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(getString(L, -1), callback);
+	g_databaseTasks.addTask(getString(L, -1), callback, false, luaDatabaseTaskKey);
 	return 0;
 }
 
@@ -4205,7 +4423,7 @@ int LuaScriptInterface::luaDatabaseAsyncStoreQuery(lua_State* L)
 			luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
 		};
 	}
-	g_databaseTasks.addTask(getString(L, -1), callback, true);
+	g_databaseTasks.addTask(getString(L, -1), callback, true, luaDatabaseTaskKey);
 	return 0;
 }
 
@@ -4394,8 +4612,7 @@ int LuaScriptInterface::luaGameGetSpectators(lua_State* L)
 
 	int index = 0;
 	for (Creature* creature : spectators) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4408,8 +4625,7 @@ int LuaScriptInterface::luaGameGetPlayers(lua_State* L)
 
 	int index = 0;
 	for (const auto& playerEntry : g_game.getPlayers()) {
-		pushUserdata<Player>(L, playerEntry.second);
-		setMetatable(L, -1, "Player");
+		pushCreature(L, playerEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4422,8 +4638,7 @@ int LuaScriptInterface::luaGameGetNpcs(lua_State* L)
 
 	int index = 0;
 	for (const auto& npcEntry : g_game.getNpcs()) {
-		pushUserdata<Npc>(L, npcEntry.second);
-		setMetatable(L, -1, "Npc");
+		pushCreature(L, npcEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4436,8 +4651,7 @@ int LuaScriptInterface::luaGameGetMonsters(lua_State* L)
 
 	int index = 0;
 	for (const auto& monsterEntry : g_game.getMonsters()) {
-		pushUserdata<Monster>(L, monsterEntry.second);
-		setMetatable(L, -1, "Monster");
+		pushCreature(L, monsterEntry.second);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -4780,8 +4994,7 @@ int LuaScriptInterface::luaGameCreateMonster(lua_State* L)
 	MagicEffectClasses magicEffect = getNumber<MagicEffectClasses>(L, 5, CONST_ME_TELEPORT);
 	if (g_events->eventMonsterOnSpawn(monster, position, false, true) || force) {
 		if (g_game.placeCreature(monster, position, extended, force, magicEffect)) {
-			pushUserdata<Monster>(L, monster);
-			setMetatable(L, -1, "Monster");
+			pushCreature(L, monster);
 		} else {
 			delete monster;
 			lua_pushnil(L);
@@ -4807,8 +5020,7 @@ int LuaScriptInterface::luaGameCreateNpc(lua_State* L)
 	bool force = getBoolean(L, 4, false);
 	MagicEffectClasses magicEffect = getNumber<MagicEffectClasses>(L, 5, CONST_ME_TELEPORT);
 	if (g_game.placeCreature(npc, position, extended, force, magicEffect)) {
-		pushUserdata<Npc>(L, npc);
-		setMetatable(L, -1, "Npc");
+		pushCreature(L, npc);
 	} else {
 		delete npc;
 		lua_pushnil(L);
@@ -4927,7 +5139,51 @@ int LuaScriptInterface::luaGameReload(lua_State* L)
 	} else {
 		pushBoolean(L, g_game.reload(reloadType));
 	}
-	lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+	g_luaEnvironment.collectAllGarbage();
+	reportLoadStats();
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStartLuaProfiler(lua_State* L)
+{
+	// Game.startLuaProfiler([interval = luaProfilerInterval])
+	int32_t interval = getNumber<int32_t>(L, 1, g_config.getNumber(ConfigManager::LUA_PROFILER_INTERVAL));
+	g_luaProfiler.start(g_luaEnvironment.getLuaState(), interval);
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameStopLuaProfiler(lua_State* L)
+{
+	// Game.stopLuaProfiler()
+	if (!g_luaProfiler.isRunning()) {
+		pushBoolean(L, false);
+		return 1;
+	}
+
+	g_luaProfiler.stop(g_luaEnvironment.getLuaState());
+	pushBoolean(L, true);
+	return 1;
+}
+
+int LuaScriptInterface::luaGameDumpLuaProfile(lua_State* L)
+{
+	// Game.dumpLuaProfile(fileName)
+	pushBoolean(L, g_luaProfiler.dump(getString(L, 1)));
+	return 1;
+}
+
+int LuaScriptInterface::luaGameGetLuaMemoryUsage(lua_State* L)
+{
+	// Game.getLuaMemoryUsage()
+	const std::vector<LuaMemoryStats> stats = LuaAllocator::getInstance().getStats();
+	lua_createtable(L, 0, stats.size());
+	for (const LuaMemoryStats& ownerStats : stats) {
+		lua_createtable(L, 0, 2);
+		setField(L, "bytes", ownerStats.bytes);
+		setField(L, "blocks", ownerStats.blocks);
+		lua_setfield(L, -2, ownerStats.owner.c_str());
+	}
 	return 1;
 }
 
@@ -5246,8 +5502,7 @@ int LuaScriptInterface::luaTileGetThing(lua_State* L)
 	}
 
 	if (Creature* creature = thing->getCreature()) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 	} else if (Item* item = thing->getItem()) {
 		pushUserdata<Item>(L, item);
 		setItemMetatable(L, -1, item);
@@ -5286,8 +5541,7 @@ int LuaScriptInterface::luaTileGetTopVisibleThing(lua_State* L)
 	}
 
 	if (Creature* visibleCreature = thing->getCreature()) {
-		pushUserdata<Creature>(L, visibleCreature);
-		setCreatureMetatable(L, -1, visibleCreature);
+		pushCreature(L, visibleCreature);
 	} else if (Item* visibleItem = thing->getItem()) {
 		pushUserdata<Item>(L, visibleItem);
 		setItemMetatable(L, -1, visibleItem);
@@ -5533,8 +5787,7 @@ int LuaScriptInterface::luaTileGetTopCreature(lua_State* L)
 		return 1;
 	}
 
-	pushUserdata<Creature>(L, creature);
-	setCreatureMetatable(L, -1, creature);
+	pushCreature(L, creature);
 	return 1;
 }
 
@@ -5580,8 +5833,7 @@ int LuaScriptInterface::luaTileGetTopVisibleCreature(lua_State* L)
 
 	Creature* visibleCreature = tile->getTopVisibleCreature(creature);
 	if (visibleCreature) {
-		pushUserdata<Creature>(L, visibleCreature);
-		setCreatureMetatable(L, -1, visibleCreature);
+		pushCreature(L, visibleCreature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -5671,8 +5923,7 @@ int LuaScriptInterface::luaTileGetCreatures(lua_State* L)
 
 	int index = 0;
 	for (Creature* creature : *creatureVector) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -6601,6 +6852,7 @@ int LuaScriptInterface::luaItemSetActionId(lua_State* L)
 	Item* item = getUserdata<Item>(L, 1);
 	if (item) {
 		item->setActionId(actionId);
+		item->setHouseItemsChanged();
 		pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6823,9 +7075,14 @@ int LuaScriptInterface::luaItemSetAttribute(lua_State* L)
 		}
 
 		item->setIntAttr(attribute, getNumber<int32_t>(L, 3));
+		item->setHouseItemsChanged();
+		if (const Player* player = item->getHoldingPlayer()) {
+			player->invalidateItemCounts();
+		}
 		pushBoolean(L, true);
 	} else if (ItemAttributes::isStrAttrType(attribute)) {
 		item->setStrAttr(attribute, getString(L, 3));
+		item->setHouseItemsChanged();
 		pushBoolean(L, true);
 	} else {
 		lua_pushnil(L);
@@ -6854,6 +7111,10 @@ int LuaScriptInterface::luaItemRemoveAttribute(lua_State* L)
 	bool ret = attribute != ITEM_ATTRIBUTE_UNIQUEID;
 	if (ret) {
 		item->removeAttribute(attribute);
+		item->setHouseItemsChanged();
+		if (const Player* player = item->getHoldingPlayer()) {
+			player->invalidateItemCounts();
+		}
 	} else {
 		reportErrorFunc(L, "Attempt to erase protected key \"uid\"");
 	}
@@ -6925,6 +7186,7 @@ int LuaScriptInterface::luaItemSetCustomAttribute(lua_State* L)
 	}
 
 	item->setCustomAttribute(key, val);
+	item->setHouseItemsChanged();
 	pushBoolean(L, true);
 	return 1;
 }
@@ -6944,7 +7206,9 @@ int LuaScriptInterface::luaItemRemoveCustomAttribute(lua_State* L)
 		pushBoolean(L, item->removeCustomAttribute(getString(L, 2)));
 	} else {
 		lua_pushnil(L);
+		return 1;
 	}
+	item->setHouseItemsChanged();
 	return 1;
 }
 
@@ -7154,6 +7418,7 @@ int LuaScriptInterface::luaItemSetReflect(lua_State* L)
 	}
 
 	item->setReflect(getNumber<CombatType_t>(L, 2), getReflect(L, 3));
+	item->setHouseItemsChanged();
 	pushBoolean(L, true);
 	return 1;
 }
@@ -7180,6 +7445,7 @@ int LuaScriptInterface::luaItemSetBoostPercent(lua_State* L)
 	}
 
 	item->setBoostPercent(getNumber<CombatType_t>(L, 2), getNumber<uint16_t>(L, 3));
+	item->setHouseItemsChanged();
 	pushBoolean(L, true);
 	return 1;
 }
@@ -7638,8 +7904,7 @@ int LuaScriptInterface::luaCreatureCreate(lua_State* L)
 	}
 
 	if (creature) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7865,8 +8130,7 @@ int LuaScriptInterface::luaCreatureGetTarget(lua_State* L)
 
 	Creature* target = creature->getAttackedCreature();
 	if (target) {
-		pushUserdata<Creature>(L, target);
-		setCreatureMetatable(L, -1, target);
+		pushCreature(L, target);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7896,8 +8160,7 @@ int LuaScriptInterface::luaCreatureGetFollowCreature(lua_State* L)
 
 	Creature* followCreature = creature->getFollowCreature();
 	if (followCreature) {
-		pushUserdata<Creature>(L, followCreature);
-		setCreatureMetatable(L, -1, followCreature);
+		pushCreature(L, followCreature);
 	} else {
 		lua_pushnil(L);
 	}
@@ -7931,8 +8194,7 @@ int LuaScriptInterface::luaCreatureGetMaster(lua_State* L)
 		return 1;
 	}
 
-	pushUserdata<Creature>(L, master);
-	setCreatureMetatable(L, -1, master);
+	pushCreature(L, master);
 	return 1;
 }
 
@@ -8520,8 +8782,7 @@ int LuaScriptInterface::luaCreatureGetSummons(lua_State* L)
 
 	int index = 0;
 	for (Creature* summon : creature->getSummons()) {
-		pushUserdata<Creature>(L, summon);
-		setCreatureMetatable(L, -1, summon);
+		pushCreature(L, summon);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -8644,8 +8905,7 @@ int LuaScriptInterface::luaPlayerCreate(lua_State* L)
 	}
 
 	if (player) {
-		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		pushCreature(L, player);
 	} else {
 		lua_pushnil(L);
 	}
@@ -8792,6 +9052,9 @@ int LuaScriptInterface::luaPlayerGetDepotChest(lua_State* L)
 		return 1;
 	}
 
+	// scripts expect the contents right away
+	IOLoginData::loadDepots(player);
+
 	uint32_t depotId = getNumber<uint32_t>(L, 2);
 	bool autoCreate = getBoolean(L, 3, false);
 	DepotChest* depotChest = player->getDepotChest(depotId, autoCreate);
@@ -8813,6 +9076,8 @@ int LuaScriptInterface::luaPlayerGetInbox(lua_State* L)
 		return 1;
 	}
 
+	IOLoginData::loadDepots(player);
+
 	Inbox* inbox = player->getInbox();
 	if (inbox) {
 		pushUserdata<Item>(L, inbox);
@@ -10842,8 +11107,7 @@ int LuaScriptInterface::luaMonsterCreate(lua_State* L)
 	}
 
 	if (monster) {
-		pushUserdata<Monster>(L, monster);
-		setMetatable(L, -1, "Monster");
+		pushCreature(L, monster);
 	} else {
 		lua_pushnil(L);
 	}
@@ -11049,8 +11313,7 @@ int LuaScriptInterface::luaMonsterGetFriendList(lua_State* L)
 
 	int index = 0;
 	for (Creature* creature : friendList) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11125,8 +11388,7 @@ int LuaScriptInterface::luaMonsterGetTargetList(lua_State* L)
 
 	int index = 0;
 	for (Creature* creature : targetList) {
-		pushUserdata<Creature>(L, creature);
-		setCreatureMetatable(L, -1, creature);
+		pushCreature(L, creature);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -11224,8 +11486,7 @@ int LuaScriptInterface::luaNpcCreate(lua_State* L)
 	}
 
 	if (npc) {
-		pushUserdata<Npc>(L, npc);
-		setMetatable(L, -1, "Npc");
+		pushCreature(L, npc);
 	} else {
 		lua_pushnil(L);
 	}
@@ -11366,8 +11627,7 @@ int LuaScriptInterface::luaGuildGetMembersOnline(lua_State* L)
 
 	int index = 0;
 	for (Player* player : members) {
-		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		pushCreature(L, player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -12350,14 +12610,40 @@ int LuaScriptInterface::luaHouseKickPlayer(lua_State* L)
 
 int LuaScriptInterface::luaHouseSave(lua_State* L)
 {
-	// house:save()
+	// house:save([callback])
+	// the items are written asynchronously, callback(success) is called once they are
 	House* house = getUserdata<House>(L, 1);
 	if (!house) {
 		lua_pushnil(L);
 		return 1;
 	}
 
-	pushBoolean(L, IOMapSerialize::saveHouse(house));
+	std::function<void(bool)> callback;
+	if (lua_gettop(L) > 1) {
+		int32_t ref = luaL_ref(L, LUA_REGISTRYINDEX);
+		auto scriptId = getScriptEnv()->getScriptId();
+		callback = [ref, scriptId](bool success) {
+			lua_State* luaState = g_luaEnvironment.getLuaState();
+			if (!luaState) {
+				return;
+			}
+
+			if (!LuaScriptInterface::reserveScriptEnv()) {
+				luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
+				return;
+			}
+
+			lua_rawgeti(luaState, LUA_REGISTRYINDEX, ref);
+			pushBoolean(luaState, success);
+			auto env = getScriptEnv();
+			env->setScriptId(scriptId, &g_luaEnvironment);
+			g_luaEnvironment.callVoidFunction(1);
+
+			luaL_unref(luaState, LUA_REGISTRYINDEX, ref);
+		};
+	}
+
+	pushBoolean(L, IOMapSerialize::saveHouse(house, std::move(callback)));
 	return 1;
 }
 
@@ -12857,9 +13143,11 @@ int LuaScriptInterface::luaItemTypeGetClassification(lua_State* L)
 int LuaScriptInterface::luaItemTypeGetAbilities(lua_State* L)
 {
 	// itemType:getAbilities()
-	ItemType* itemType = getUserdata<ItemType>(L, 1);
+	const ItemType* itemType = getUserdata<const ItemType>(L, 1);
 	if (itemType) {
-		Abilities& abilities = itemType->getAbilities();
+		// looking at the abilities of an item does not allocate them
+		static const Abilities noAbilities;
+		const Abilities& abilities = itemType->abilities ? *itemType->abilities : noAbilities;
 		lua_createtable(L, 10, 12);
 		setField(L, "healthGain", abilities.healthGain);
 		setField(L, "healthTicks", abilities.healthTicks);
@@ -13157,11 +13445,7 @@ int LuaScriptInterface::luaItemTypeGetElementType(lua_State* L)
 	}
 
 	auto& abilities = itemType->abilities;
-	if (abilities) {
-		lua_pushnumber(L, abilities->elementType);
-	} else {
-		lua_pushnil(L);
-	}
+	lua_pushnumber(L, abilities ? abilities->elementType : COMBAT_NONE);
 	return 1;
 }
 
@@ -13175,11 +13459,7 @@ int LuaScriptInterface::luaItemTypeGetElementDamage(lua_State* L)
 	}
 
 	auto& abilities = itemType->abilities;
-	if (abilities) {
-		lua_pushnumber(L, abilities->elementDamage);
-	} else {
-		lua_pushnil(L);
-	}
+	lua_pushnumber(L, abilities ? abilities->elementDamage : 0);
 	return 1;
 }
 
@@ -15385,8 +15665,7 @@ int LuaScriptInterface::luaPartyGetLeader(lua_State* L)
 
 	Player* leader = party->getLeader();
 	if (leader) {
-		pushUserdata<Player>(L, leader);
-		setMetatable(L, -1, "Player");
+		pushCreature(L, leader);
 	} else {
 		lua_pushnil(L);
 	}
@@ -15418,8 +15697,7 @@ int LuaScriptInterface::luaPartyGetMembers(lua_State* L)
 	int index = 0;
 	lua_createtable(L, party->getMemberCount(), 0);
 	for (Player* player : party->getMembers()) {
-		pushUserdata<Player>(L, player);
-		setMetatable(L, -1, "Player");
+		pushCreature(L, player);
 		lua_rawseti(L, -2, ++index);
 	}
 	return 1;
@@ -15446,8 +15724,7 @@ int LuaScriptInterface::luaPartyGetInvitees(lua_State* L)
 
 		int index = 0;
 		for (Player* player : party->getInvitees()) {
-			pushUserdata<Player>(L, player);
-			setMetatable(L, -1, "Player");
+			pushCreature(L, player);
 			lua_rawseti(L, -2, ++index);
 		}
 	} else {
@@ -17876,28 +18153,29 @@ int LuaScriptInterface::luaWeaponExtraElement(lua_State* L)
 	if (weapon) {
 		uint16_t id = weapon->getID();
 		ItemType& it = Item::items.getItemType(id);
-		it.abilities.get()->elementDamage = getNumber<uint16_t>(L, 2);
+		Abilities& abilities = it.getAbilities();
+		abilities.elementDamage = getNumber<uint16_t>(L, 2);
 
 		if (!getNumber<CombatType_t>(L, 3)) {
 			std::string element = getString(L, 3);
 			std::string tmpStrValue = boost::algorithm::to_lower_copy(element);
 			if (tmpStrValue == "earth") {
-				it.abilities.get()->elementType = COMBAT_EARTHDAMAGE;
+				abilities.elementType = COMBAT_EARTHDAMAGE;
 			} else if (tmpStrValue == "ice") {
-				it.abilities.get()->elementType = COMBAT_ICEDAMAGE;
+				abilities.elementType = COMBAT_ICEDAMAGE;
 			} else if (tmpStrValue == "energy") {
-				it.abilities.get()->elementType = COMBAT_ENERGYDAMAGE;
+				abilities.elementType = COMBAT_ENERGYDAMAGE;
 			} else if (tmpStrValue == "fire") {
-				it.abilities.get()->elementType = COMBAT_FIREDAMAGE;
+				abilities.elementType = COMBAT_FIREDAMAGE;
 			} else if (tmpStrValue == "death") {
-				it.abilities.get()->elementType = COMBAT_DEATHDAMAGE;
+				abilities.elementType = COMBAT_DEATHDAMAGE;
 			} else if (tmpStrValue == "holy") {
-				it.abilities.get()->elementType = COMBAT_HOLYDAMAGE;
+				abilities.elementType = COMBAT_HOLYDAMAGE;
 			} else {
 				std::cout << "[Warning - weapon:extraElement] Type \"" << element << "\" does not exist." << std::endl;
 			}
 		} else {
-			it.abilities.get()->elementType = getNumber<CombatType_t>(L, 3);
+			abilities.elementType = getNumber<CombatType_t>(L, 3);
 		}
 		pushBoolean(L, true);
 	} else {
@@ -18060,14 +18338,38 @@ LuaEnvironment::~LuaEnvironment()
 
 bool LuaEnvironment::initState()
 {
+#ifdef LUAJIT_VERSION
+	// LuaJIT manages its own memory and does not take an allocator on 64 bit targets
 	luaState = luaL_newstate();
+#else
+	luaState = lua_newstate(LuaAllocator::allocate, &LuaAllocator::getInstance());
+#endif
 	if (!luaState) {
 		return false;
 	}
 
+#ifndef LUAJIT_VERSION
+	// luaL_newstate sets this up itself
+	lua_atpanic(luaState, [](lua_State* L) {
+		const char* message = lua_tostring(L, -1);
+		std::cout << "[Error - LuaEnvironment] Unprotected error in Lua: " << (message ? message : "(not a string)")
+		          << std::endl;
+		return 0;
+	});
+#endif
+
 	luaL_openlibs(luaState);
+	metatableRefs.fill(LUA_NOREF);
 	registerFunctions();
 
+	// creature userdata by id, weak so that a creature no script holds anymore is collected
+	lua_newtable(luaState);
+	lua_createtable(luaState, 0, 1);
+	pushString(luaState, "v");
+	lua_setfield(luaState, -2, "__mode");
+	lua_setmetatable(luaState, -2);
+	creatureCacheRef = luaL_ref(luaState, LUA_REGISTRYINDEX);
+
 	runningEventId = EVENT_ID_USER;
 	return true;
 }
@@ -18106,11 +18408,107 @@ bool LuaEnvironment::closeState()
 	timerEvents.clear();
 	cacheFiles.clear();
 
+	for (auto& slot : timerWheel) {
+		slot.clear();
+	}
+
+	if (timerWheelEventId != 0) {
+		// a no-op once the scheduler was shut down, ~LuaEnvironment calls this after that
+		g_scheduler.stopEvent(timerWheelEventId);
+		timerWheelEventId = 0;
+	}
+
+	creatureCacheRef = LUA_NOREF;
+	gcThreshold = 0;
+	gcStopped = false;
+	gcCycleRunning = false;
+
 	lua_close(luaState);
 	luaState = nullptr;
 	return true;
 }
 
+void LuaEnvironment::collectGarbage()
+{
+	if (!luaState) {
+		return;
+	}
+
+	const int64_t budget = g_config.getNumber(ConfigManager::LUA_GC_STEP_BUDGET);
+	if (budget <= 0) {
+		if (gcStopped) {
+			lua_gc(luaState, LUA_GCRESTART, 0);
+			gcStopped = false;
+		}
+		return;
+	}
+
+	if (!gcStopped) {
+#if LUA_VERSION_NUM >= 504
+		// a generational step with a step size of 0 is only ever a minor collection, the old generation would never
+		// be collected, so Lua 5.4 steps through incremental cycles like the older versions
+		lua_gc(luaState, LUA_GCINC, 0, g_config.getNumber(ConfigManager::LUA_GC_STEPMUL), 0);
+#else
+		lua_gc(luaState, LUA_GCSETSTEPMUL, g_config.getNumber(ConfigManager::LUA_GC_STEPMUL));
+#endif
+		lua_gc(luaState, LUA_GCSTOP, 0);
+		gcStopped = true;
+	}
+
+	if (!gcCycleRunning) {
+		gcStats.heapSize = getHeapSize();
+		if (gcStats.heapSize < gcThreshold) {
+			return;
+		}
+		gcCycleRunning = true;
+	}
+
+	const auto startedAt = std::chrono::steady_clock::now();
+	const auto deadline = startedAt + std::chrono::microseconds(budget);
+	do {
+		++gcStats.steps;
+		gcCycleRunning = lua_gc(luaState, LUA_GCSTEP, 0) == 0;
+	} while (gcCycleRunning && std::chrono::steady_clock::now() < deadline);
+
+	// a step lets the collector run on its own again in Lua 5.1
+	lua_gc(luaState, LUA_GCSTOP, 0);
+
+	const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+	gcStats.micros += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	gcStats.heapSize = getHeapSize();
+	if (!gcCycleRunning) {
+		++gcStats.cycles;
+		gcThreshold = gcStats.heapSize / 100 * std::max<int64_t>(g_config.getNumber(ConfigManager::LUA_GC_PAUSE), 100);
+	}
+}
+
+void LuaEnvironment::collectAllGarbage()
+{
+	if (!luaState) {
+		return;
+	}
+
+	const auto startedAt = std::chrono::steady_clock::now();
+	lua_gc(luaState, LUA_GCCOLLECT, 0);
+
+	// a full collection lets the collector run on its own again in Lua 5.1
+	if (gcStopped) {
+		lua_gc(luaState, LUA_GCSTOP, 0);
+	}
+
+	const auto elapsed = std::chrono::steady_clock::now() - startedAt;
+	gcStats.micros += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	gcStats.heapSize = getHeapSize();
+	++gcStats.cycles;
+	gcCycleRunning = false;
+	gcThreshold = gcStats.heapSize / 100 * std::max<int64_t>(g_config.getNumber(ConfigManager::LUA_GC_PAUSE), 100);
+}
+
+size_t LuaEnvironment::getHeapSize() const
+{
+	return static_cast<size_t>(lua_gc(luaState, LUA_GCCOUNT, 0)) * 1024 + lua_gc(luaState, LUA_GCCOUNTB, 0);
+}
+
 LuaScriptInterface* LuaEnvironment::getTestInterface()
 {
 	if (!testInterface) {
@@ -18186,37 +18584,121 @@ void LuaEnvironment::clearAreaObjects(LuaScriptInterface* interface)
 	it->second.clear();
 }
 
-void LuaEnvironment::executeTimerEvent(uint32_t eventIndex)
+uint32_t LuaEnvironment::addTimerEvent(LuaTimerEventDesc&& timerEventDesc, uint32_t delay)
+{
+	const int64_t now = OTSYS_TIME();
+	if (timerWheelEventId == 0) {
+		// the wheel stood still, no earlier tick has timers left
+		timerWheelTick = now / TIMER_WHEEL_TICK;
+		timerWheelEventId = g_scheduler.addEvent(
+		    createSchedulerTask(TIMER_WHEEL_TICK, []() { g_luaEnvironment.executeTimerEvents(); }));
+	}
+
+	const uint32_t eventId = lastEventTimerId++;
+	timerEventDesc.dueTick = (now + delay + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK;
+	timerWheel[timerEventDesc.dueTick % TIMER_WHEEL_SLOTS].push_back(eventId);
+	timerEvents.emplace(eventId, std::move(timerEventDesc));
+	return eventId;
+}
+
+bool LuaEnvironment::stopTimerEvent(uint32_t eventId)
 {
-	auto it = timerEvents.find(eventIndex);
+	auto it = timerEvents.find(eventId);
 	if (it == timerEvents.end()) {
-		return;
+		return false;
 	}
 
-	LuaTimerEventDesc timerEventDesc = std::move(it->second);
+	// the id is left in its slot, and dropped when the slot is executed
+	luaL_unref(luaState, LUA_REGISTRYINDEX, it->second.function);
+	for (auto parameter : it->second.parameters) {
+		luaL_unref(luaState, LUA_REGISTRYINDEX, parameter);
+	}
 	timerEvents.erase(it);
+	return true;
+}
 
-	// push function
-	lua_rawgeti(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
+void LuaEnvironment::executeTimerEvents()
+{
+	timerWheelEventId = 0;
 
-	// push parameters
-	for (auto parameter : boost::adaptors::reverse(timerEventDesc.parameters)) {
-		lua_rawgeti(luaState, LUA_REGISTRYINDEX, parameter);
+	std::vector<uint32_t> dueEvents;
+	const int64_t now = OTSYS_TIME() / TIMER_WHEEL_TICK;
+	for (; timerWheelTick <= now; ++timerWheelTick) {
+		std::vector<uint32_t>& slot = timerWheel[timerWheelTick % TIMER_WHEEL_SLOTS];
+		auto waiting = slot.begin();
+		for (uint32_t eventId : slot) {
+			auto it = timerEvents.find(eventId);
+			if (it == timerEvents.end()) {
+				continue;
+			}
+
+			if (it->second.dueTick <= timerWheelTick) {
+				dueEvents.push_back(eventId);
+			} else {
+				*waiting++ = eventId;
+			}
+		}
+		slot.erase(waiting, slot.end());
 	}
 
-	// call the function
-	if (reserveScriptEnv()) {
-		ScriptEnvironment* env = getScriptEnv();
-		env->setTimerEvent();
-		env->setScriptId(timerEventDesc.scriptId, this);
-		callFunction(timerEventDesc.parameters.size());
-	} else {
-		std::cout << "[Error - LuaScriptInterface::executeTimerEvent] Call stack overflow" << std::endl;
+	if (!dueEvents.empty()) {
+		if (reserveScriptEnv()) {
+			ScriptEnvironment* env = getScriptEnv();
+
+			std::vector<int32_t> references;
+			for (uint32_t eventId : dueEvents) {
+				// an earlier timer of the batch may have stopped it
+				auto it = timerEvents.find(eventId);
+				if (it == timerEvents.end()) {
+					continue;
+				}
+
+				LuaTimerEventDesc timerEventDesc = std::move(it->second);
+				timerEvents.erase(it);
+
+				// push function
+				lua_rawgeti(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
+
+				// push parameters
+				for (auto parameter : boost::adaptors::reverse(timerEventDesc.parameters)) {
+					lua_rawgeti(luaState, LUA_REGISTRYINDEX, parameter);
+				}
+
+				// call the function, the whole batch shares the script environment
+				env->setTimerEvent();
+				env->setScriptId(timerEventDesc.scriptId, this);
+				callVoidFunction(timerEventDesc.parameters.size(), false);
+				env->resetEnv();
+
+				references.push_back(timerEventDesc.function);
+				references.insert(references.end(), timerEventDesc.parameters.begin(),
+				                  timerEventDesc.parameters.end());
+			}
+			resetScriptEnv();
+
+			// free resources
+			for (int32_t reference : references) {
+				luaL_unref(luaState, LUA_REGISTRYINDEX, reference);
+			}
+		} else {
+			std::cout << "[Error - LuaScriptInterface::executeTimerEvents] Call stack overflow" << std::endl;
+			for (uint32_t eventId : dueEvents) {
+				stopTimerEvent(eventId);
+			}
+		}
 	}
 
-	// free resources
-	luaL_unref(luaState, LUA_REGISTRYINDEX, timerEventDesc.function);
-	for (auto parameter : timerEventDesc.parameters) {
-		luaL_unref(luaState, LUA_REGISTRYINDEX, parameter);
+	if (timerEvents.empty()) {
+		// stopped timers may have left their ids behind
+		for (auto& slot : timerWheel) {
+			slot.clear();
+		}
+		return;
+	}
+
+	// timers added by the batch have started the wheel again already
+	if (timerWheelEventId == 0) {
+		timerWheelEventId = g_scheduler.addEvent(
+		    createSchedulerTask(TIMER_WHEEL_TICK, []() { g_luaEnvironment.executeTimerEvents(); }));
 	}
 }
@@ -56,12 +56,27 @@ enum LuaDataType
 	LuaData_Tile,
 };
 
+struct LuaGcStats
+{
+	uint64_t steps = 0;
+	uint64_t cycles = 0;
+	uint64_t micros = 0; // spent in the steps
+	size_t heapSize = 0; // bytes after the last step
+};
+
+struct LuaLoadStats
+{
+	size_t files = 0;
+	size_t cached = 0; // loaded from the bytecode cache
+	int64_t micros = 0;
+};
+
 struct LuaTimerEventDesc
 {
 	int32_t scriptId = -1;
 	int32_t function = -1;
 	std::vector<int32_t> parameters;
-	uint32_t eventId = 0;
+	int64_t dueTick = 0;
 
 	LuaTimerEventDesc() = default;
 	LuaTimerEventDesc(LuaTimerEventDesc&& other) = default;
@@ -172,6 +187,12 @@ public:
 
 	int32_t loadFile(const std::string& file, Npc* npc = nullptr);
 
+	/**
+	 * Prints how long the files loaded since the last report took, by
+	 * directory, and starts counting again.
+	 */
+	static void reportLoadStats();
+
 	const std::string& getFileById(int32_t scriptId);
 	int32_t getEvent(const std::string& eventName);
 	int32_t getEvent();
@@ -203,7 +224,7 @@ public:
 
 	static int luaErrorHandler(lua_State* L);
 	bool callFunction(int params);
-	void callVoidFunction(int params);
+	void callVoidFunction(int params, bool resetEnv = true);
 
 	// push/pop common structures
 	static void pushThing(lua_State* L, Thing* thing);
@@ -212,6 +233,12 @@ public:
 	static void pushCallback(lua_State* L, int32_t callback);
 	static void pushCylinder(lua_State* L, Cylinder* cylinder);
 
+	/**
+	 * Pushes the userdata of a creature with its metatable. While a script
+	 * still holds it, the same userdata is pushed again instead of a new one.
+	 */
+	static void pushCreature(lua_State* L, Creature* creature);
+
 	static std::string popString(lua_State* L);
 	static int32_t popCallback(lua_State* L);
 
@@ -232,6 +259,7 @@ public:
 
 	// Metatables
 	static void setMetatable(lua_State* L, int32_t index, const std::string& name);
+	static void setMetatable(lua_State* L, int32_t index, LuaDataType type);
 	static void setWeakMetatable(lua_State* L, int32_t index, const std::string& name);
 
 	static void setItemMetatable(lua_State* L, int32_t index, const Item* item);
@@ -391,10 +419,17 @@ protected:
 
 	int32_t eventTableRef = -1;
 	int32_t runningEventId = EVENT_ID_USER;
+	uint16_t memoryOwner;
 
 	// script file cache
 	std::map<int32_t, std::string> cacheFiles;
 
+	// registry references of the class metatables by LuaDataType and of the creature userdata cache
+	static std::array<int, LuaData_Tile + 1> metatableRefs;
+	static int creatureCacheRef;
+
+	static std::map<std::string, LuaLoadStats> loadStats;
+
 private:
 	void registerClass(const std::string& className, const std::string& baseClass, lua_CFunction newFunction = nullptr);
 	void registerTable(const std::string& tableName);
@@ -538,6 +573,11 @@ private:
 
 	static int luaGameReload(lua_State* L);
 
+	static int luaGameStartLuaProfiler(lua_State* L);
+	static int luaGameStopLuaProfiler(lua_State* L);
+	static int luaGameDumpLuaProfile(lua_State* L);
+	static int luaGameGetLuaMemoryUsage(lua_State* L);
+
 	static int luaGameGetAccountStorageValue(lua_State* L);
 	static int luaGameSetAccountStorageValue(lua_State* L);
 	static int luaGameSaveAccountStorageValues(lua_State* L);
@@ -1601,10 +1641,35 @@ public:
 	uint32_t createAreaObject(LuaScriptInterface* interface);
 	void clearAreaObjects(LuaScriptInterface* interface);
 
+	/**
+	 * Runs the garbage collector for up to luaGcStepBudget microseconds.
+	 * Called by the dispatcher between task batches, the collector does not
+	 * run anywhere else unless the budget is 0.
+	 */
+	void collectGarbage();
+
+	/**
+	 * Runs a whole collection now, e.g. after a reload, and keeps the
+	 * collector stopped if collectGarbage stopped it.
+	 */
+	void collectAllGarbage();
+	const LuaGcStats& getGcStats() const { return gcStats; }
+
 private:
-	void executeTimerEvent(uint32_t eventIndex);
+	// the timers of addEvent wait in a wheel of slots one scheduler tick (SCHEDULER_MINTICKS) long, timers due more
+	// than a round of the wheel later wait in their slot until that round comes
+	static constexpr int64_t TIMER_WHEEL_TICK = 50;
+	static constexpr size_t TIMER_WHEEL_SLOTS = 512;
+
+	uint32_t addTimerEvent(LuaTimerEventDesc&& timerEventDesc, uint32_t delay);
+	bool stopTimerEvent(uint32_t eventId);
+	void executeTimerEvents();
+	size_t getHeapSize() const;
 
 	std::unordered_map<uint32_t, LuaTimerEventDesc> timerEvents;
+	std::array<std::vector<uint32_t>, TIMER_WHEEL_SLOTS> timerWheel;
+	int64_t timerWheelTick = 0; // the next tick to execute
+	uint32_t timerWheelEventId = 0;
 	std::unordered_map<uint32_t, Combat_ptr> combatMap;
 	std::unordered_map<uint32_t, AreaCombat*> areaMap;
 
@@ -1617,6 +1682,11 @@ private:
 	uint32_t lastCombatId = 0;
 	uint32_t lastAreaId = 0;
 
+	LuaGcStats gcStats;
+	size_t gcThreshold = 0;
+	bool gcStopped = false;
+	bool gcCycleRunning = false;
+
 	friend class LuaScriptInterface;
 	friend class CombatSpell;
 };
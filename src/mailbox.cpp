@@ -82,6 +82,7 @@ bool Mailbox::sendItem(Item* item) const
 
 	Player* player = g_game.getPlayerByName(receiver);
 	if (player) {
+		player->loadDepots();
 		if (g_game.internalMoveItem(item->getParent(), player->getInbox(), INDEX_WHEREEVER, item, item->getItemCount(),
 		                            nullptr, FLAG_NOLIMIT) == RETURNVALUE_NOERROR) {
 			g_game.transformItem(item, item->getID() + 1);
@@ -89,17 +90,19 @@ bool Mailbox::sendItem(Item* item) const
 			return true;
 		}
 	} else {
-		Player tmpPlayer(nullptr);
-		if (!IOLoginData::loadPlayerByName(&tmpPlayer, receiver)) {
+		const uint32_t guid = IOLoginData::getGuidByName(receiver);
+		if (guid == 0) {
 			return false;
 		}
 
-		if (g_game.internalMoveItem(item->getParent(), tmpPlayer.getInbox(), INDEX_WHEREEVER, item,
-		                            item->getItemCount(), nullptr, FLAG_NOLIMIT) == RETURNVALUE_NOERROR) {
-			g_game.transformItem(item, item->getID() + 1);
-			IOLoginData::savePlayer(&tmpPlayer);
-			return true;
+		// stamped before it leaves the mailbox, an offline receiver gets it written straight into the database
+		Item* mail = g_game.transformItem(item, item->getID() + 1);
+		if (!mail) {
+			return false;
 		}
+
+		g_game.sendToInbox(guid, {mail});
+		return true;
 	}
 	return false;
 }
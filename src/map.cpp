@@ -17,11 +17,33 @@ extern Game g_game;
 
 bool Map::loadMap(const std::string& identifier, bool loadHouses)
 {
+	if (!loadTiles(identifier)) {
+		return false;
+	}
+
+	loadSpawnsAndHouses(loadHouses);
+	return true;
+}
+
+bool Map::loadTiles(const std::string& identifier)
+{
+	DeferUniqueIds deferUniqueIds(loadedUniqueItems);
+	DeferDecay deferDecay(loadedDecayItems);
+
 	IOMap loader;
 	if (!loader.loadMap(this, identifier)) {
 		std::cout << "[Fatal - Map::loadMap] " << loader.getLastErrorString() << std::endl;
 		return false;
 	}
+	return true;
+}
+
+void Map::loadSpawnsAndHouses(bool loadHouses)
+{
+	Item::registerUniqueIds(loadedUniqueItems);
+	loadedUniqueItems.clear();
+	Item::startDecays(loadedDecayItems);
+	loadedDecayItems.clear();
 
 	if (!IOMap::loadSpawns(this)) {
 		std::cout << "[Warning - Map::loadMap] Failed to load spawn data." << std::endl;
@@ -35,14 +57,13 @@ bool Map::loadMap(const std::string& identifier, bool loadHouses)
 		IOMapSerialize::loadHouseInfo();
 		IOMapSerialize::loadHouseItems(this);
 	}
-	return true;
 }
 
-bool Map::save()
+bool Map::save(Database& db, const HousesSnapshot& snapshot)
 {
 	bool saved = false;
 	for (uint32_t tries = 0; tries < 3; tries++) {
-		if (IOMapSerialize::saveHouseInfo()) {
+		if (IOMapSerialize::saveHouseInfo(db, snapshot)) {
 			saved = true;
 			break;
 		}
@@ -54,7 +75,7 @@ bool Map::save()
 
 	saved = false;
 	for (uint32_t tries = 0; tries < 3; tries++) {
-		if (IOMapSerialize::saveHouseItems()) {
+		if (IOMapSerialize::saveHouseItems(db, snapshot)) {
 			saved = true;
 			break;
 		}
@@ -10,6 +10,8 @@
 #include "town.h"
 
 class Creature;
+class Database;
+struct HousesSnapshot;
 
 static constexpr int32_t MAP_MAX_LAYERS = 16;
 
@@ -164,10 +166,24 @@ public:
 	bool loadMap(const std::string& identifier, bool loadHouses);
 
 	/**
-	 * Save a map.
+	 * Load the tiles of a map, which only needs the item types. Used by the
+	 * startup to parse the map while the scripts are loaded.
+	 * \returns true if the tiles were loaded successfully
+	 */
+	bool loadTiles(const std::string& identifier);
+
+	/**
+	 * Load the spawns and optionally the houses of a map whose tiles have been
+	 * loaded, which needs the monsters and npcs. The unique ids and decay of
+	 * the loaded items are registered here, on the dispatcher.
+	 */
+	void loadSpawnsAndHouses(bool loadHouses);
+
+	/**
+	 * Save the houses of a map, from a snapshot taken by IOMapSerialize::snapshotHouses.
 	 * \returns true if the map was saved successfully
 	 */
-	static bool save();
+	static bool save(Database& db, const HousesSnapshot& snapshot);
 
 	/**
 	 * Get a single tile.
@@ -264,6 +280,10 @@ private:
 	std::string spawnfile;
 	std::string housefile;
 
+	// collected by loadTiles, see DeferUniqueIds and DeferDecay
+	std::vector<Item*> loadedUniqueItems;
+	std::vector<Item*> loadedDecayItems;
+
 	uint32_t width = 0;
 	uint32_t height = 0;
 
@@ -0,0 +1,317 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "metrics.h"
+
+#include "databasetasks.h"
+#include "game.h"
+#include "luaallocator.h"
+#include "luascript.h"
+#include "scheduler.h"
+
+extern Game g_game;
+extern LuaEnvironment g_luaEnvironment;
+
+struct MetricsSnapshot
+{
+	size_t players = 0;
+	size_t monsters = 0;
+	size_t npcs = 0;
+	size_t decayingItems = 0;
+	LuaGcStats gcStats;
+	std::vector<LuaMemoryStats> luaMemory;
+	int64_t takenAt = 0;
+};
+
+namespace {
+
+constexpr uint32_t SNAPSHOT_INTERVAL = 1000;
+constexpr size_t MAX_REQUEST_SIZE = 4096;
+constexpr int REQUEST_TIMEOUT = 5;
+constexpr int ACCEPT_RETRY_DELAY = 1;
+
+double toSeconds(uint64_t micros) { return micros / 1000000.; }
+
+std::string escapeLabel(const std::string& value)
+{
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (char c : value) {
+		if (c == '\\' || c == '"') {
+			escaped.push_back('\\');
+		} else if (c == '\n') {
+			escaped.append("\\n");
+			continue;
+		}
+		escaped.push_back(c);
+	}
+	return escaped;
+}
+
+void addHeader(std::string& text, std::string_view name, std::string_view type, std::string_view help)
+{
+	text += fmt::format("# HELP {:s} {:s}\n# TYPE {:s} {:s}\n", name, help, name, type);
+}
+
+template <typename T>
+void addMetric(std::string& text, std::string_view name, std::string_view type, std::string_view help, T value)
+{
+	addHeader(text, name, type, help);
+	text += fmt::format("{:s} {}\n", name, value);
+}
+
+class MetricsRequest : public std::enable_shared_from_this<MetricsRequest>
+{
+public:
+	explicit MetricsRequest(boost::asio::io_service& io_service) : socket(io_service), timer(io_service) {}
+
+	boost::asio::ip::tcp::socket& getSocket() { return socket; }
+
+	void start();
+
+private:
+	void onRead(const boost::system::error_code& error);
+	void respond(std::string_view status, const std::string& body);
+	void close();
+
+	boost::asio::ip::tcp::socket socket;
+	boost::asio::steady_timer timer;
+	boost::asio::streambuf buffer{MAX_REQUEST_SIZE};
+	std::string response;
+};
+
+void MetricsRequest::start()
+{
+	timer.expires_from_now(std::chrono::seconds(REQUEST_TIMEOUT));
+	timer.async_wait([thisPtr = std::weak_ptr<MetricsRequest>(shared_from_this())](
+	                     const boost::system::error_code& error) {
+		if (error == boost::asio::error::operation_aborted) {
+			return;
+		}
+
+		if (auto request = thisPtr.lock()) {
+			request->close();
+		}
+	});
+
+	boost::asio::async_read_until(
+	    socket, buffer, "\r\n\r\n",
+	    [thisPtr = shared_from_this()](const boost::system::error_code& error, size_t) { thisPtr->onRead(error); });
+}
+
+void MetricsRequest::onRead(const boost::system::error_code& error)
+{
+	// a request that does not fit the buffer fails with not_found
+	if (error) {
+		close();
+		return;
+	}
+
+	std::istream stream(&buffer);
+	std::string method, target;
+	stream >> method >> target;
+
+	if (method != "GET") {
+		respond("405 Method Not Allowed", "Method Not Allowed\n");
+		return;
+	}
+
+	if (target.substr(0, target.find('?')) != "/metrics") {
+		respond("404 Not Found", "Not Found\n");
+		return;
+	}
+
+	respond("200 OK", g_metrics.getText());
+}
+
+void MetricsRequest::respond(std::string_view status, const std::string& body)
+{
+	response = fmt::format(
+	    "HTTP/1.1 {:s}\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: {:d}\r\n"
+	    "Connection: close\r\n\r\n",
+	    status, body.size());
+	response += body;
+
+	boost::asio::async_write(
+	    socket, boost::asio::buffer(response),
+	    [thisPtr = shared_from_this()](const boost::system::error_code&, size_t) { thisPtr->close(); });
+}
+
+void MetricsRequest::close()
+{
+	timer.cancel();
+
+	boost::system::error_code error;
+	socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, error);
+	socket.close(error);
+}
+
+} // namespace
+
+void Metrics::start() { takeSnapshot(); }
+
+void Metrics::takeSnapshot()
+{
+	auto newSnapshot = std::make_shared<MetricsSnapshot>();
+	newSnapshot->players = g_game.getPlayersOnline();
+	newSnapshot->monsters = g_game.getMonstersOnline();
+	newSnapshot->npcs = g_game.getNpcsOnline();
+	newSnapshot->decayingItems = g_game.getDecayingItems();
+	newSnapshot->gcStats = g_luaEnvironment.getGcStats();
+	newSnapshot->luaMemory = LuaAllocator::getInstance().getStats();
+	newSnapshot->takenAt = OTSYS_TIME();
+	std::atomic_store(&snapshot, std::shared_ptr<const MetricsSnapshot>(std::move(newSnapshot)));
+
+	g_scheduler.addEvent(createSchedulerTask(SNAPSHOT_INTERVAL, [this]() { takeSnapshot(); }));
+}
+
+std::string Metrics::getText() const
+{
+	std::string text;
+	text.reserve(8192);
+
+	const DispatcherStats dispatcher = g_dispatcher.getStats();
+	addMetric(text, "tfs_dispatcher_queue_size", "gauge", "Tasks waiting for the dispatcher.", dispatcher.queueSize);
+	addMetric(text, "tfs_dispatcher_tasks_total", "counter", "Tasks executed by the dispatcher.", dispatcher.tasks);
+	addMetric(text, "tfs_dispatcher_expired_tasks_total", "counter", "Tasks dropped because they expired in the queue.",
+	          dispatcher.expiredTasks);
+	addMetric(text, "tfs_dispatcher_wait_seconds_total", "counter",
+	          "Time the batches of tasks waited from their first task being added until they started.",
+	          toSeconds(dispatcher.waitMicros));
+
+	addHeader(text, "tfs_dispatcher_batch_seconds", "histogram",
+	          "Time the dispatcher took for a batch of tasks, including the Lua garbage collection after it.");
+	uint64_t batches = 0;
+	for (size_t i = 0; i < DISPATCHER_BATCH_BUCKETS.size(); ++i) {
+		batches += dispatcher.batchBuckets[i];
+		text += fmt::format("tfs_dispatcher_batch_seconds_bucket{{le=\"{}\"}} {:d}\n",
+		                    toSeconds(DISPATCHER_BATCH_BUCKETS[i]), batches);
+	}
+	text += fmt::format("tfs_dispatcher_batch_seconds_bucket{{le=\"+Inf\"}} {:d}\n", dispatcher.batches);
+	text += fmt::format("tfs_dispatcher_batch_seconds_sum {}\n", toSeconds(dispatcher.busyMicros));
+	text += fmt::format("tfs_dispatcher_batch_seconds_count {:d}\n", dispatcher.batches);
+
+	addMetric(text, "tfs_scheduler_events", "gauge", "Scheduler events waiting for their timer.",
+	          g_scheduler.getEventCount());
+
+	const DatabaseTasksStats database = g_databaseTasks.getStats();
+	addHeader(text, "tfs_database_queue_size", "gauge",
+	          "Database tasks waiting, for one worker or for any worker (worker=\"any\").");
+	text += fmt::format("tfs_database_queue_size{{worker=\"any\"}} {:d}\n", database.queueSize);
+	for (size_t i = 0; i < database.workers.size(); ++i) {
+		text += fmt::format("tfs_database_queue_size{{worker=\"{:d}\"}} {:d}\n", i, database.workers[i].queueSize);
+	}
+
+	addHeader(text, "tfs_database_tasks_total", "counter", "Database tasks executed.");
+	for (size_t i = 0; i < database.workers.size(); ++i) {
+		text += fmt::format("tfs_database_tasks_total{{worker=\"{:d}\"}} {:d}\n", i, database.workers[i].executed);
+	}
+
+	addHeader(text, "tfs_database_task_seconds_total", "counter", "Time spent executing database tasks.");
+	for (size_t i = 0; i < database.workers.size(); ++i) {
+		text += fmt::format("tfs_database_task_seconds_total{{worker=\"{:d}\"}} {}\n", i,
+		                    toSeconds(database.workers[i].busyMicros));
+	}
+
+	addHeader(text, "tfs_database_task_wait_seconds_total", "counter",
+	          "Time the executed database tasks waited in the queues.");
+	for (size_t i = 0; i < database.workers.size(); ++i) {
+		text += fmt::format("tfs_database_task_wait_seconds_total{{worker=\"{:d}\"}} {}\n", i,
+		                    toSeconds(database.workers[i].waitMicros));
+	}
+
+	addMetric(text, "tfs_network_received_bytes_total", "counter", "Bytes received from the clients.",
+	          bytesReceived.load(std::memory_order_relaxed));
+	addMetric(text, "tfs_network_sent_bytes_total", "counter", "Bytes sent to the clients.",
+	          bytesSent.load(std::memory_order_relaxed));
+
+	// the game state is only known once the dispatcher took its first snapshot
+	const auto currentSnapshot = std::atomic_load(&snapshot);
+	if (!currentSnapshot) {
+		return text;
+	}
+
+	addMetric(text, "tfs_snapshot_age_seconds", "gauge", "Age of the snapshot the game metrics below are taken from.",
+	          (OTSYS_TIME() - currentSnapshot->takenAt) / 1000.);
+
+	addHeader(text, "tfs_creatures", "gauge", "Creatures in the game by type, the players are the players online.");
+	text += fmt::format("tfs_creatures{{type=\"player\"}} {:d}\n", currentSnapshot->players);
+	text += fmt::format("tfs_creatures{{type=\"monster\"}} {:d}\n", currentSnapshot->monsters);
+	text += fmt::format("tfs_creatures{{type=\"npc\"}} {:d}\n", currentSnapshot->npcs);
+
+	addMetric(text, "tfs_decaying_items", "gauge", "Items waiting to decay.", currentSnapshot->decayingItems);
+
+	addMetric(text, "tfs_lua_heap_bytes", "gauge", "Memory in use by the Lua state after the last collection step.",
+	          currentSnapshot->gcStats.heapSize);
+	addMetric(text, "tfs_lua_gc_cycles_total", "counter", "Lua garbage collection cycles completed.",
+	          currentSnapshot->gcStats.cycles);
+	addMetric(text, "tfs_lua_gc_seconds_total", "counter", "Time spent in Lua garbage collection steps.",
+	          toSeconds(currentSnapshot->gcStats.micros));
+
+	addHeader(text, "tfs_lua_memory_bytes", "gauge", "Lua memory by the script interface that allocated it.");
+	for (const LuaMemoryStats& ownerStats : currentSnapshot->luaMemory) {
+		text += fmt::format("tfs_lua_memory_bytes{{owner=\"{:s}\"}} {:d}\n", escapeLabel(ownerStats.owner),
+		                    ownerStats.bytes);
+	}
+	return text;
+}
+
+MetricsPort::~MetricsPort() { close(); }
+
+bool MetricsPort::open(const std::string& address, uint16_t port)
+{
+	namespace ip = boost::asio::ip;
+
+	try {
+		acceptor = std::make_unique<ip::tcp::acceptor>(io_service,
+		                                               ip::tcp::endpoint{ip::address::from_string(address), port});
+	} catch (boost::system::system_error& e) {
+		std::cout << "[Error - MetricsPort::open] " << address << ':' << port << ": " << e.what() << std::endl;
+		return false;
+	}
+
+	accept();
+	return true;
+}
+
+void MetricsPort::close()
+{
+	retryTimer.cancel();
+
+	if (acceptor && acceptor->is_open()) {
+		boost::system::error_code error;
+		acceptor->close(error);
+	}
+}
+
+void MetricsPort::accept()
+{
+	if (!acceptor || !acceptor->is_open()) {
+		return;
+	}
+
+	auto request = std::make_shared<MetricsRequest>(io_service);
+	acceptor->async_accept(request->getSocket(), [request, thisPtr = shared_from_this()](
+	                                                 const boost::system::error_code& error) {
+		if (!error) {
+			request->start();
+			thisPtr->accept();
+			return;
+		}
+
+		if (error == boost::asio::error::operation_aborted) {
+			return;
+		}
+
+		// e.g. out of file descriptors, accepting again right away would fail the same way
+		std::cout << "[Warning - MetricsPort::accept] " << error.message() << std::endl;
+		thisPtr->retryTimer.expires_from_now(std::chrono::seconds(ACCEPT_RETRY_DELAY));
+		thisPtr->retryTimer.async_wait([thisPtr](const boost::system::error_code& timerError) {
+			if (!timerError) {
+				thisPtr->accept();
+			}
+		});
+	});
+}
@@ -0,0 +1,74 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_METRICS_H
+#define FS_METRICS_H
+
+struct MetricsSnapshot;
+
+/**
+ * Collects the metrics of the server and renders them in the Prometheus text
+ * format.
+ *
+ * Counters written from several threads are atomics. The game state may only
+ * be read on the dispatcher, which takes a snapshot of it every second, so a
+ * scrape reads the last snapshot and never waits for the dispatcher.
+ */
+class Metrics
+{
+public:
+	Metrics() = default;
+
+	// non-copyable
+	Metrics(const Metrics&) = delete;
+	Metrics& operator=(const Metrics&) = delete;
+
+	void addBytesReceived(size_t bytes) { bytesReceived.fetch_add(bytes, std::memory_order_relaxed); }
+	void addBytesSent(size_t bytes) { bytesSent.fetch_add(bytes, std::memory_order_relaxed); }
+
+	/**
+	 * Takes the first snapshot of the game state and schedules the next ones,
+	 * must be called on the dispatcher thread.
+	 */
+	void start();
+
+	std::string getText() const;
+
+private:
+	void takeSnapshot();
+
+	std::atomic<uint64_t> bytesReceived{0};
+	std::atomic<uint64_t> bytesSent{0};
+	std::shared_ptr<const MetricsSnapshot> snapshot; // only accessed through std::atomic_load and std::atomic_store
+};
+
+/**
+ * Serves the metrics over HTTP, one GET /metrics request per connection.
+ *
+ * The framed protocol of Connection cannot carry HTTP, so the port has its
+ * own acceptor on the io_service of the ServiceManager.
+ */
+class MetricsPort : public std::enable_shared_from_this<MetricsPort>
+{
+public:
+	explicit MetricsPort(boost::asio::io_service& io_service) : io_service(io_service), retryTimer(io_service) {}
+	~MetricsPort();
+
+	// non-copyable
+	MetricsPort(const MetricsPort&) = delete;
+	MetricsPort& operator=(const MetricsPort&) = delete;
+
+	bool open(const std::string& address, uint16_t port);
+	void close();
+
+private:
+	void accept();
+
+	boost::asio::io_service& io_service;
+	boost::asio::steady_timer retryTimer;
+	std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+};
+
+extern Metrics g_metrics;
+
+#endif // FS_METRICS_H
@@ -58,12 +58,16 @@ bool Monsters::loadFromXml(bool reloading /*= false*/)
 	}
 
 	bool forceLoad = g_config.getBoolean(ConfigManager::FORCE_MONSTERTYPE_LOAD);
+	bool preload = !reloading && g_config.getBoolean(ConfigManager::PRELOAD_MONSTER_TYPES);
 
-	for (auto it : unloadedMonsters) {
-		if ((forceLoad || reloading) && monsters.find(it.first) != monsters.end()) {
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& it : unloadedMonsters) {
+		// the other types are loaded on their first spawn or lookup
+		if (preload || ((forceLoad || reloading) && monsters.find(it.first) != monsters.end())) {
 			loadMonster(it.second, it.first, reloading);
 		}
 	}
+	addLoadTime(std::chrono::steady_clock::now() - start);
 
 	return true;
 }
@@ -1509,7 +1513,24 @@ MonsterType* Monsters::getMonsterType(const std::string& name, bool loadFromFile
 			return nullptr;
 		}
 
-		return loadMonster(it2->second, name);
+		const auto start = std::chrono::steady_clock::now();
+		MonsterType* mType = loadMonster(it2->second, name);
+		addLoadTime(std::chrono::steady_clock::now() - start);
+		return mType;
 	}
 	return &it->second;
 }
+
+MonsterTypeStats Monsters::getStats() const
+{
+	MonsterTypeStats stats;
+	stats.files = unloadedMonsters.size();
+	stats.loaded = monsters.size();
+	stats.loadMicros = loadMicros;
+	return stats;
+}
+
+void Monsters::addLoadTime(std::chrono::steady_clock::duration duration)
+{
+	loadMicros += std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
@@ -222,6 +222,13 @@ public:
 	CombatType_t combatType = COMBAT_UNDEFINEDDAMAGE;
 };
 
+struct MonsterTypeStats
+{
+	size_t files = 0; // monster types of monsters.xml
+	size_t loaded = 0; // including the ones registered by lua
+	int64_t loadMicros = 0; // spent parsing monster files, at startup and on demand
+};
+
 class Monsters
 {
 public:
@@ -237,6 +244,8 @@ public:
 	MonsterType* getMonsterType(const std::string& name, bool loadFromFile = true);
 	bool deserializeSpell(MonsterSpell* spell, spellBlock_t& sb, const std::string& description = "");
 
+	MonsterTypeStats getStats() const;
+
 	std::unique_ptr<LuaScriptInterface> scriptInterface;
 	std::map<std::string, MonsterType> monsters;
 
@@ -250,8 +259,12 @@ private:
 	void loadLootContainer(const pugi::xml_node& node, LootBlock&);
 	bool loadLootItem(const pugi::xml_node& node, LootBlock&);
 
+	void addLoadTime(std::chrono::steady_clock::duration duration);
+
 	std::map<std::string, std::string> unloadedMonsters;
 
+	int64_t loadMicros = 0;
+
 	bool loaded = false;
 };
 
@@ -54,6 +54,7 @@ void MoveEvents::clear(bool fromLua)
 	clearMap(actionIdMap, fromLua);
 	clearMap(uniqueIdMap, fromLua);
 	clearPosMap(positionMap, fromLua);
+	indexValid = false;
 
 	reInitState(fromLua);
 }
@@ -305,6 +306,8 @@ bool MoveEvents::registerLuaEvent(MoveEvent* event)
 
 void MoveEvents::addEvent(MoveEvent moveEvent, int32_t id, MoveListMap& map)
 {
+	indexValid = false;
+
 	auto it = map.find(id);
 	if (it == map.end()) {
 		MoveEventList moveEventList;
@@ -360,24 +363,95 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType, slots_t slot)
 			break;
 	}
 
-	auto it = itemIdMap.find(item->getID());
-	if (it != itemIdMap.end()) {
-		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
-		for (MoveEvent& moveEvent : moveEventList) {
-			if ((moveEvent.getSlot() & slotp) != 0) {
-				return &moveEvent;
-			}
+	if (!indexValid) {
+		buildIndex();
+	}
+
+	const uint16_t itemId = item->getID();
+	if (itemId >= itemIdEventTypes.size() || (itemIdEventTypes[itemId] & (1 << eventType)) == 0) {
+		return nullptr;
+	}
+
+	for (MoveEvent& moveEvent : itemIdIndex[itemId]->moveEvent[eventType]) {
+		if ((moveEvent.getSlot() & slotp) != 0) {
+			return &moveEvent;
 		}
 	}
 	return nullptr;
 }
 
+uint8_t MoveEvents::getEventTypes(const MoveEventList& moveEventList)
+{
+	uint8_t eventTypes = 0;
+	for (int eventType = MOVE_EVENT_STEP_IN; eventType < MOVE_EVENT_LAST; ++eventType) {
+		if (!moveEventList.moveEvent[eventType].empty()) {
+			eventTypes |= 1 << eventType;
+		}
+	}
+	return eventTypes;
+}
+
+void MoveEvents::buildIndex()
+{
+	static_assert(MOVE_EVENT_LAST <= 8, "event types must fit the bits of uint8_t");
+
+	itemIdIndex.clear();
+	itemIdEventTypes.clear();
+	for (auto& it : itemIdMap) {
+		const uint8_t eventTypes = getEventTypes(it.second);
+		if (eventTypes == 0 || it.first < 0 || it.first > std::numeric_limits<uint16_t>::max()) {
+			continue;
+		}
+
+		const size_t itemId = it.first;
+		if (itemId >= itemIdIndex.size()) {
+			itemIdIndex.resize(itemId + 1);
+			itemIdEventTypes.resize(itemId + 1);
+		}
+		itemIdIndex[itemId] = &it.second;
+		itemIdEventTypes[itemId] = eventTypes;
+	}
+
+	uniqueIdEventTypes = 0;
+	for (const auto& it : uniqueIdMap) {
+		uniqueIdEventTypes |= getEventTypes(it.second);
+	}
+
+	actionIdEventTypes = 0;
+	for (const auto& it : actionIdMap) {
+		actionIdEventTypes |= getEventTypes(it.second);
+	}
+
+	positionEventTypes = 0;
+	for (const auto& it : positionMap) {
+		positionEventTypes |= getEventTypes(it.second);
+	}
+
+	anyEventTypes = uniqueIdEventTypes | actionIdEventTypes | positionEventTypes;
+	for (uint8_t eventTypes : itemIdEventTypes) {
+		anyEventTypes |= eventTypes;
+	}
+
+	indexValid = true;
+}
+
+bool MoveEvents::hasEvents(MoveEvent_t eventType)
+{
+	if (!indexValid) {
+		buildIndex();
+	}
+	return (anyEventTypes & (1 << eventType)) != 0;
+}
+
 MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType)
 {
-	MoveListMap::iterator it;
+	if (!indexValid) {
+		buildIndex();
+	}
 
-	if (item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID)) {
-		it = uniqueIdMap.find(item->getUniqueId());
+	const uint8_t eventTypeBit = 1 << eventType;
+	if ((uniqueIdEventTypes & eventTypeBit) != 0 && item->hasAttribute(ITEM_ATTRIBUTE_UNIQUEID)) {
+		auto it = uniqueIdMap.find(item->getUniqueId());
 		if (it != uniqueIdMap.end()) {
 			std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
 			if (!moveEventList.empty()) {
@@ -386,8 +460,8 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType)
 		}
 	}
 
-	if (item->hasAttribute(ITEM_ATTRIBUTE_ACTIONID)) {
-		it = actionIdMap.find(item->getActionId());
+	if ((actionIdEventTypes & eventTypeBit) != 0 && item->hasAttribute(ITEM_ATTRIBUTE_ACTIONID)) {
+		auto it = actionIdMap.find(item->getActionId());
 		if (it != actionIdMap.end()) {
 			std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
 			if (!moveEventList.empty()) {
@@ -396,18 +470,17 @@ MoveEvent* MoveEvents::getEvent(Item* item, MoveEvent_t eventType)
 		}
 	}
 
-	it = itemIdMap.find(item->getID());
-	if (it != itemIdMap.end()) {
-		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
-		if (!moveEventList.empty()) {
-			return &(*moveEventList.begin());
-		}
+	const uint16_t itemId = item->getID();
+	if (itemId < itemIdEventTypes.size() && (itemIdEventTypes[itemId] & eventTypeBit) != 0) {
+		return &itemIdIndex[itemId]->moveEvent[eventType].front();
 	}
 	return nullptr;
 }
 
 void MoveEvents::addEvent(MoveEvent moveEvent, const Position& pos, MovePosListMap& map)
 {
+	indexValid = false;
+
 	auto it = map.find(pos);
 	if (it == map.end()) {
 		MoveEventList moveEventList;
@@ -425,6 +498,14 @@ void MoveEvents::addEvent(MoveEvent moveEvent, const Position& pos, MovePosListM
 
 MoveEvent* MoveEvents::getEvent(const Tile* tile, MoveEvent_t eventType)
 {
+	if (!indexValid) {
+		buildIndex();
+	}
+
+	if ((positionEventTypes & (1 << eventType)) == 0) {
+		return nullptr;
+	}
+
 	auto it = positionMap.find(tile->getPosition());
 	if (it != positionMap.end()) {
 		std::list<MoveEvent>& moveEventList = it->second.moveEvent[eventType];
@@ -437,6 +518,10 @@ MoveEvent* MoveEvents::getEvent(const Tile* tile, MoveEvent_t eventType)
 
 uint32_t MoveEvents::onCreatureMove(Creature* creature, const Tile* tile, MoveEvent_t eventType)
 {
+	if (!hasEvents(eventType)) {
+		return 1;
+	}
+
 	const Position& pos = tile->getPosition();
 
 	uint32_t ret = 1;
@@ -505,6 +590,10 @@ uint32_t MoveEvents::onItemMove(Item* item, Tile* tile, bool isAdd)
 		ret &= moveEvent->fireAddRemItem(item, nullptr, tile->getPosition());
 	}
 
+	if (!hasEvents(eventType2)) {
+		return ret;
+	}
+
 	for (size_t i = tile->getFirstIndex(), j = tile->getLastIndex(); i < j; ++i) {
 		Thing* thing = tile->getThing(i);
 		if (!thing) {
@@ -982,8 +1071,7 @@ bool MoveEvent::executeStep(Creature* creature, Item* item, const Position& pos)
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	LuaScriptInterface::pushUserdata<Creature>(L, creature);
-	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
+	LuaScriptInterface::pushCreature(L, creature);
 	LuaScriptInterface::pushThing(L, item);
 	LuaScriptInterface::pushPosition(L, pos);
 	LuaScriptInterface::pushPosition(L, creature->getLastPosition());
@@ -1018,8 +1106,7 @@ bool MoveEvent::executeEquip(Player* player, Item* item, slots_t slot, bool isCh
 	lua_State* L = scriptInterface->getLuaState();
 
 	scriptInterface->pushFunction(scriptId);
-	LuaScriptInterface::pushUserdata<Player>(L, player);
-	LuaScriptInterface::setMetatable(L, -1, "Player");
+	LuaScriptInterface::pushCreature(L, player);
 	LuaScriptInterface::pushThing(L, item);
 	lua_pushnumber(L, slot);
 	LuaScriptInterface::pushBoolean(L, isCheck);
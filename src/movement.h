@@ -57,8 +57,8 @@ public:
 	void clear(bool fromLua) override final;
 
 private:
-	using MoveListMap = std::map<int32_t, MoveEventList>;
-	using MovePosListMap = std::map<Position, MoveEventList>;
+	using MoveListMap = std::unordered_map<int32_t, MoveEventList>;
+	using MovePosListMap = std::unordered_map<Position, MoveEventList>;
 	void clearMap(MoveListMap& map, bool fromLua);
 	void clearPosMap(MovePosListMap& map, bool fromLua);
 
@@ -74,11 +74,25 @@ private:
 
 	MoveEvent* getEvent(Item* item, MoveEvent_t eventType, slots_t slot);
 
+	void buildIndex();
+	bool hasEvents(MoveEvent_t eventType);
+	static uint8_t getEventTypes(const MoveEventList& moveEventList);
+
 	MoveListMap uniqueIdMap;
 	MoveListMap actionIdMap;
 	MoveListMap itemIdMap;
 	MovePosListMap positionMap;
 
+	// rebuilt on the first lookup after the events changed, a bit per MoveEvent_t tells whether there are events
+	// of that type, so that the items of a step without any are skipped without a lookup
+	std::vector<MoveEventList*> itemIdIndex;
+	std::vector<uint8_t> itemIdEventTypes;
+	uint8_t uniqueIdEventTypes = 0;
+	uint8_t actionIdEventTypes = 0;
+	uint8_t positionEventTypes = 0;
+	uint8_t anyEventTypes = 0;
+	bool indexValid = false;
+
 	LuaScriptInterface scriptInterface;
 };
 
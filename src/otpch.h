@@ -14,6 +14,7 @@
 #include <bitset>
 #include <boost/algorithm/string.hpp>
 #include <boost/asio.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/lockfree/stack.hpp>
 #include <boost/variant.hpp>
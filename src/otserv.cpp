@@ -8,6 +8,9 @@
 #include "databasetasks.h"
 #include "game.h"
 #include "iomarket.h"
+#include "logintasks.h"
+#include "luaprofiler.h"
+#include "metrics.h"
 #include "monsters.h"
 #include "outfit.h"
 #include "protocollogin.h"
@@ -18,6 +21,8 @@
 #include "script.h"
 #include "scriptmanager.h"
 #include "server.h"
+#include "serversave.h"
+#include "startuploader.h"
 
 #include <fstream>
 
@@ -26,6 +31,10 @@
 #endif
 
 DatabaseTasks g_databaseTasks;
+LoginTasks g_loginTasks;
+ServerSave g_serverSave;
+LuaProfiler g_luaProfiler;
+Metrics g_metrics;
 Dispatcher g_dispatcher;
 Scheduler g_scheduler;
 
@@ -34,6 +43,7 @@ ConfigManager g_config;
 Monsters g_monsters;
 Vocations g_vocations;
 extern Scripts* g_scripts;
+extern LuaEnvironment g_luaEnvironment;
 RSA g_RSA;
 
 std::mutex g_loaderLock;
@@ -123,11 +133,13 @@ int main(int argc, char* argv[])
 		std::cout << ">> No services running. The server is NOT online." << std::endl;
 		g_scheduler.shutdown();
 		g_databaseTasks.shutdown();
+		g_loginTasks.shutdown();
 		g_dispatcher.shutdown();
 	}
 
 	g_scheduler.join();
 	g_databaseTasks.join();
+	g_loginTasks.join();
 	g_dispatcher.join();
 	return 0;
 }
@@ -245,64 +257,20 @@ void mainLoader(int, char*[], ServiceManager* services)
 		    "The database you have specified in config.lua is empty, please import the schema.sql to your database.");
 		return;
 	}
-	g_databaseTasks.start();
-
-	DatabaseManager::updateDatabase();
-
-	if (g_config.getBoolean(ConfigManager::OPTIMIZE_DATABASE) && !DatabaseManager::optimizeTables()) {
-		std::cout << "> No tables were optimized." << std::endl;
-	}
-
-	// load vocations
-	std::cout << ">> Loading vocations" << std::endl;
-	if (!g_vocations.loadFromXml()) {
-		startupErrorMessage("Unable to load vocations!");
-		return;
-	}
-
-	// load item data
-	std::cout << ">> Loading items... ";
-	if (!Item::items.loadFromOtb("data/items/items.otb")) {
-		startupErrorMessage("Unable to load items (OTB)!");
-		return;
-	}
-	std::cout << fmt::format("OTB v{:d}.{:d}.{:d}", Item::items.majorVersion, Item::items.minorVersion,
-	                         Item::items.buildNumber)
-	          << std::endl;
-
-	if (!Item::items.loadFromXml()) {
-		startupErrorMessage("Unable to load items (XML)!");
-		return;
-	}
-
-	std::cout << ">> Loading script systems" << std::endl;
-	if (!ScriptingManager::getInstance().loadScriptSystems()) {
-		startupErrorMessage("Failed to load script systems");
-		return;
-	}
-
-	std::cout << ">> Loading lua scripts" << std::endl;
-	if (!g_scripts->loadScripts("scripts", false, false)) {
-		startupErrorMessage("Failed to load lua scripts");
+	if (!g_databaseTasks.start()) {
+		startupErrorMessage("Failed to connect the database task workers to the database.");
 		return;
 	}
 
-	std::cout << ">> Loading monsters" << std::endl;
-	if (!g_monsters.loadFromXml()) {
-		startupErrorMessage("Unable to load monsters!");
+	if (!g_loginTasks.start()) {
+		startupErrorMessage("Failed to connect the login loaders to the database.");
 		return;
 	}
 
-	std::cout << ">> Loading lua monsters" << std::endl;
-	if (!g_scripts->loadScripts("monster", false, false)) {
-		startupErrorMessage("Failed to load lua monsters");
-		return;
-	}
+	DatabaseManager::updateDatabase();
 
-	std::cout << ">> Loading outfits" << std::endl;
-	if (!Outfits::getInstance().loadFromXml()) {
-		startupErrorMessage("Unable to load outfits!");
-		return;
+	if (g_config.getBoolean(ConfigManager::OPTIMIZE_DATABASE) && !DatabaseManager::optimizeTables()) {
+		std::cout << "> No tables were optimized." << std::endl;
 	}
 
 	std::cout << ">> Checking world type... " << std::flush;
@@ -322,12 +290,53 @@ void mainLoader(int, char*[], ServiceManager* services)
 	}
 	std::cout << boost::algorithm::to_upper_copy(worldType) << std::endl;
 
-	std::cout << ">> Loading map" << std::endl;
-	if (!g_game.loadMainMap(g_config.getString(ConfigManager::MAP_NAME))) {
-		startupErrorMessage("Failed to load map");
+	// the data files are parsed on worker threads while the scripts are loaded into the Lua state
+	StartupLoader loader;
+	loader.addStage("vocations", STARTUP_THREAD_WORKER, {}, []() { return g_vocations.loadFromXml(); });
+	loader.addStage("items", STARTUP_THREAD_WORKER, {}, []() {
+		if (!Item::items.loadFromOtb("data/items/items.otb")) {
+			return false;
+		}
+
+		std::cout << fmt::format(">> Items OTB v{:d}.{:d}.{:d}", Item::items.majorVersion, Item::items.minorVersion,
+		                         Item::items.buildNumber)
+		          << std::endl;
+		return Item::items.loadFromXml();
+	});
+	loader.addStage("outfits", STARTUP_THREAD_WORKER, {}, []() { return Outfits::getInstance().loadFromXml(); });
+	loader.addStage("map", STARTUP_THREAD_WORKER, {"items"},
+	                []() { return g_game.loadMainMapTiles(g_config.getString(ConfigManager::MAP_NAME)); });
+	loader.addStage("script systems", STARTUP_THREAD_DISPATCHER, {"vocations", "items", "outfits"},
+	                []() { return ScriptingManager::getInstance().loadScriptSystems(); });
+	loader.addStage("lua scripts", STARTUP_THREAD_DISPATCHER, {"script systems"},
+	                []() { return g_scripts->loadScripts("scripts", false, false); });
+	loader.addStage("monsters", STARTUP_THREAD_DISPATCHER, {"lua scripts"}, []() { return g_monsters.loadFromXml(); });
+	loader.addStage("lua monsters", STARTUP_THREAD_DISPATCHER, {"monsters"},
+	                []() { return g_scripts->loadScripts("monster", false, false); });
+	loader.addStage("spawns and houses", STARTUP_THREAD_DISPATCHER, {"map", "lua monsters"}, []() {
+		g_game.loadMainMapSpawnsAndHouses();
+		return true;
+	});
+
+	const std::string failedStage = loader.run();
+	loader.printTimings();
+	if (!failedStage.empty()) {
+		startupErrorMessage("Unable to load " + failedStage + "!");
 		return;
 	}
 
+	LuaScriptInterface::reportLoadStats();
+
+	const MonsterTypeStats monsterStats = g_monsters.getStats();
+	std::cout << fmt::format(">> Loaded {:d} monster types ({:d} in monsters.xml) in {:.1f} ms", monsterStats.loaded,
+	                         monsterStats.files, monsterStats.loadMicros / 1000.)
+	          << std::endl;
+
+	if (g_config.getBoolean(ConfigManager::LUA_PROFILER)) {
+		std::cout << ">> Starting lua profiler" << std::endl;
+		g_luaProfiler.start(g_luaEnvironment.getLuaState(), g_config.getNumber(ConfigManager::LUA_PROFILER_INTERVAL));
+	}
+
 	std::cout << ">> Initializing gamestate" << std::endl;
 	g_game.setGameState(GAME_STATE_INIT);
 
@@ -341,6 +350,15 @@ void mainLoader(int, char*[], ServiceManager* services)
 	// Legacy login protocol
 	services->add<ProtocolOld>(static_cast<uint16_t>(g_config.getNumber(ConfigManager::LOGIN_PORT)));
 
+	// Metrics endpoint
+	if (uint16_t metricsPort = static_cast<uint16_t>(g_config.getNumber(ConfigManager::METRICS_PORT))) {
+		if (services->addMetrics(g_config.getString(ConfigManager::METRICS_IP), metricsPort)) {
+			std::cout << ">> Serving metrics on " << g_config.getString(ConfigManager::METRICS_IP) << ':'
+			          << metricsPort << "/metrics" << std::endl;
+			g_metrics.start();
+		}
+	}
+
 	RentPeriod_t rentPeriod;
 	std::string strRentPeriod = boost::algorithm::to_lower_copy(g_config.getString(ConfigManager::HOUSE_RENT_PERIOD));
 
@@ -358,6 +376,7 @@ void mainLoader(int, char*[], ServiceManager* services)
 
 	g_game.map.houses.payHouses(rentPeriod);
 
+	IOMarket::loadOffers();
 	IOMarket::checkExpiredOffers();
 	IOMarket::getInstance().updateStatistics();
 
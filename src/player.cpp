@@ -15,6 +15,7 @@
 #include "game.h"
 #include "inbox.h"
 #include "iologindata.h"
+#include "logintasks.h"
 #include "monster.h"
 #include "movement.h"
 #include "npc.h"
@@ -903,6 +904,28 @@ DepotLocker& Player::getDepotLocker()
 	return *depotLocker;
 }
 
+void Player::loadDepots(std::function<void(Player*)> callback /* = nullptr*/)
+{
+	if (depotsState == DEPOTS_LOADED) {
+		if (callback) {
+			callback(this);
+		}
+		return;
+	}
+
+	if (callback) {
+		depotsCallbacks.push_back(std::move(callback));
+	}
+
+	if (depotsState == DEPOTS_LOADING) {
+		return;
+	}
+
+	depotsState = DEPOTS_LOADING;
+	depotsRequestedAt = OTSYS_TIME();
+	IOLoginData::queueLoadDepots(getGUID(), getID());
+}
+
 void Player::sendCancelMessage(ReturnValue message) const { sendCancelMessage(getReturnMessage(message)); }
 
 void Player::sendStats()
@@ -1335,6 +1358,21 @@ void Player::onRemoveCreature(Creature* creature, bool isLogout)
 
 		IOLoginData::updateOnlineStatus(guid, false);
 
+		// the save leaves an inbox that is not loaded yet alone, the items that arrived in it meanwhile are written
+		// straight into the database, as for an offline player
+		if (depotsState != DEPOTS_LOADED && !inbox->empty()) {
+			if (g_loginTasks.beginOfflineWrite(guid)) {
+				OfflineDelivery delivery;
+				for (Item* item : inbox->getItemList()) {
+					delivery.addItem(item);
+				}
+				IOLoginData::queueOfflineDelivery(guid, std::move(delivery));
+			} else {
+				// the same character is being loaded on another connection
+				IOLoginData::loadDepots(this);
+			}
+		}
+
 		bool saved = false;
 		for (uint32_t tries = 0; tries < 3; ++tries) {
 			if (IOLoginData::savePlayer(this)) {
@@ -1447,6 +1485,11 @@ void Player::onAddContainerItem(const Item* item) { checkTradeState(item); }
 
 void Player::onUpdateContainerItem(const Container* container, const Item* oldItem, const Item* newItem)
 {
+	// sent to every spectator, stack counts and sub types changed in place only show up here
+	if (container->getHoldingPlayer() == this) {
+		itemCountsValid = false;
+	}
+
 	if (oldItem != newItem) {
 		onRemoveContainerItem(container, oldItem);
 	}
@@ -1500,6 +1543,8 @@ void Player::onSendContainer(const Container* container)
 // inventory
 void Player::onUpdateInventoryItem(Item* oldItem, Item* newItem)
 {
+	itemCountsValid = false;
+
 	if (oldItem != newItem) {
 		onRemoveInventoryItem(oldItem);
 	}
@@ -2060,6 +2105,9 @@ BlockType_t Player::blockHit(Creature* attacker, CombatType_t combatType, int32_
 				continue;
 			}
 
+			// the reflect of an item may come from its attributes alone, without abilities of its type
+			reflect += item->getReflect(combatType);
+
 			const ItemType& it = Item::items[item->getID()];
 			if (!it.abilities) {
 				if (damage <= 0) {
@@ -2080,8 +2128,6 @@ BlockType_t Player::blockHit(Creature* attacker, CombatType_t combatType, int32_
 				}
 			}
 
-			reflect += item->getReflect(combatType);
-
 			if (field) {
 				const int16_t& fieldAbsorbPercent = it.abilities->fieldAbsorbPercent[combatIndex];
 				if (fieldAbsorbPercent != 0) {
@@ -3077,28 +3123,61 @@ size_t Player::getFirstIndex() const { return CONST_SLOT_FIRST; }
 
 size_t Player::getLastIndex() const { return CONST_SLOT_LAST + 1; }
 
-uint32_t Player::getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const
+void ItemCountIndex::addItem(const Item* item)
 {
-	uint32_t count = 0;
+	types[item->getID()] += item->getItemCount();
+	subTypes[(static_cast<uint32_t>(item->getID()) << 16) | item->getSubType()] += item->getItemCount();
+	if (!item->getContainer()) {
+		money += item->getWorth();
+	}
+}
+
+const ItemCountIndex& Player::getItemCounts() const
+{
+	const bool check = itemCountsValid && g_config.getBoolean(ConfigManager::CHECK_ITEM_COUNT_INDEX);
+	if (itemCountsValid && !check) {
+		return itemCounts;
+	}
+
+	ItemCountIndex counts;
 	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
 		Item* item = inventory[i];
 		if (!item) {
 			continue;
 		}
 
-		if (item->getID() == itemId) {
-			count += Item::countByType(item, subType);
-		}
+		counts.addItem(item);
 
 		if (Container* container = item->getContainer()) {
 			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				if ((*it)->getID() == itemId) {
-					count += Item::countByType(*it, subType);
-				}
+				counts.addItem(*it);
 			}
 		}
 	}
-	return count;
+
+	if (check && counts != itemCounts) {
+		std::cout << "[Warning - Player::getItemCounts] Item counts of " << name << " were out of date." << std::endl;
+	}
+
+	itemCounts = std::move(counts);
+	itemCountsValid = true;
+	return itemCounts;
+}
+
+uint32_t Player::getItemTypeCount(uint16_t itemId, int32_t subType /*= -1*/) const
+{
+	const ItemCountIndex& counts = getItemCounts();
+	if (subType == -1) {
+		auto it = counts.types.find(itemId);
+		return it != counts.types.end() ? it->second : 0;
+	}
+
+	if (subType < 0 || subType > std::numeric_limits<uint16_t>::max()) {
+		return 0;
+	}
+
+	auto it = counts.subTypes.find((static_cast<uint32_t>(itemId) << 16) | static_cast<uint32_t>(subType));
+	return it != counts.subTypes.end() ? it->second : 0;
 }
 
 bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType, bool ignoreEquipped /* = false*/) const
@@ -3107,6 +3186,11 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 		return true;
 	}
 
+	// the common case of not carrying enough is answered without looking at the items
+	if (getItemTypeCount(itemId, subType) < amount) {
+		return false;
+	}
+
 	std::vector<Item*> itemList;
 
 	uint32_t count = 0;
@@ -3154,19 +3238,8 @@ bool Player::removeItemOfType(uint16_t itemId, uint32_t amount, int32_t subType,
 
 std::map<uint32_t, uint32_t>& Player::getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const
 {
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; i++) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
-		}
-
-		countMap[item->getID()] += Item::countByType(item, -1);
-
-		if (Container* container = item->getContainer()) {
-			for (ContainerIterator it = container->iterator(); it.hasNext(); it.advance()) {
-				countMap[(*it)->getID()] += Item::countByType(*it, -1);
-			}
-		}
+	for (const auto& it : getItemCounts().types) {
+		countMap[it.first] += it.second;
 	}
 	return countMap;
 }
@@ -3203,6 +3276,7 @@ void Player::postAddNotification(Thing* thing, const Cylinder* oldParent, int32_
 			requireListUpdate = oldParent != this;
 		}
 
+		itemCountsValid = false;
 		updateInventoryWeight();
 		updateItemsLight();
 		sendStats();
@@ -3260,6 +3334,7 @@ void Player::postRemoveNotification(Thing* thing, const Cylinder* newParent, int
 			requireListUpdate = newParent != this;
 		}
 
+		itemCountsValid = false;
 		updateInventoryWeight();
 		updateItemsLight();
 		sendStats();
@@ -3365,6 +3440,7 @@ void Player::internalAddThing(uint32_t index, Thing* thing)
 
 		inventory[index] = item;
 		item->setParent(this);
+		itemCountsValid = false;
 	}
 }
 
@@ -4725,39 +4801,7 @@ void Player::sendClosePrivate(uint16_t channelId)
 	}
 }
 
-uint64_t Player::getMoney() const
-{
-	std::vector<const Container*> containers;
-	uint64_t moneyCount = 0;
-
-	for (int32_t i = CONST_SLOT_FIRST; i <= CONST_SLOT_LAST; ++i) {
-		Item* item = inventory[i];
-		if (!item) {
-			continue;
-		}
-
-		const Container* container = item->getContainer();
-		if (container) {
-			containers.push_back(container);
-		} else {
-			moneyCount += item->getWorth();
-		}
-	}
-
-	size_t i = 0;
-	while (i < containers.size()) {
-		const Container* container = containers[i++];
-		for (const Item* item : container->getItemList()) {
-			const Container* tmpContainer = item->getContainer();
-			if (tmpContainer) {
-				containers.push_back(tmpContainer);
-			} else {
-				moneyCount += item->getWorth();
-			}
-		}
-	}
-	return moneyCount;
-}
+uint64_t Player::getMoney() const { return getItemCounts().money; }
 
 size_t Player::getMaxVIPEntries() const
 {
@@ -88,6 +88,52 @@ struct Skill
 	uint8_t percent = 0;
 };
 
+enum PlayerItemTable_t : uint8_t
+{
+	PLAYER_ITEM_TABLE_INVENTORY,
+	PLAYER_ITEM_TABLE_DEPOT,
+	PLAYER_ITEM_TABLE_INBOX,
+	PLAYER_ITEM_TABLE_STORE_INBOX,
+
+	PLAYER_ITEM_TABLE_LAST = PLAYER_ITEM_TABLE_STORE_INBOX
+};
+
+// Rows of a player as they were last loaded from or written to the database, IOLoginData::savePlayer only writes
+// the rows that differ from them.
+using PlayerItemSids = std::unordered_map<const Item*, int32_t>;
+
+struct PlayerSaveState
+{
+	std::array<std::map<int32_t, uint64_t>, PLAYER_ITEM_TABLE_LAST + 1> items; // sid -> row hash
+	std::array<PlayerItemSids, PLAYER_ITEM_TABLE_LAST + 1> itemSids;           // the row each item was written to
+	std::map<uint32_t, int32_t> storage;
+	std::set<std::string> spells;
+	bool valid = false;
+};
+
+// Counts of the items a player carries in the inventory, including everything inside containers.
+struct ItemCountIndex
+{
+	void addItem(const Item* item);
+
+	bool operator==(const ItemCountIndex& other) const
+	{
+		return types == other.types && subTypes == other.subTypes && money == other.money;
+	}
+	bool operator!=(const ItemCountIndex& other) const { return !(*this == other); }
+
+	std::unordered_map<uint16_t, uint32_t> types;
+	std::unordered_map<uint32_t, uint32_t> subTypes; // item id << 16 | sub type
+	uint64_t money = 0;
+};
+
+enum DepotsState_t : uint8_t
+{
+	DEPOTS_UNLOADED, // left in the database by the login, see Player::loadDepots
+	DEPOTS_LOADING,
+	DEPOTS_LOADED,
+};
+
 using MuteCountMap = std::map<uint32_t, uint32_t>;
 
 static constexpr int32_t PLAYER_MAX_SPEED = 1500;
@@ -363,6 +409,19 @@ public:
 
 	DepotChest* getDepotChest(uint32_t depotId, bool autoCreate);
 	DepotLocker& getDepotLocker();
+
+	/**
+	 * The depot chests and the inbox of a player who logged in are only
+	 * loaded once they are used. Loads them on the database lane of the
+	 * player and calls back on the dispatcher thread once they are, right
+	 * away if they already are.
+	 *
+	 * Items added to the inbox meanwhile are kept, the loaded ones are added
+	 * next to them.
+	 */
+	void loadDepots(std::function<void(Player*)> callback = nullptr);
+	bool hasLoadedDepots() const { return depotsState == DEPOTS_LOADED; }
+
 	void onReceiveMail() const;
 	bool isNearDepotBox() const;
 
@@ -376,6 +435,13 @@ public:
 
 	uint64_t getMoney() const;
 
+	/**
+	 * Item counts are kept in an index rebuilt on the first query after the
+	 * inventory changed. Changes made behind the back of the cylinders, e.g.
+	 * attributes set directly, have to invalidate it.
+	 */
+	void invalidateItemCounts() const { itemCountsValid = false; }
+
 	// safe-trade functions
 	void setTradeState(tradestate_t state) { tradeState = state; }
 	tradestate_t getTradeState() const { return tradeState; }
@@ -1177,6 +1243,7 @@ private:
 	int32_t getThingIndex(const Thing* thing) const override;
 	size_t getFirstIndex() const override;
 	size_t getLastIndex() const override;
+	const ItemCountIndex& getItemCounts() const;
 	uint32_t getItemTypeCount(uint16_t itemId, int32_t subType = -1) const override;
 	std::map<uint32_t, uint32_t>& getAllItemTypeCount(std::map<uint32_t, uint32_t>& countMap) const override;
 	Thing* getThing(size_t index) const override;
@@ -1190,6 +1257,15 @@ private:
 	std::map<uint8_t, OpenContainer> openContainers;
 	std::map<uint32_t, DepotChest*> depotChests;
 	std::map<uint32_t, int32_t> storageMap;
+	PlayerSaveState saveState;
+	uint32_t saveRevision = 0; // number of snapshots taken by IOLoginData::snapshotPlayer
+
+	std::vector<std::function<void(Player*)>> depotsCallbacks;
+	int64_t depotsRequestedAt = 0;
+	DepotsState_t depotsState = DEPOTS_LOADED; // players loaded for anything but a login have them right away
+
+	mutable ItemCountIndex itemCounts;
+	mutable bool itemCountsValid = false;
 
 	std::vector<OutfitEntry> outfits;
 	GuildWarVector guildWarVector;
@@ -1347,6 +1423,7 @@ private:
 	friend class Actions;
 	friend class IOLoginData;
 	friend class ProtocolGame;
+	friend class ServerSave;
 };
 
 #endif // FS_PLAYER_H
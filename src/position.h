@@ -109,6 +109,17 @@ struct Position
 	int_fast16_t getZ() const { return z; }
 };
 
+namespace std {
+template <>
+struct hash<Position>
+{
+	size_t operator()(const Position& p) const noexcept
+	{
+		return hash<uint64_t>{}((uint64_t{p.x} << 24) | (uint64_t{p.y} << 8) | p.z);
+	}
+};
+} // namespace std
+
 std::ostream& operator<<(std::ostream&, const Position&);
 std::ostream& operator<<(std::ostream&, const Direction&);
 
@@ -14,6 +14,7 @@
 #include "inbox.h"
 #include "iologindata.h"
 #include "iomarket.h"
+#include "logintasks.h"
 #include "npc.h"
 #include "outfit.h"
 #include "outputmessage.h"
@@ -151,6 +152,16 @@ void ProtocolGame::release()
 	Protocol::release();
 }
 
+struct LoginLoadResult
+{
+	PendingPlayerData pending;
+	BanInfo banInfo;
+	bool preloaded = false;
+	bool namelocked = false;
+	bool banned = false;
+	bool loaded = false;
+};
+
 void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingSystem_t operatingSystem)
 {
 	// dispatcher thread
@@ -162,104 +173,195 @@ void ProtocolGame::login(const std::string& name, uint32_t accountId, OperatingS
 		player->incrementReferenceCounter();
 		player->setID();
 
-		if (!IOLoginData::preloadPlayer(player, name)) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+		// the loader keeps its own reference, the connection may be released before the player is handed back
+		player->incrementReferenceCounter();
 
-		if (IOBan::isPlayerNamelocked(player->getGUID())) {
-			disconnectClient("Your character has been namelocked.");
-			return;
+		auto result = std::make_shared<LoginLoadResult>();
+		bool queued = g_loginTasks.addTask(
+		    [=, loadingPlayer = player](Database& db) {
+			    // login loader thread
+			    if (!IOLoginData::preloadPlayer(loadingPlayer, name, db)) {
+				    return;
+			    }
+			    result->preloaded = true;
+
+			    if (IOBan::isPlayerNamelocked(loadingPlayer->getGUID(), db)) {
+				    result->namelocked = true;
+				    return;
+			    }
+
+			    if (!loadingPlayer->hasFlag(PlayerFlag_CannotBeBanned) &&
+			        IOBan::isAccountBanned(accountId, result->banInfo, db)) {
+				    result->banned = true;
+			    }
+		    },
+		    [=, thisPtr = getThis(), loadingPlayer = player]() {
+			    thisPtr->onPlayerPreloaded(loadingPlayer, result, operatingSystem);
+		    });
+
+		if (!queued) {
+			player->decrementReferenceCounter();
+			disconnectClient("Too many players are logging in.\nPlease try again later.");
 		}
+		return;
+	}
 
-		if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("The game is just going down.\nPlease try again later.");
-			return;
-		}
+	if (eventConnect != 0 || !g_config.getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
+		// Already trying to connect
+		disconnectClient("You are already logged in.");
+		return;
+	}
 
-		if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
-			disconnectClient("Server is currently closed.\nPlease try again later.");
-			return;
-		}
+	if (foundPlayer->client) {
+		foundPlayer->disconnect();
+		foundPlayer->isConnecting = true;
 
-		if (g_config.getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) &&
-		    player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
-			disconnectClient("You may only login with one character\nof your account at the same time.");
-			return;
-		}
+		eventConnect = g_scheduler.addEvent(
+		    createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
+			    thisPtr->connect(playerID, operatingSystem);
+		    }));
+	} else {
+		connect(foundPlayer->getID(), operatingSystem);
+	}
+	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
+}
 
-		if (!player->hasFlag(PlayerFlag_CannotBeBanned)) {
-			BanInfo banInfo;
-			if (IOBan::isAccountBanned(accountId, banInfo)) {
-				if (banInfo.reason.empty()) {
-					banInfo.reason = "(none)";
-				}
+void ProtocolGame::onPlayerPreloaded(Player* loadedPlayer, const std::shared_ptr<LoginLoadResult>& result,
+                                     OperatingSystem_t operatingSystem)
+{
+	// dispatcher thread
+	if (player != loadedPlayer || isConnectionExpired()) {
+		// the connection was released while the player was loading
+		loadedPlayer->decrementReferenceCounter();
+		return;
+	}
 
-				if (banInfo.expiresAt > 0) {
-					disconnectClient(
-					    fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}",
-					                formatDateShort(banInfo.expiresAt), banInfo.bannedBy, banInfo.reason));
-				} else {
-					disconnectClient(
-					    fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}",
-					                banInfo.bannedBy, banInfo.reason));
-				}
-				return;
-			}
-		}
+	// the connection still holds its own reference
+	loadedPlayer->decrementReferenceCounter();
 
-		if (std::size_t currentSlot = clientLogin(*player)) {
-			uint8_t retryTime = getWaitTime(currentSlot);
-			auto output = OutputMessagePool::getOutputMessage();
-			output->addByte(0x16);
-			output->addString(
-			    fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
-			output->addByte(retryTime);
-			send(output);
-			disconnect();
-			return;
-		}
+	if (!result->preloaded) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
 
-		if (!IOLoginData::loadPlayerById(player, player->getGUID())) {
-			disconnectClient("Your character could not be loaded.");
-			return;
-		}
+	if (result->namelocked) {
+		disconnectClient("Your character has been namelocked.");
+		return;
+	}
 
-		player->setOperatingSystem(operatingSystem);
+	if (g_game.getGameState() == GAME_STATE_CLOSING && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("The game is just going down.\nPlease try again later.");
+		return;
+	}
 
-		if (!g_game.placeCreature(player, player->getLoginPosition())) {
-			if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
-				disconnectClient("Temple position is wrong. Contact the administrator.");
-				return;
-			}
-		}
+	if (g_game.getGameState() == GAME_STATE_CLOSED && !player->hasFlag(PlayerFlag_CanAlwaysLogin)) {
+		disconnectClient("Server is currently closed.\nPlease try again later.");
+		return;
+	}
 
-		if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
-			player->registerCreatureEvent("ExtendedOpcode");
+	if (result->banned) {
+		BanInfo& banInfo = result->banInfo;
+		if (banInfo.reason.empty()) {
+			banInfo.reason = "(none)";
 		}
 
-		player->lastIP = player->getIP();
-		player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
-		acceptPackets = true;
-	} else {
-		if (eventConnect != 0 || !g_config.getBoolean(ConfigManager::REPLACE_KICK_ON_LOGIN)) {
-			// Already trying to connect
-			disconnectClient("You are already logged in.");
-			return;
+		if (banInfo.expiresAt > 0) {
+			disconnectClient(fmt::format("Your account has been banned until {:s} by {:s}.\n\nReason specified:\n{:s}",
+			                             formatDateShort(banInfo.expiresAt), banInfo.bannedBy, banInfo.reason));
+		} else {
+			disconnectClient(fmt::format("Your account has been permanently banned by {:s}.\n\nReason specified:\n{:s}",
+			                             banInfo.bannedBy, banInfo.reason));
 		}
+		return;
+	}
 
-		if (foundPlayer->client) {
-			foundPlayer->disconnect();
-			foundPlayer->isConnecting = true;
+	// the waiting list only needs the preloaded account, a player who has to wait is not loaded at all
+	if (std::size_t currentSlot = clientLogin(*player)) {
+		uint8_t retryTime = getWaitTime(currentSlot);
+		auto output = OutputMessagePool::getOutputMessage();
+		output->addByte(0x16);
+		output->addString(
+		    fmt::format("Too many players online.\nYou are at place {:d} on the waiting list.", currentSlot));
+		output->addByte(retryTime);
+		send(output);
+		disconnect();
+		return;
+	}
 
-			eventConnect = g_scheduler.addEvent(
-			    createSchedulerTask(1000, [=, thisPtr = getThis(), playerID = foundPlayer->getID()]() {
-				    thisPtr->connect(playerID, operatingSystem);
-			    }));
-		} else {
-			connect(foundPlayer->getID(), operatingSystem);
+	// the loader keeps its own reference again
+	player->incrementReferenceCounter();
+
+	bool queued = g_loginTasks.addTask(
+	    [=, loadingPlayer = player](Database& db) {
+		    // login loader thread
+		    g_loginTasks.beginLoad(loadingPlayer->getGUID());
+
+		    result->pending.deferDepots = g_config.getBoolean(ConfigManager::LAZY_DEPOT_LOADING);
+		    result->loaded =
+		        IOLoginData::loadDetachedPlayerById(db, loadingPlayer, loadingPlayer->getGUID(), result->pending);
+		    if (result->loaded) {
+			    g_loginTasks.addLoginItems(result->pending.loadedItems);
+		    }
+	    },
+	    [=, thisPtr = getThis(), loadingPlayer = player]() {
+		    const uint32_t guid = loadingPlayer->getGUID();
+		    thisPtr->onPlayerLoaded(loadingPlayer, *result, operatingSystem);
+		    g_loginTasks.endLoad(guid);
+	    });
+
+	if (!queued) {
+		player->decrementReferenceCounter();
+		disconnectClient("Too many players are logging in.\nPlease try again later.");
+	}
+}
+
+void ProtocolGame::onPlayerLoaded(Player* loadedPlayer, LoginLoadResult& result, OperatingSystem_t operatingSystem)
+{
+	// dispatcher thread
+	if (player != loadedPlayer || isConnectionExpired()) {
+		// the connection was released while the player was loading
+		loadedPlayer->decrementReferenceCounter();
+		return;
+	}
+
+	// the connection still holds its own reference
+	loadedPlayer->decrementReferenceCounter();
+
+	if (!result.loaded) {
+		disconnectClient("Your character could not be loaded.");
+		return;
+	}
+
+	if (g_config.getBoolean(ConfigManager::ONE_PLAYER_ON_ACCOUNT) &&
+	    player->getAccountType() < ACCOUNT_TYPE_GAMEMASTER && g_game.getPlayerByAccount(player->getAccount())) {
+		disconnectClient("You may only login with one character\nof your account at the same time.");
+		return;
+	}
+
+	// the same character may have finished logging in on another connection while this one was loading
+	if (!g_config.getBoolean(ConfigManager::ALLOW_CLONES) && g_game.getPlayerByGUID(player->getGUID())) {
+		disconnectClient("You are already logged in.");
+		return;
+	}
+
+	IOLoginData::finishLoadPlayer(player, result.pending);
+	player->setOperatingSystem(operatingSystem);
+
+	if (!g_game.placeCreature(player, player->getLoginPosition())) {
+		if (!g_game.placeCreature(player, player->getTemplePosition(), false, true)) {
+			disconnectClient("Temple position is wrong. Contact the administrator.");
+			return;
 		}
 	}
+
+	if (operatingSystem >= CLIENTOS_OTCLIENT_LINUX) {
+		player->registerCreatureEvent("ExtendedOpcode");
+	}
+
+	player->lastIP = player->getIP();
+	player->lastLoginSaved = std::max<time_t>(time(nullptr), player->lastLoginSaved + 1);
+	acceptPackets = true;
+
 	OutputMessagePool::getInstance().addProtocolToAutosend(shared_from_this());
 }
 
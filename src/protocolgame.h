@@ -17,6 +17,7 @@ class ProtocolGame;
 class Quest;
 class Tile;
 class TrackedQuest;
+struct LoginLoadResult;
 
 enum SessionEndTypes_t : uint8_t
 {
@@ -74,6 +75,9 @@ public:
 private:
 	ProtocolGame_ptr getThis() { return std::static_pointer_cast<ProtocolGame>(shared_from_this()); }
 	void connect(uint32_t playerId, OperatingSystem_t operatingSystem);
+	void onPlayerPreloaded(Player* loadedPlayer, const std::shared_ptr<LoginLoadResult>& result,
+	                       OperatingSystem_t operatingSystem);
+	void onPlayerLoaded(Player* loadedPlayer, LoginLoadResult& result, OperatingSystem_t operatingSystem);
 	void disconnectClient(const std::string& message) const;
 	void writeToOutputBuffer(const NetworkMessage& msg);
 
@@ -16,10 +16,12 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 		// insert the event id in the list of active events
 		auto it = eventIdTimerMap.emplace(task->getEventId(), boost::asio::steady_timer{io_context});
 		auto& timer = it.first->second;
+		eventCount.store(eventIdTimerMap.size(), std::memory_order_relaxed);
 
 		timer.expires_from_now(std::chrono::milliseconds(task->getDelay()));
 		timer.async_wait([this, task](const boost::system::error_code& error) {
 			eventIdTimerMap.erase(task->getEventId());
+			eventCount.store(eventIdTimerMap.size(), std::memory_order_relaxed);
 
 			if (error == boost::asio::error::operation_aborted || getState() == THREAD_STATE_TERMINATED) {
 				// the timer has been manually canceled(timer->cancel()) or Scheduler::shutdown has been called
@@ -36,7 +38,9 @@ uint32_t Scheduler::addEvent(SchedulerTask* task)
 
 void Scheduler::stopEvent(uint32_t eventId)
 {
-	if (eventId == 0) {
+	// Scheduler::shutdown cancelled every timer, and the io_context may already be gone when the Lua environment
+	// closes its state during static destruction
+	if (eventId == 0 || getState() == THREAD_STATE_TERMINATED) {
 		return;
 	}
 
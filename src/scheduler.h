@@ -38,8 +38,14 @@ public:
 
 	void threadMain() { io_context.run(); }
 
+	/**
+	 * Number of events waiting for their timer, safe to call from any thread.
+	 */
+	size_t getEventCount() const { return eventCount.load(std::memory_order_relaxed); }
+
 private:
 	std::atomic<uint32_t> lastEventId{0};
+	std::atomic<size_t> eventCount{0}; // size of eventIdTimerMap, which only the scheduler thread touches
 	std::unordered_map<uint32_t, boost::asio::steady_timer> eventIdTimerMap;
 	boost::asio::io_context io_context;
 	boost::asio::io_context::work work{io_context};
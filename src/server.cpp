@@ -7,6 +7,7 @@
 
 #include "ban.h"
 #include "configmanager.h"
+#include "metrics.h"
 #include "scheduler.h"
 
 extern ConfigManager g_config;
@@ -60,10 +61,29 @@ void ServiceManager::stop()
 
 	acceptors.clear();
 
+	if (metricsPort) {
+		try {
+			io_service.post([metricsPort = std::move(metricsPort)]() { metricsPort->close(); });
+		} catch (boost::system::system_error& e) {
+			std::cout << "[ServiceManager::stop] Network Error: " << e.what() << std::endl;
+		}
+	}
+
 	death_timer.expires_from_now(std::chrono::seconds(3));
 	death_timer.async_wait([this](const boost::system::error_code&) { die(); });
 }
 
+bool ServiceManager::addMetrics(const std::string& address, uint16_t port)
+{
+	auto newMetricsPort = std::make_shared<MetricsPort>(io_service);
+	if (!newMetricsPort->open(address, port)) {
+		return false;
+	}
+
+	metricsPort = std::move(newMetricsPort);
+	return true;
+}
+
 ServicePort::~ServicePort() { close(); }
 
 bool ServicePort::is_single_socket() const { return !services.empty() && services.front()->is_single_socket(); }
@@ -7,6 +7,8 @@
 #include "connection.h"
 #include "signals.h"
 
+class MetricsPort;
+
 class ServiceBase
 {
 public:
@@ -78,12 +80,15 @@ public:
 	template <typename ProtocolType>
 	bool add(uint16_t port);
 
+	bool addMetrics(const std::string& address, uint16_t port);
+
 	bool is_running() const { return !acceptors.empty(); }
 
 private:
 	void die();
 
 	std::unordered_map<uint16_t, ServicePort_ptr> acceptors;
+	std::shared_ptr<MetricsPort> metricsPort;
 
 	boost::asio::io_service io_service;
 	Signals signals{io_service};
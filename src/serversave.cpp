@@ -0,0 +1,193 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "serversave.h"
+
+#include "databasetasks.h"
+#include "game.h"
+#include "iologindata.h"
+#include "iomapserialize.h"
+#include "scheduler.h"
+#include "tasks.h"
+
+extern DatabaseTasks g_databaseTasks;
+extern Dispatcher g_dispatcher;
+extern Game g_game;
+
+namespace {
+
+constexpr uint32_t SERVER_SAVE_RETRY_DELAY = 10000;
+
+} // namespace
+
+bool ServerSave::start(bool wait /* = false*/)
+{
+	{
+		std::unique_lock<std::mutex> guard{lock};
+		if (progress.running) {
+			if (!wait) {
+				// the dispatcher must not wait for the database, the save is taken once the previous one is written
+				if (!retryScheduled) {
+					std::cout << "[Warning - ServerSave::start] The previous server save is still being written, "
+					             "trying again in "
+					          << SERVER_SAVE_RETRY_DELAY / 1000 << " seconds." << std::endl;
+					retryScheduled = true;
+					g_scheduler.addEvent(createSchedulerTask(SERVER_SAVE_RETRY_DELAY, [this]() {
+						retryScheduled = false;
+						start();
+					}));
+				}
+				return false;
+			}
+
+			std::cout << "[Warning - ServerSave::start] Waiting for the previous server save to be written."
+			          << std::endl;
+			signal.wait(guard, [this]() { return !progress.running; });
+		}
+
+		progress = {};
+		progress.running = true;
+		progress.startedAt = OTSYS_TIME();
+		reportedQuarter = 0;
+	}
+
+	// every snapshot is taken in this dispatcher task, so together they are a consistent picture of the world
+	std::vector<std::shared_ptr<PlayerSnapshot>> players;
+	players.reserve(g_game.getPlayersOnline());
+	for (const auto& it : g_game.getPlayers()) {
+		Player* player = it.second;
+		player->loginPosition = player->getPosition();
+		players.push_back(std::make_shared<PlayerSnapshot>(IOLoginData::snapshotPlayer(player)));
+	}
+
+	auto houses = std::make_shared<HousesSnapshot>(IOMapSerialize::snapshotHouses());
+
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		progress.players = players.size();
+		for (const auto& snapshot : players) {
+			pendingPlayers[snapshot->guid] = PENDING_QUEUED;
+		}
+	}
+
+	std::cout << "> Took snapshots of " << players.size() << " players and "
+	          << g_game.map.houses.getHouses().size() << " houses in " << (OTSYS_TIME() - progress.startedAt) / 1000.
+	          << " s." << std::endl;
+
+	// the workers keep the order of tasks with the same key, so snapshots of a player are written in order
+	for (const auto& snapshot : players) {
+		auto task = [this, snapshot](Database& db) { savePlayer(db, *snapshot); };
+		if (!g_databaseTasks.addTask(task, snapshot->guid)) {
+			task(Database::getInstance());
+		}
+	}
+
+	auto task = [this, houses](Database& db) { saveHouses(db, *houses); };
+	if (!g_databaseTasks.addTask(task, DatabaseTasks::getKey("houses"))) {
+		task(Database::getInstance());
+	}
+	return true;
+}
+
+void ServerSave::savePlayer(Database& db, PlayerSnapshot& snapshot)
+{
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		auto it = pendingPlayers.find(snapshot.guid);
+		if (it == pendingPlayers.end()) {
+			++progress.playersSuperseded;
+			reportProgress();
+			return;
+		}
+		it->second = PENDING_WRITING;
+	}
+
+	bool success = IOLoginData::saveSnapshot(db, snapshot);
+	if (success) {
+		g_dispatcher.addTask(
+		    [guid = snapshot.guid, revision = snapshot.revision, state = std::move(snapshot.state)]() mutable {
+			    // the player may have been saved again, or logged out and in, since the snapshot was taken
+			    Player* player = g_game.getPlayerByGUID(guid);
+			    if (player && player->saveRevision == revision) {
+				    player->saveState = std::move(state);
+			    }
+		    });
+	} else {
+		std::cout << "[Error - ServerSave::savePlayer] Failed to save " << snapshot.name << '.' << std::endl;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		pendingPlayers.erase(snapshot.guid);
+		if (success) {
+			++progress.playersSaved;
+		} else {
+			++progress.playersFailed;
+		}
+		reportProgress();
+	}
+	signal.notify_all();
+}
+
+void ServerSave::saveHouses(Database& db, const HousesSnapshot& snapshot)
+{
+	bool success = Map::save(db, snapshot);
+	if (!success) {
+		std::cout << "[Error - ServerSave::saveHouses] Failed to save the houses." << std::endl;
+		IOMapSerialize::setHousesChanged(snapshot.tiles);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard{lock};
+		progress.housesDone = true;
+		progress.housesSaved = success;
+		reportProgress();
+	}
+	signal.notify_all();
+}
+
+void ServerSave::reportProgress()
+{
+	const size_t players = progress.playersSaved + progress.playersFailed + progress.playersSuperseded;
+	if (progress.players != 0) {
+		const size_t quarter = players * 4 / progress.players;
+		if (quarter > reportedQuarter && quarter < 4) {
+			reportedQuarter = quarter;
+			std::cout << "> Server save: " << players << '/' << progress.players << " players written." << std::endl;
+		}
+	}
+
+	if (players < progress.players || !progress.housesDone) {
+		return;
+	}
+
+	progress.running = false;
+	std::cout << "> Server save written in " << (OTSYS_TIME() - progress.startedAt) / 1000. << " s: "
+	          << progress.playersSaved << " players saved, " << progress.playersFailed << " failed, "
+	          << progress.playersSuperseded << " saved again meanwhile, houses "
+	          << (progress.housesSaved ? "saved" : "failed") << '.' << std::endl;
+}
+
+void ServerSave::cancelPlayer(uint32_t guid)
+{
+	std::unique_lock<std::mutex> guard{lock};
+	auto it = pendingPlayers.find(guid);
+	if (it == pendingPlayers.end()) {
+		return;
+	}
+
+	if (it->second == PENDING_QUEUED) {
+		pendingPlayers.erase(it);
+		return;
+	}
+
+	signal.wait(guard, [this, guid]() { return pendingPlayers.find(guid) == pendingPlayers.end(); });
+}
+
+ServerSaveProgress ServerSave::getProgress()
+{
+	std::lock_guard<std::mutex> guard{lock};
+	return progress;
+}
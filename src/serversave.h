@@ -0,0 +1,83 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_SERVERSAVE_H
+#define FS_SERVERSAVE_H
+
+class Database;
+struct HousesSnapshot;
+struct PlayerSnapshot;
+
+struct ServerSaveProgress
+{
+	bool running = false;
+	int64_t startedAt = 0;
+
+	size_t players = 0;
+	size_t playersSaved = 0;
+	size_t playersFailed = 0;
+	size_t playersSuperseded = 0; // saved again by IOLoginData::savePlayer before the snapshot was written
+
+	bool housesDone = false;
+	bool housesSaved = false;
+};
+
+/**
+ * Saves every online player and the houses without stopping the game.
+ *
+ * All snapshots are taken at once on the dispatcher thread and then written
+ * on the database task workers, each player and the houses in their own
+ * transactions. The snapshots of a player are written in the order they
+ * were taken, and IOLoginData::savePlayer makes sure a snapshot that is
+ * still pending is never written after a newer save of the same player.
+ */
+class ServerSave
+{
+public:
+	ServerSave() = default;
+
+	// non-copyable
+	ServerSave(const ServerSave&) = delete;
+	ServerSave& operator=(const ServerSave&) = delete;
+
+	/**
+	 * Takes the snapshots and queues them to be written.
+	 *
+	 * While the previous server save is still being written, the new one is
+	 * tried again later instead, unless wait is set: then it blocks until the
+	 * previous one is written, which is only fit for the shutdown.
+	 *
+	 * @return false if the previous server save is still being written
+	 */
+	bool start(bool wait = false);
+
+	/**
+	 * Makes sure no snapshot of the player is written after this returns:
+	 * a queued snapshot is dropped, one being written is waited for.
+	 */
+	void cancelPlayer(uint32_t guid);
+
+	ServerSaveProgress getProgress();
+
+private:
+	enum PendingState_t : uint8_t
+	{
+		PENDING_QUEUED,
+		PENDING_WRITING,
+	};
+
+	void savePlayer(Database& db, PlayerSnapshot& snapshot);
+	void saveHouses(Database& db, const HousesSnapshot& snapshot);
+	void reportProgress();
+
+	std::unordered_map<uint32_t, PendingState_t> pendingPlayers;
+	std::mutex lock;
+	std::condition_variable signal;
+	ServerSaveProgress progress;
+	size_t reportedQuarter = 0;
+	bool retryScheduled = false; // dispatcher thread only
+};
+
+extern ServerSave g_serverSave;
+
+#endif // FS_SERVERSAVE_H
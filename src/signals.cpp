@@ -11,6 +11,7 @@
 #include "events.h"
 #include "game.h"
 #include "globalevent.h"
+#include "logintasks.h"
 #include "monsters.h"
 #include "mounts.h"
 #include "movement.h"
@@ -27,6 +28,7 @@
 
 extern Scheduler g_scheduler;
 extern DatabaseTasks g_databaseTasks;
+extern LoginTasks g_loginTasks;
 extern Dispatcher g_dispatcher;
 
 extern ConfigManager g_config;
@@ -111,7 +113,7 @@ void sighupHandler()
 	g_luaEnvironment.loadFile("data/global.lua");
 	std::cout << "Reloaded global.lua." << std::endl;
 
-	lua_gc(g_luaEnvironment.getLuaState(), LUA_GCCOLLECT, 0);
+	g_luaEnvironment.collectAllGarbage();
 }
 #else
 void sigbreakHandler()
@@ -161,6 +163,7 @@ void dispatchSignalHandler(int signal)
 			// hold the thread until other threads end
 			g_scheduler.join();
 			g_databaseTasks.join();
+			g_loginTasks.join();
 			g_dispatcher.join();
 			break;
 #endif
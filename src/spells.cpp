@@ -78,6 +78,8 @@ TalkActionResult_t Spells::playerSaySpell(Player* player, std::string& words)
 
 void Spells::clearMaps(bool fromLua)
 {
+	instantIndexValid = false;
+
 	for (auto instant = instants.begin(); instant != instants.end();) {
 		if (fromLua == instant->second.fromLua) {
 			instant = instants.erase(instant);
@@ -121,6 +123,7 @@ bool Spells::registerEvent(Event_ptr event, const pugi::xml_node&)
 	InstantSpell* instant = dynamic_cast<InstantSpell*>(event.get());
 	if (instant) {
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
+		instantIndexValid = false;
 		if (!result.second) {
 			std::cout << "[Warning - Spells::registerEvent] Duplicate registered instant spell with words: "
 			          << instant->getWords() << std::endl;
@@ -147,6 +150,7 @@ bool Spells::registerInstantLuaEvent(InstantSpell* event)
 	if (instant) {
 		std::string words = instant->getWords();
 		auto result = instants.emplace(instant->getWords(), std::move(*instant));
+		instantIndexValid = false;
 		if (!result.second) {
 			std::cout << "[Warning - Spells::registerInstantLuaEvent] Duplicate registered instant spell with words: "
 			          << words << std::endl;
@@ -206,20 +210,77 @@ RuneSpell* Spells::getRuneSpellByName(const std::string& name)
 	return nullptr;
 }
 
-InstantSpell* Spells::getInstantSpell(const std::string& words)
+namespace {
+
+char foldCase(char c) { return static_cast<char>(tolower(c)); }
+
+std::string foldCase(const std::string& str)
+{
+	std::string folded(str);
+	std::transform(folded.begin(), folded.end(), folded.begin(), [](char c) { return foldCase(c); });
+	return folded;
+}
+
+bool compareChild(const std::pair<char, uint32_t>& child, char c) { return child.first < c; }
+
+} // namespace
+
+void Spells::buildInstantIndex()
 {
-	InstantSpell* result = nullptr;
+	instantWords.assign(1, {});
+	instantNames.clear();
 
+	// spells are visited in the order of the map, the first of equal words or names is the one found, as before
 	for (auto& it : instants) {
-		const std::string& instantSpellWords = it.second.getWords();
-		size_t spellLen = instantSpellWords.length();
-		if (caseInsensitiveStartsWith(words, instantSpellWords)) {
-			if (!result || spellLen > result->getWords().size()) {
-				result = &it.second;
-				if (words.length() == spellLen) {
-					break;
-				}
+		InstantSpell* instant = &it.second;
+		uint32_t node = 0;
+		for (char c : instant->getWords()) {
+			c = foldCase(c);
+
+			auto& children = instantWords[node].children;
+			auto child = std::lower_bound(children.begin(), children.end(), c, compareChild);
+			if (child != children.end() && child->first == c) {
+				node = child->second;
+				continue;
 			}
+
+			const uint32_t next = instantWords.size();
+			children.emplace(child, c, next);
+			instantWords.emplace_back();
+			node = next;
+		}
+
+		if (!instantWords[node].spell) {
+			instantWords[node].spell = instant;
+		}
+
+		instantNames.emplace(foldCase(instant->getName()), instant);
+	}
+
+	instantIndexValid = true;
+}
+
+InstantSpell* Spells::getInstantSpell(const std::string& words)
+{
+	if (!instantIndexValid) {
+		buildInstantIndex();
+	}
+
+	// the longest words the text starts with
+	InstantSpell* result = instantWords.front().spell;
+	uint32_t node = 0;
+	for (char c : words) {
+		c = foldCase(c);
+
+		const auto& children = instantWords[node].children;
+		auto child = std::lower_bound(children.begin(), children.end(), c, compareChild);
+		if (child == children.end() || child->first != c) {
+			break;
+		}
+
+		node = child->second;
+		if (instantWords[node].spell) {
+			result = instantWords[node].spell;
 		}
 	}
 
@@ -243,12 +304,15 @@ InstantSpell* Spells::getInstantSpell(const std::string& words)
 
 InstantSpell* Spells::getInstantSpellByName(const std::string& name)
 {
-	for (auto& it : instants) {
-		if (caseInsensitiveEqual(it.second.getName(), name)) {
-			return &it.second;
-		}
+	if (!instantIndexValid) {
+		buildInstantIndex();
 	}
-	return nullptr;
+
+	auto it = instantNames.find(foldCase(name));
+	if (it == instantNames.end()) {
+		return nullptr;
+	}
+	return it->second;
 }
 
 Position Spells::getCasterPosition(Creature* creature, Direction dir)
@@ -337,8 +401,7 @@ bool CombatSpell::executeCastSpell(Creature* creature, const LuaVariant& var)
 
 	scriptInterface->pushFunction(scriptId);
 
-	LuaScriptInterface::pushUserdata<Creature>(L, creature);
-	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
+	LuaScriptInterface::pushCreature(L, creature);
 
 	LuaScriptInterface::pushVariant(L, var);
 
@@ -1032,8 +1095,7 @@ bool InstantSpell::executeCastSpell(Creature* creature, const LuaVariant& var)
 
 	scriptInterface->pushFunction(scriptId);
 
-	LuaScriptInterface::pushUserdata<Creature>(L, creature);
-	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
+	LuaScriptInterface::pushCreature(L, creature);
 
 	LuaScriptInterface::pushVariant(L, var);
 
@@ -1214,8 +1276,7 @@ bool RuneSpell::executeCastSpell(Creature* creature, const LuaVariant& var, bool
 
 	scriptInterface->pushFunction(scriptId);
 
-	LuaScriptInterface::pushUserdata<Creature>(L, creature);
-	LuaScriptInterface::setCreatureMetatable(L, -1, creature);
+	LuaScriptInterface::pushCreature(L, creature);
 
 	LuaScriptInterface::pushVariant(L, var);
 
@@ -54,9 +54,23 @@ private:
 	Event_ptr getEvent(const std::string& nodeName) override;
 	bool registerEvent(Event_ptr event, const pugi::xml_node& node) override;
 
+	void buildInstantIndex();
+
+	// a node of the case folded words of the instant spells, a spell whose words end at the node is kept on it
+	struct InstantWordsNode
+	{
+		std::vector<std::pair<char, uint32_t>> children; // sorted by character
+		InstantSpell* spell = nullptr;
+	};
+
 	std::map<uint16_t, RuneSpell> runes;
 	std::map<std::string, InstantSpell> instants;
 
+	// rebuilt on the first lookup after the instant spells changed
+	std::vector<InstantWordsNode> instantWords;
+	std::unordered_map<std::string, InstantSpell*> instantNames; // case folded name
+	bool instantIndexValid = false;
+
 	friend class CombatSpell;
 	LuaScriptInterface scriptInterface{"Spell Interface"};
 };
@@ -0,0 +1,194 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#include "otpch.h"
+
+#include "startuploader.h"
+
+void StartupLoader::addStage(std::string name, StartupThread_t thread, std::vector<std::string> dependencies,
+                             std::function<bool(void)> load)
+{
+	Stage stage;
+	stage.name = std::move(name);
+	stage.thread = thread;
+	stage.dependencyNames = std::move(dependencies);
+	stage.load = std::move(load);
+	stages.push_back(std::move(stage));
+}
+
+std::string StartupLoader::run()
+{
+	startedAt = std::chrono::steady_clock::now();
+
+	size_t workerStages = 0;
+	for (Stage& stage : stages) {
+		for (const std::string& dependencyName : stage.dependencyNames) {
+			auto it = std::find_if(stages.begin(), stages.end(),
+			                       [&dependencyName](const Stage& other) { return other.name == dependencyName; });
+			if (it == stages.end()) {
+				std::cout << "[Error - StartupLoader::run] Stage " << stage.name << " depends on unknown stage "
+				          << dependencyName << '.' << std::endl;
+				return stage.name;
+			}
+			stage.dependencies.push_back(std::distance(stages.begin(), it));
+		}
+
+		if (stage.thread == STARTUP_THREAD_WORKER) {
+			++workerStages;
+		}
+	}
+
+	const size_t threadCount = std::min<size_t>(workerStages, std::max(1u, std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		threads.emplace_back(&StartupLoader::workerMain, this);
+	}
+
+	std::unique_lock<std::mutex> guard{stageLock};
+	while (true) {
+		if (failedStage.empty() && queueReadyStages()) {
+			stageSignal.notify_all();
+		}
+
+		if (!dispatcherQueue.empty()) {
+			const size_t index = dispatcherQueue.front();
+			dispatcherQueue.pop_front();
+			runStage(guard, index);
+			continue;
+		}
+
+		if (running == 0 && workerQueue.empty()) {
+			break;
+		}
+		stageSignal.wait(guard);
+	}
+
+	stopping = true;
+	guard.unlock();
+	stageSignal.notify_all();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	totalMicros = getElapsedMicros();
+
+	if (failedStage.empty()) {
+		for (const Stage& stage : stages) {
+			if (stage.state != STAGE_STATE_DONE) {
+				std::cout << "[Error - StartupLoader::run] Stage " << stage.name << " is part of a dependency cycle."
+				          << std::endl;
+				failedStage = stage.name;
+				break;
+			}
+		}
+	}
+	return failedStage;
+}
+
+void StartupLoader::printTimings() const
+{
+	int64_t stageMicros = 0;
+
+	std::cout << fmt::format(">> {:<20s} {:<10s} {:>10s} {:>10s}", "Stage", "Thread", "Start ms", "Time ms")
+	          << std::endl;
+	for (const Stage& stage : stages) {
+		const char* thread = stage.thread == STARTUP_THREAD_WORKER ? "worker" : "dispatcher";
+		if (stage.state != STAGE_STATE_DONE) {
+			std::cout << fmt::format(">> {:<20s} {:<10s} {:>10s} {:>10s}", stage.name, thread, "-", "-")
+			          << std::endl;
+			continue;
+		}
+
+		const int64_t micros = stage.endMicros - stage.startMicros;
+		stageMicros += micros;
+		std::cout << fmt::format(">> {:<20s} {:<10s} {:>10.1f} {:>10.1f}", stage.name, thread,
+		                         stage.startMicros / 1000., micros / 1000.)
+		          << std::endl;
+	}
+
+	std::cout << fmt::format(">> Loaded in {:.1f} ms, {:.1f} ms one after another.", totalMicros / 1000.,
+	                         stageMicros / 1000.)
+	          << std::endl;
+}
+
+void StartupLoader::workerMain()
+{
+	std::unique_lock<std::mutex> guard{stageLock};
+	while (!stopping) {
+		if (workerQueue.empty()) {
+			stageSignal.wait(guard);
+			continue;
+		}
+
+		const size_t index = workerQueue.front();
+		workerQueue.pop_front();
+		runStage(guard, index);
+	}
+}
+
+void StartupLoader::runStage(std::unique_lock<std::mutex>& guard, size_t index)
+{
+	Stage& stage = stages[index];
+
+	// a stage queued before another one failed is skipped
+	if (!failedStage.empty()) {
+		return;
+	}
+
+	std::cout << ">> Loading " << stage.name << std::endl;
+
+	stage.state = STAGE_STATE_RUNNING;
+	stage.startMicros = getElapsedMicros();
+	++running;
+	guard.unlock();
+
+	bool loaded;
+	try {
+		loaded = stage.load();
+	} catch (const std::exception& e) {
+		std::cout << "[Error - StartupLoader::runStage] " << stage.name << ": " << e.what() << std::endl;
+		loaded = false;
+	}
+
+	guard.lock();
+	stage.state = STAGE_STATE_DONE;
+	stage.endMicros = getElapsedMicros();
+	--running;
+	if (!loaded) {
+		failedStage = stage.name;
+	}
+	stageSignal.notify_all();
+}
+
+bool StartupLoader::queueReadyStages()
+{
+	bool queuedWorkerStage = false;
+	for (size_t index = 0, size = stages.size(); index < size; ++index) {
+		Stage& stage = stages[index];
+		if (stage.state != STAGE_STATE_PENDING) {
+			continue;
+		}
+
+		if (!std::all_of(stage.dependencies.begin(), stage.dependencies.end(),
+		                 [this](size_t dependency) { return stages[dependency].state == STAGE_STATE_DONE; })) {
+			continue;
+		}
+
+		stage.state = STAGE_STATE_QUEUED;
+		if (stage.thread == STARTUP_THREAD_WORKER) {
+			workerQueue.push_back(index);
+			queuedWorkerStage = true;
+		} else {
+			dispatcherQueue.push_back(index);
+		}
+	}
+	return queuedWorkerStage;
+}
+
+int64_t StartupLoader::getElapsedMicros() const
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt)
+	    .count();
+}
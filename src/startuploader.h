@@ -0,0 +1,84 @@
+// Copyright 2023 The Forgotten Server Authors. All rights reserved.
+// Use of this source code is governed by the GPL-2.0 License that can be found in the LICENSE file.
+
+#ifndef FS_STARTUPLOADER_H
+#define FS_STARTUPLOADER_H
+
+#include <condition_variable>
+
+enum StartupThread_t : uint8_t
+{
+	STARTUP_THREAD_WORKER, // any thread of the pool
+	STARTUP_THREAD_DISPATCHER, // the thread calling run, for everything touching the Lua state
+};
+
+/**
+ * Runs the loaders of the server startup as a graph of stages, each stage
+ * starting once the stages it depends on have finished.
+ *
+ * Worker stages run concurrently on a pool of threads and must only touch
+ * the data they load and the data loaded by their dependencies. Dispatcher
+ * stages run one after another on the thread calling run.
+ */
+class StartupLoader
+{
+public:
+	StartupLoader() = default;
+
+	// non-copyable
+	StartupLoader(const StartupLoader&) = delete;
+	StartupLoader& operator=(const StartupLoader&) = delete;
+
+	void addStage(std::string name, StartupThread_t thread, std::vector<std::string> dependencies,
+	              std::function<bool(void)> load);
+
+	/**
+	 * Runs all stages, no new stage is started once one has failed.
+	 *
+	 * @return the name of the stage that failed, empty if all stages succeeded
+	 */
+	std::string run();
+
+	void printTimings() const;
+
+private:
+	enum StageState_t : uint8_t
+	{
+		STAGE_STATE_PENDING,
+		STAGE_STATE_QUEUED,
+		STAGE_STATE_RUNNING,
+		STAGE_STATE_DONE,
+	};
+
+	struct Stage
+	{
+		std::string name;
+		StartupThread_t thread;
+		std::vector<std::string> dependencyNames;
+		std::vector<size_t> dependencies;
+		std::function<bool(void)> load;
+
+		StageState_t state = STAGE_STATE_PENDING;
+		int64_t startMicros = 0;
+		int64_t endMicros = 0;
+	};
+
+	void workerMain();
+	void runStage(std::unique_lock<std::mutex>& guard, size_t index);
+	bool queueReadyStages();
+	int64_t getElapsedMicros() const;
+
+	std::vector<Stage> stages;
+	std::deque<size_t> workerQueue;
+	std::deque<size_t> dispatcherQueue;
+	std::string failedStage;
+	std::chrono::steady_clock::time_point startedAt;
+	int64_t totalMicros = 0;
+
+	std::mutex stageLock;
+	std::condition_variable stageSignal;
+	size_t running = 0;
+	bool stopping = false;
+};
+
+#endif // FS_STARTUPLOADER_H
@@ -7,8 +7,10 @@
 
 #include "enums.h"
 #include "game.h"
+#include "luascript.h"
 
 extern Game g_game;
+extern LuaEnvironment g_luaEnvironment;
 
 Task* createTask(TaskFunc&& f) { return new Task(std::move(f)); }
 
@@ -28,20 +30,67 @@ void Dispatcher::threadMain()
 			taskSignal.wait(taskLockUnique);
 		}
 		tmpTaskList.swap(taskList);
+		const auto batchStart = std::chrono::steady_clock::now();
+		const auto waited = batchStart - firstTaskAt;
+		queueSize.store(0, std::memory_order_relaxed);
 		taskLockUnique.unlock();
 
+		if (tmpTaskList.empty()) {
+			continue;
+		}
+
+		uint64_t executed = 0;
 		for (Task* task : tmpTaskList) {
 			if (!task->hasExpired()) {
 				++dispatcherCycle;
+				++executed;
 				// execute it
 				(*task)();
 			}
 			delete task;
 		}
+		const uint64_t expired = tmpTaskList.size() - executed;
 		tmpTaskList.clear();
+
+		// collect Lua garbage between the batches rather than in the middle of a task
+		g_luaEnvironment.collectGarbage();
+
+		addBatch(executed, expired, std::chrono::duration_cast<std::chrono::microseconds>(waited).count(),
+		         std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - batchStart)
+		             .count());
+	}
+}
+
+void Dispatcher::addBatch(uint64_t executed, uint64_t expired, int64_t waited, int64_t busy)
+{
+	executedTasks.fetch_add(executed, std::memory_order_relaxed);
+	expiredTasks.fetch_add(expired, std::memory_order_relaxed);
+	waitMicros.fetch_add(waited, std::memory_order_relaxed);
+	busyMicros.fetch_add(busy, std::memory_order_relaxed);
+	batches.fetch_add(1, std::memory_order_relaxed);
+
+	// released after the batch count, so a reader seeing the bucket also sees the batch
+	auto it = std::lower_bound(DISPATCHER_BATCH_BUCKETS.begin(), DISPATCHER_BATCH_BUCKETS.end(), busy);
+	if (it != DISPATCHER_BATCH_BUCKETS.end()) {
+		batchBuckets[std::distance(DISPATCHER_BATCH_BUCKETS.begin(), it)].fetch_add(1, std::memory_order_release);
 	}
 }
 
+DispatcherStats Dispatcher::getStats() const
+{
+	DispatcherStats stats;
+	for (size_t i = 0; i < batchBuckets.size(); ++i) {
+		stats.batchBuckets[i] = batchBuckets[i].load(std::memory_order_acquire);
+	}
+	stats.queueSize = queueSize.load(std::memory_order_relaxed);
+	stats.tasks = executedTasks.load(std::memory_order_relaxed);
+	stats.expiredTasks = expiredTasks.load(std::memory_order_relaxed);
+	stats.batches = batches.load(std::memory_order_relaxed);
+	stats.busyMicros = busyMicros.load(std::memory_order_relaxed);
+	stats.waitMicros = waitMicros.load(std::memory_order_relaxed);
+	return stats;
+}
+
 void Dispatcher::addTask(Task* task)
 {
 	bool do_signal = false;
@@ -50,7 +99,11 @@ void Dispatcher::addTask(Task* task)
 
 	if (getState() == THREAD_STATE_RUNNING) {
 		do_signal = taskList.empty();
+		if (do_signal) {
+			firstTaskAt = std::chrono::steady_clock::now();
+		}
 		taskList.push_back(task);
+		queueSize.store(taskList.size(), std::memory_order_relaxed);
 	} else {
 		delete task;
 	}
@@ -71,6 +124,9 @@ void Dispatcher::shutdown()
 	});
 
 	std::lock_guard<std::mutex> lockClass(taskLock);
+	if (taskList.empty()) {
+		firstTaskAt = std::chrono::steady_clock::now();
+	}
 	taskList.push_back(task);
 
 	taskSignal.notify_one();
@@ -44,6 +44,21 @@ private:
 Task* createTask(TaskFunc&& f);
 Task* createTask(uint32_t expiration, TaskFunc&& f);
 
+// upper bounds of the buckets the batch durations are counted in, in microseconds
+constexpr std::array<int64_t, 8> DISPATCHER_BATCH_BUCKETS = {1000, 5000, 10000, 25000, 50000, 100000, 250000, 1000000};
+
+struct DispatcherStats
+{
+	size_t queueSize = 0;
+	uint64_t tasks = 0;
+	uint64_t expiredTasks = 0;
+	uint64_t batches = 0;
+	uint64_t busyMicros = 0;
+	uint64_t waitMicros = 0; // from the first task of a batch being added until the batch starts
+	// batches per bucket of DISPATCHER_BATCH_BUCKETS, not cumulative
+	std::array<uint64_t, DISPATCHER_BATCH_BUCKETS.size()> batchBuckets{};
+};
+
 class Dispatcher : public ThreadHolder<Dispatcher>
 {
 public:
@@ -57,14 +72,31 @@ public:
 
 	uint64_t getDispatcherCycle() const { return dispatcherCycle; }
 
+	/**
+	 * Reads the counters of the dispatcher, safe to call from any thread.
+	 */
+	DispatcherStats getStats() const;
+
 	void threadMain();
 
 private:
+	void addBatch(uint64_t executed, uint64_t expired, int64_t waited, int64_t busy);
+
 	std::mutex taskLock;
 	std::condition_variable taskSignal;
 
 	std::vector<Task*> taskList;
+	std::chrono::steady_clock::time_point firstTaskAt; // of the tasks in taskList
+	std::atomic<size_t> queueSize{0};                  // size of taskList, written under taskLock
 	uint64_t dispatcherCycle = 0;
+
+	// written by the dispatcher thread only
+	std::atomic<uint64_t> executedTasks{0};
+	std::atomic<uint64_t> expiredTasks{0};
+	std::atomic<uint64_t> batches{0};
+	std::atomic<uint64_t> busyMicros{0};
+	std::atomic<uint64_t> waitMicros{0};
+	std::array<std::atomic<uint64_t>, DISPATCHER_BATCH_BUCKETS.size()> batchBuckets{};
 };
 
 extern Dispatcher g_dispatcher;
@@ -9,6 +9,7 @@
 #include "configmanager.h"
 #include "creature.h"
 #include "game.h"
+#include "house.h"
 #include "housetile.h"
 #include "mailbox.h"
 #include "monster.h"
@@ -360,6 +361,10 @@ void Tile::onAddTileItem(Item* item)
 
 	setTileFlags(item);
 
+	if (House* house = getHouse()) {
+		house->setItemsChanged();
+	}
+
 	const Position& cylinderMapPos = getPosition();
 
 	SpectatorVec spectators;
@@ -405,6 +410,10 @@ void Tile::onUpdateTileItem(Item* oldItem, const ItemType& oldType, Item* newIte
 		}
 	}
 
+	if (House* house = getHouse()) {
+		house->setItemsChanged();
+	}
+
 	const Position& cylinderMapPos = getPosition();
 
 	SpectatorVec spectators;
@@ -434,6 +443,10 @@ void Tile::onRemoveTileItem(const SpectatorVec& spectators, const std::vector<in
 
 	resetTileFlags(item);
 
+	if (House* house = getHouse()) {
+		house->setItemsChanged();
+	}
+
 	const Position& cylinderMapPos = getPosition();
 	const ItemType& iType = Item::items[item->getID()];
 
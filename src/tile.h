@@ -10,6 +10,7 @@
 
 class BedItem;
 class Creature;
+class House;
 class MagicField;
 class Mailbox;
 class SpectatorVec;
@@ -230,6 +231,8 @@ public:
 
 	bool isRemoved() const override final { return false; }
 
+	virtual House* getHouse() const { return nullptr; }
+
 	Item* getUseItem(int32_t index) const;
 
 	Item* getGround() const { return ground; }